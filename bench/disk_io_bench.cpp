@@ -0,0 +1,98 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <string>
+#include <algorithm>
+
+#include "EventLoop.h"
+#include "DiskIoExecutor.h"
+
+// 磁盘操作对事件循环延迟的影响：一个事件循环，另一线程每 1ms 向其投递一个计时任务，
+// 同时提交 20 个各耗时 50ms 的模拟磁盘任务（间隔 50ms），分别在事件循环中直接执行与交给 DiskIoExecutor 执行，
+// 统计计时任务从投递到执行的延迟
+// 用法：./disk_io_bench [任务数] [任务耗时ms]
+
+using Clock = std::chrono::steady_clock;
+
+struct Result
+{
+    size_t ticks;
+    double p50Us;
+    double p99Us;
+};
+
+static Result Run(bool useExecutor, int jobs, int jobMs)
+{
+    EventLoop loop(false);
+    loop.SetEpollTimeoutCallback([](EventLoop*) {});
+    std::thread loopThread([&loop]() { loop.RunLoop(); });
+
+    DiskIoExecutor diskIo("DiskIoBench");
+    std::vector<double> latencies;             // 只在事件循环线程中访问
+    std::atomic<int> completed(0);
+    std::atomic<bool> stop(false);
+
+    // 计时线程：记录投递时间，由事件循环执行时计算延迟
+    std::thread ticker([&]() {
+        while (!stop)
+        {
+            Clock::time_point posted = Clock::now();
+            loop.QueueInLoop([posted, &latencies]() {
+                latencies.push_back(std::chrono::duration<double, std::micro>(Clock::now() - posted).count());
+            });
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+
+    auto diskJob = [jobMs, &completed]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(jobMs));
+        ++completed;
+    };
+    for (int i = 0; i < jobs; ++i)
+    {
+        if (useExecutor)
+        {
+            loop.QueueInLoop([&diskIo, &loop, diskJob]() { diskIo.Submit(0, diskJob, &loop, nullptr); });
+        }
+        else
+        {
+            loop.QueueInLoop(diskJob);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(jobMs));
+    }
+    while (completed < jobs) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    stop = true;
+    ticker.join();
+    diskIo.Stop();
+    loop.StopEvent();
+    loopThread.join();
+
+    Result result{latencies.size(), 0, 0};
+    if (!latencies.empty())
+    {
+        std::sort(latencies.begin(), latencies.end());
+        result.p50Us = latencies[latencies.size() / 2];
+        result.p99Us = latencies[std::min(latencies.size() - 1, latencies.size() * 99 / 100)];
+    }
+    return result;
+}
+
+static void Print(const char* name, const Result& result)
+{
+    printf("%-10s ticks %5zu  p50 %10.0f us  p99 %10.0f us\n", name, result.ticks, result.p50Us, result.p99Us);
+}
+
+int main(int argc, char *argv[])
+{
+    int jobs = argc > 1 ? atoi(argv[1]) : 20;
+    int jobMs = argc > 2 ? atoi(argv[2]) : 50;
+    printf("jobs: %d x %d ms, ticker: 1 ms\n", jobs, jobMs);
+
+    Print("inline", Run(false, jobs, jobMs));
+    Print("executor", Run(true, jobs, jobMs));
+    return 0;
+}
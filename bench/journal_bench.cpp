@@ -0,0 +1,104 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <string>
+#include <nlohmann/json.hpp>
+
+#include "FileNameJournal.h"
+
+// 文件名映射存储基准：旧版 JSON 映射文件与追加式日志 FileNameJournal 的对比
+// 用法：./journal_bench [目录] [条目数]，默认在 /tmp 下测试 1000000 条映射
+// 旧版每次删除都要重新解析并以 dump(2) 重写整个 JSON 文件，这里分别计时加载与重写
+
+using Clock = std::chrono::steady_clock;
+
+static double ElapsedMs(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// 服务器文件名与原始文件名，长度与上传时生成的名字相近
+static std::string ServerName(size_t i) { return "1700000000_" + std::to_string(i) + "_a1b2c3d4.bin"; }
+static std::string OriginalName(size_t i) { return "document_" + std::to_string(i) + ".pdf"; }
+
+int main(int argc, char *argv[])
+{
+    std::string dir = argc > 1 ? argv[1] : "/tmp";
+    size_t count = argc > 2 ? static_cast<size_t>(atol(argv[2])) : 1000000;
+    size_t erased = count / 10;
+
+    std::string jsonPath = dir + "/journal_bench_mapping.json";
+    std::string journalPath = dir + "/journal_bench_mapping.journal";
+    unlink(jsonPath.c_str());
+    unlink(journalPath.c_str());
+
+    printf("entries: %zu, dir: %s\n", count, dir.c_str());
+
+    // 旧版：整个映射保存为一个 JSON 文件
+    {
+        std::map<std::string, std::string> mapping;
+        for (size_t i = 0; i < count; ++i) mapping[ServerName(i)] = OriginalName(i);
+        {
+            std::ofstream file(jsonPath);
+            file << nlohmann::json(mapping).dump(2);
+        }
+
+        auto start = Clock::now();
+        std::ifstream file(jsonPath);
+        mapping = nlohmann::json::parse(file).get<std::map<std::string, std::string>>();
+        printf("legacy load                        %8.0f ms\n", ElapsedMs(start));
+
+        start = Clock::now();
+        mapping.erase(ServerName(0));
+        std::ofstream out(jsonPath);
+        out << nlohmann::json(mapping).dump(2);
+        out.close();
+        printf("legacy rewrite per delete          %8.0f ms\n", ElapsedMs(start));
+    }
+
+    // 日志：count 条 put 与 count / 10 条 delete
+    {
+        FileNameJournal journal(journalPath);
+        if (!journal.Open())
+        {
+            printf("failed to open %s\n", journalPath.c_str());
+            return -1;
+        }
+
+        auto start = Clock::now();
+        for (size_t i = 0; i < count; ++i) journal.Put(ServerName(i), OriginalName(i));
+        for (size_t i = 0; i < erased; ++i) journal.Erase(ServerName(i));
+        double opUs = ElapsedMs(start) * 1000 / static_cast<double>(count + erased);
+        printf("journal put / erase                %8.2f us per op\n", opUs);
+    }
+
+    // 重放 count + count / 10 条记录，随后重新写入全部映射，使失效记录数超过有效条目数
+    {
+        FileNameJournal journal(journalPath);
+        auto start = Clock::now();
+        journal.Open();
+        printf("journal replay, %zu records     %8.0f ms\n", count + erased, ElapsedMs(start));
+
+        for (size_t i = 0; i < count; ++i) journal.Put(ServerName(i), OriginalName(i));
+        uint64_t records = count + erased + count;
+
+        start = Clock::now();
+        journal.Compact();
+        printf("compaction, %llu -> %zu records %8.0f ms\n",
+               static_cast<unsigned long long>(records), journal.Size(), ElapsedMs(start));
+    }
+
+    {
+        FileNameJournal journal(journalPath);
+        auto start = Clock::now();
+        journal.Open();
+        printf("journal replay after compaction    %8.0f ms\n", ElapsedMs(start));
+    }
+
+    unlink(jsonPath.c_str());
+    unlink(journalPath.c_str());
+    return 0;
+}
@@ -0,0 +1,20 @@
+#ifndef REACTOR_CRC32C_H
+#define REACTOR_CRC32C_H
+
+#include <cstdint>
+#include <cstddef>
+
+// CRC-32C（Castagnoli）校验和，用于检测存储文件的位翻转与截断
+// x86-64 上 CPU 支持 SSE4.2、ARMv8 上编译器启用 CRC 扩展时使用硬件指令，否则使用查表实现
+class Crc32c
+{
+public:
+    // 在已有校验和 crc 的基础上追加数据，初始值为 0
+    static uint32_t Extend(uint32_t crc, const void* data, size_t len);
+    // 计算一段数据的校验和
+    static uint32_t Value(const void* data, size_t len) { return Extend(0, data, len); }
+    // 当前是否使用硬件指令
+    static bool IsHardwareAccelerated();
+};
+
+#endif //REACTOR_CRC32C_H
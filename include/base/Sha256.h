@@ -0,0 +1,32 @@
+#ifndef REACTOR_SHA256_H
+#define REACTOR_SHA256_H
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+// SHA-256 摘要（FIPS 180-4），支持分段输入，用于上传内容的去重寻址
+class Sha256
+{
+private:
+    uint32_t state_[8];      // 中间哈希值
+    uint64_t totalBytes_;    // 累计输入字节数
+    uint8_t block_[64];      // 未满 64 字节的待处理数据
+    size_t blockLen_;        // block_ 中的字节数
+
+    void Transform(const uint8_t* block);
+
+public:
+    Sha256();
+
+    // 重新开始计算
+    void Reset();
+    // 追加数据
+    void Update(const void* data, size_t len);
+    // 结束计算，返回 32 字节摘要（调用后需 Reset 才能复用）
+    std::string Final();
+    // 结束计算，返回 64 位小写十六进制摘要
+    std::string FinalHex();
+};
+
+#endif //REACTOR_SHA256_H
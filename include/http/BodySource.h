@@ -0,0 +1,63 @@
+#ifndef BODYSOURCE_H
+#define BODYSOURCE_H
+
+#include <string>
+#include <memory>
+#include <functional>
+#include <cstdint>
+
+#include "Buffer.h"
+#include "Connection.h"
+#include "Common.h"
+
+// 响应体数据源：由连接在发送缓冲区排空后按需拉取（背压），大响应无需一次性载入内存
+class BodySource
+{
+public:
+    virtual ~BodySource() = default;
+
+    // 响应体总长度，未知时返回 -1（使用 chunked 传输编码）
+    virtual int64_t Length() const = 0;
+
+    // 向 output 追加下一段数据，返回值含义同 StreamState
+    // 返回 kPending 时，数据源需在数据就绪后调用 Connection::ResumeStream()
+    virtual StreamState Read(Buffer* output) = 0;
+
+    // 将数据源包装为连接的数据生产者，长度未知时按 chunked 格式分块
+    static StreamProducer MakeProducer(const std::shared_ptr<BodySource>& source);
+};
+
+// 共享只读内存块（如缓存的静态资源），多个连接共享同一份数据，不拷贝到响应对象中
+class MemoryBodySource : public BodySource
+{
+private:
+    std::shared_ptr<const std::string> data_;  // 只读数据
+    size_t offset_;                            // 已发送位置
+
+public:
+    DISALLOW_COPY_AND_MOVE(MemoryBodySource);
+    explicit MemoryBodySource(std::shared_ptr<const std::string> data);
+
+    int64_t Length() const override;
+    StreamState Read(Buffer* output) override;
+};
+
+// 生成器：每次调用向 output 追加一段数据，返回 false 表示没有更多数据
+class GeneratorBodySource : public BodySource
+{
+public:
+    using Generator = std::function<bool(Buffer*)>;
+
+private:
+    Generator generator_;  // 数据生成函数
+    int64_t length_;       // 预先已知的总长度，未知为 -1
+
+public:
+    DISALLOW_COPY_AND_MOVE(GeneratorBodySource);
+    explicit GeneratorBodySource(Generator generator, int64_t length = -1);
+
+    int64_t Length() const override;
+    StreamState Read(Buffer* output) override;
+};
+
+#endif // BODYSOURCE_H
@@ -0,0 +1,90 @@
+#ifndef HTTPCOMPRESSOR_H
+#define HTTPCOMPRESSOR_H
+
+#include <string>
+#include <atomic>
+#include <zlib.h>
+
+#include "Buffer.h"
+#include "Common.h"
+
+// 响应内容编码
+enum class ContentEncoding
+{
+    kIdentity,  // 不压缩
+    kGzip,      // gzip
+    kDeflate    // deflate（zlib 格式）
+};
+
+// 压缩参数
+struct CompressionOptions
+{
+    int level;                       // 动态压缩级别（1~9），静态资源预压缩固定使用 9
+    size_t minSize;                  // 小于该大小的响应不压缩
+    size_t cpuBudgetBytesPerSecond;  // 每个事件循环线程每秒最多压缩的字节数，超出后直接发送原文
+};
+
+// 流式压缩器：输入分段送入，压缩结果直接写入 Buffer
+class StreamCompressor
+{
+private:
+    z_stream stream_;       // zlib 压缩流
+    bool initialized_;      // deflateInit2 是否成功
+    size_t totalIn_;        // 累计输入字节数
+    size_t totalOut_;       // 累计输出字节数
+
+    void Deflate(const char* data, size_t len, int flush, Buffer* output);
+
+public:
+    DISALLOW_COPY_AND_MOVE(StreamCompressor);
+    StreamCompressor(ContentEncoding encoding, int level);
+    ~StreamCompressor();
+
+    bool IsValid() const { return initialized_; }
+
+    // 压缩一段数据，可能只输出部分结果（其余留在 zlib 内部窗口中）
+    void Write(const char* data, size_t len, Buffer* output);
+    // 刷出当前所有待压缩数据，便于流式发送时客户端及时解码
+    void Flush(Buffer* output);
+    // 结束压缩流，写出剩余数据与尾部校验
+    void Finish(Buffer* output);
+
+    size_t TotalIn() const { return totalIn_; }
+    size_t TotalOut() const { return totalOut_; }
+};
+
+// HTTP 压缩协商、预算控制与统计
+class HttpCompressor
+{
+private:
+    static CompressionOptions options_;
+    static std::atomic<uint64_t> totalIn_;   // 累计压缩前字节数
+    static std::atomic<uint64_t> totalOut_;  // 累计压缩后字节数
+
+public:
+    // 设置压缩参数（应在服务启动前调用）
+    static void SetOptions(const CompressionOptions& options);
+    static const CompressionOptions& GetOptions();
+
+    // 根据 Accept-Encoding 选择编码，优先 gzip，其次 deflate，支持 q 值
+    static ContentEncoding Negotiate(const std::string& acceptEncoding);
+    // Content-Encoding 头部取值
+    static const char* EncodingName(ContentEncoding encoding);
+    // 是否为值得压缩的类型（文本、JSON 等），已压缩的二进制文件一律不压缩
+    static bool IsCompressibleType(const std::string& contentType);
+
+    // 申请本线程本秒的压缩预算，预算不足返回 false
+    static bool AcquireBudget(size_t bytes);
+
+    // 一次性压缩整段数据
+    static bool Compress(const char* data, size_t len, ContentEncoding encoding, int level, std::string* output);
+
+    // 记录一次压缩的输入/输出大小
+    static void Record(size_t in, size_t out);
+    // 累计压缩率（压缩后 / 压缩前），未压缩过返回 1
+    static double CompressionRatio();
+    static uint64_t TotalIn() { return totalIn_.load(); }
+    static uint64_t TotalOut() { return totalOut_.load(); }
+};
+
+#endif // HTTPCOMPRESSOR_H
@@ -4,6 +4,7 @@
 #include <string>
 #include <memory>
 #include <mutex>
+#include <cstdint>
 
 class HttpRequest;
 
@@ -58,11 +59,15 @@ private:
     std::unique_ptr<HttpRequest> request_;  // 指向HttpRequest对象，保存请求数据
     HttpRequestParseState state_;  // 当前解析状态
     std::shared_ptr<void> customContext_;  // 自定义上下文存储
+    std::shared_ptr<void> requestHold_;    // 预检查时为当前请求占用的资源（如配额预留），请求重置或连接关闭时释放
 
-    size_t contentLength_;  // 用于存储 Content-Length 的值
-    size_t bodyReceived_;   // 已接收的 body 长度
+    uint64_t contentLength_;  // 用于存储 Content-Length 的值
+    uint64_t bodyReceived_;   // 已接收的 body 长度
     bool isChunked_;        // 是否为 chunked 传输
 
+    bool headersChecked_;   // 是否已基于请求头完成预检查（会话、大小等）
+    bool rejected_;         // 预检查未通过，丢弃后续请求体直到连接关闭
+
 public:
     HttpContext();
     ~HttpContext();
@@ -72,11 +77,23 @@ public:
     HttpRequestParseState ParseRequest(const char* begin, int size);
     // 是否完成整个HTTP请求解析
     bool GetCompleteRequest() const;
+    // 请求体总长度与已接收长度
+    uint64_t GetContentLength() const { return contentLength_; }
+    uint64_t GetBodyReceived() const { return bodyReceived_; }
     
     HttpRequest* GetRequest(); // 获取当前解析出的HttpRequest对象
     // 重置解析上下文，清空所有状态和请求数据
     void ResetContextStatus();
 
+    // 请求头预检查状态
+    bool IsHeadersChecked() const { return headersChecked_; }
+    bool IsRejected() const { return rejected_; }
+    void SetHeadersChecked(bool accepted)
+    {
+        headersChecked_ = true;
+        rejected_ = !accepted;
+    }
+
     template<typename T>
     std::shared_ptr<T> GetContext() const 
     {
@@ -87,6 +104,16 @@ public:
     {
         customContext_ = context;
     }
+
+    // 预检查占用的资源：由处理函数取走后随其处理状态一起释放
+    void SetRequestHold(const std::shared_ptr<void>& hold) { requestHold_ = hold; }
+    template<typename T>
+    std::shared_ptr<T> TakeRequestHold()
+    {
+        std::shared_ptr<T> hold = std::static_pointer_cast<T>(requestHold_);
+        requestHold_.reset();
+        return hold;
+    }
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,42 @@
+#ifndef HTTPRANGE_H
+#define HTTPRANGE_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// 字节范围，闭区间 [start, end]
+struct ByteRange
+{
+    uint64_t start;
+    uint64_t end;
+
+    uint64_t Length() const { return end - start + 1; }
+};
+
+// Range 头解析结果
+enum class RangeParseResult
+{
+    kNone,           // 没有 Range 头或格式无法识别，按完整内容响应
+    kSatisfiable,    // 至少有一个有效范围，返回 206
+    kUnsatisfiable   // 所有范围都超出文件大小，返回 416
+};
+
+// HTTP Range 请求相关工具：解析 bytes 范围、构造 Content-Range 与 multipart/byteranges 分隔符
+namespace HttpRange
+{
+    // 解析 Range 头，例如：bytes=0-499, 1000-, -500
+    // 有效范围按起始位置排序并合并重叠/相邻区间，结果写入 ranges
+    RangeParseResult Parse(const std::string& header, uint64_t size, std::vector<ByteRange>* ranges);
+
+    // 构造 Content-Range 头取值，例如：bytes 0-499/1234
+    std::string ContentRange(const ByteRange& range, uint64_t size);
+
+    // 构造 416 响应使用的 Content-Range 头取值：bytes */1234
+    std::string UnsatisfiedContentRange(uint64_t size);
+
+    // 生成 multipart/byteranges 分隔符
+    std::string MakeBoundary();
+}
+
+#endif // HTTPRANGE_H
@@ -74,6 +74,8 @@ public:
 
     // 设置请求体（POST 或 PUT 请求的内容）
     void SetBody(const std::string &str);
+    void AppendBody(const char* data, size_t len);// 追加请求体（请求体分多次到达时）
+    std::string TakeBody();// 取出请求体并清空（流式处理时避免拷贝）
     const std::string & GetBody() const;// 获取请求体内容
 
     bool IsKeepAlive() const;
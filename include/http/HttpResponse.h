@@ -8,6 +8,10 @@
 #include <unordered_map>
 #include <iostream>
 
+#include "Buffer.h"
+#include "HttpCompressor.h"
+#include "BodySource.h"
+
 // HTTP 状态码枚举
 enum class HttpStatusCode 
 {
@@ -18,16 +22,27 @@ enum class HttpStatusCode
     k204NoContent = 204,            // 无内容：请求成功，但响应中无正文内容
     k206PartialContent = 206,       // 部分内容：响应中包含部分资源（常用于断点续传）
     k302Found = 302,                // 临时重定向：请求的资源临时被移动到另一个 UR
+    k304NotModified = 304,          // 未修改：客户端缓存仍然有效（条件请求命中）
     k400BadRequest = 400,           // 错误请求：服务器无法理解请求（如语法错误）
     k401Unauthorized = 401,         // 未授权：请求需要身份验证
     k403Forbidden = 403,            // 禁止访问：服务器理解请求但拒绝执行
     k404NotFound = 404,             // 未找到：请求的资源不存在
     k405MethodNotAllowed = 405,     // 方法不被允许：请求方法对资源无效
+    k409Conflict = 409,             // 冲突：请求与资源当前状态冲突（如分片上传尚未传完即提交）
+    k413PayloadTooLarge = 413,      // 请求体过大：超出服务器允许的上传大小
     k416RangeNotSatisfiable = 416,  // 范围无效：客户端请求的资源范围无效或超出范围（常用于下载）
-    k500InternalServerError = 500   // 服务器内部错误：服务器遇到意外情况，无法完成请求
+    k500InternalServerError = 500,  // 服务器内部错误：服务器遇到意外情况，无法完成请求
+    k503ServiceUnavailable = 503    // 服务不可用：暂时无法处理（如数据库连接耗尽），客户端可稍后重试
 
 };
 
+// 预渲染的完整响应报文，发送时仅在状态行之后插入缓存的 Date 头
+struct PrerenderedResponse
+{
+    std::string statusLine;  // 响应行，例如：HTTP/1.1 404 Not Found\r\n
+    std::string rest;        // 其余头部 + 空行 + 正文
+};
+
 class HttpResponse 
 {
 private:
@@ -37,7 +52,8 @@ private:
     bool closeConnection_;
     std::unordered_map<std::string, std::string> headers_;
     std::string body_;
-    bool isAsync_;
+    ContentEncoding acceptEncoding_;  // 客户端可接受的压缩编码（由 Accept-Encoding 协商得到）
+    std::shared_ptr<BodySource> bodySource_;  // 流式响应体数据源，设置后忽略 body_
     
 public:
     explicit HttpResponse(bool close_connection);
@@ -49,18 +65,28 @@ public:
     void SetCloseConnection(bool closeConnection);
     void SetContentType(const std::string& contentType);
     void SetBody(const std::string& body);
+    void SetBodySource(std::shared_ptr<BodySource> source) { bodySource_ = std::move(source); }
+    const std::shared_ptr<BodySource>& GetBodySource() const { return bodySource_; }
     void AddHeader(const std::string& key, const std::string& value);
     void AddSetCookie(const std::string& cookie);
-    void AddDateHeader();
     bool IsCloseConnection() const;
-    std::string ResponseMessage();         // 构造完整 HTTP 响应字符串
+    std::string ResponseMessage() const;   // 构造完整 HTTP 响应字符串（调试用，发送请使用 AppendToBuffer）
+    void AppendToBuffer(Buffer* output) const; // 将响应直接序列化到发送缓冲区（设置了 BodySource 时只写响应行和头部）
+    PrerenderedResponse Prerender() const; // 预渲染除 Date 头外的完整报文
     void DebugPrint() const;               // 打印响应内容（调试用）
-    void SetAsync(bool async) { isAsync_ = async; }
-    bool IsAsync() const { return isAsync_; }
+    void SetAcceptEncoding(ContentEncoding encoding) { acceptEncoding_ = encoding; }
+    ContentEncoding GetAcceptEncoding() const { return acceptEncoding_; }
+
+    // 将预渲染报文写入发送缓冲区
+    static void AppendPrerendered(const PrerenderedResponse& prerendered, Buffer* output);
+    // 写入 Date 头，格式化结果按线程（即按事件循环）每秒缓存一次
+    static void AppendDateHeader(Buffer* output);
 
 private:
-    std::string GetStatusLine() const;     // 响应行
+    void AppendStatusLine(Buffer* output) const;      // 响应行
+    void AppendHeadersAndBody(Buffer* output) const;  // 头部 + 空行 + 正文
+    bool CompressBody(std::string* compressed) const; // 按协商结果动态压缩正文，不满足条件时返回 false
     static std::string GetDefaultStatusMessage(HttpStatusCode code);
 };
 
-#endif
\ No newline at end of file
+#endif
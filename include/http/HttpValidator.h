@@ -0,0 +1,30 @@
+#ifndef HTTPVALIDATOR_H
+#define HTTPVALIDATOR_H
+
+#include <string>
+#include <ctime>
+
+#include "HttpRequest.h"
+
+// HTTP 缓存校验相关工具：HTTP-date 格式化/解析、ETag 比较、条件请求判断
+namespace HttpValidator
+{
+    // 格式化为 HTTP-date，例如：Sun, 06 Nov 1994 08:49:37 GMT
+    std::string FormatHttpDate(time_t t);
+
+    // 解析 HTTP-date，失败返回 false
+    bool ParseHttpDate(const std::string& str, time_t* t);
+
+    // 判断 If-None-Match / If-Match 形式的 ETag 列表是否匹配 etag
+    // weak 为 true 时使用弱比较（忽略 W/ 前缀），否则要求双方均为强校验器
+    bool ETagListMatches(const std::string& headerValue, const std::string& etag, bool weak);
+
+    // 根据 If-None-Match（优先）与 If-Modified-Since 判断是否可以返回 304
+    bool IsNotModified(const HttpRequest& request, const std::string& etag, time_t lastModified);
+
+    // 判断 If-Range 是否允许按 Range 返回部分内容；不存在 If-Range 时返回 true
+    // ETag 形式要求强比较，日期形式要求与 Last-Modified 完全相等
+    bool IfRangeMatches(const HttpRequest& request, const std::string& etag, time_t lastModified);
+}
+
+#endif
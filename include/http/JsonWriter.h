@@ -0,0 +1,47 @@
+#ifndef JSONWRITER_H
+#define JSONWRITER_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "Buffer.h"
+#include "Common.h"
+
+// 轻量流式 JSON 输出：直接追加到 Buffer，不构建中间对象树，大列表可分段写出
+// 调用方负责保证 Begin/End 与 Key/值 的调用顺序正确
+class JsonWriter
+{
+private:
+    Buffer* output_;                // 当前输出缓冲区
+    std::vector<bool> hasElement_;  // 每层容器是否已有元素（决定是否需要逗号）
+    bool afterKey_;                 // 刚写完键名，下一个值不加逗号
+
+    void BeforeValue();
+    void AppendEscaped(const char* data, size_t len);
+
+public:
+    DISALLOW_COPY_AND_MOVE(JsonWriter);
+    explicit JsonWriter(Buffer* output = nullptr);
+
+    // 切换输出缓冲区（流式发送时每次拉取的缓冲区可能不同）
+    void SetOutput(Buffer* output) { output_ = output; }
+    // 当前嵌套深度，为 0 表示顶层值已写完
+    size_t Depth() const { return hasElement_.size(); }
+
+    JsonWriter& BeginObject();
+    JsonWriter& EndObject();
+    JsonWriter& BeginArray();
+    JsonWriter& EndArray();
+    JsonWriter& Key(const char* key);
+
+    JsonWriter& String(const char* data, size_t len);
+    JsonWriter& String(const std::string& value) { return String(value.data(), value.size()); }
+    JsonWriter& String(const char* value);  // nullptr 输出为 null
+    JsonWriter& Int(int64_t value);
+    JsonWriter& Uint(uint64_t value);
+    JsonWriter& Bool(bool value);
+    JsonWriter& Null();
+};
+
+#endif // JSONWRITER_H
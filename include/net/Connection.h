@@ -2,6 +2,8 @@
 #define LEARN_CONNECTION_H
 
 #include <memory>
+#include <deque>
+#include <functional>
 
 #include "EventLoop.h"
 #include "Buffer.h"
@@ -15,6 +17,18 @@ class Connection;
 
 using spConnection = std::shared_ptr<Connection>;
 
+// 流式发送的数据生产者状态
+enum class StreamState
+{
+    kMore,      // 已追加数据，还有后续数据
+    kPending,   // 暂无可发送的数据，数据就绪后由生产者调用 ResumeStream() 恢复
+    kDone,      // 数据已全部追加完毕
+    kError      // 出错，关闭连接
+};
+
+// 数据生产者：发送缓冲区排空后被调用，向缓冲区追加下一段数据
+using StreamProducer = std::function<StreamState(Buffer*)>;
+
 class Connection:public std::enable_shared_from_this<Connection>
 {
 private:
@@ -32,6 +46,10 @@ private:
 
     TimeStamp lastTime_; // 时间戳，创建Connection对象时为当前时间，每接收到一个报文，把时间戳更新为当前时间
 
+    std::deque<StreamProducer> streams_; // 待发送的数据生产者队列，按顺序逐个拉取
+    bool streamPending_;                 // 队首生产者暂无数据，等待 ResumeStream()
+    bool readingPaused_;                 // 已暂停读取（如磁盘写入积压），等待 ResumeReading()
+
     // 保存http请求context上下文
     std::shared_ptr<void> context_;
 
@@ -41,6 +59,7 @@ public:
     ~Connection();
 
     void Tie();
+    EventLoop* GetLoop() const { return loop_; }
     int GetFd() const;
     std::string GetIP() const;
     uint16_t GetPort() const;
@@ -59,8 +78,18 @@ public:
 
     // 发送数据，不论再那种线程中都调用此函数发送数据
     void SendData(const char *data, size_t size);
+    // 由 writer 直接向发送缓冲区序列化数据（如 HTTP 响应），省去中间字符串
+    void SendToBuffer(const std::function<void(Buffer*)>& writer);
     // 发送数据, 如果为IO线程直接调用，工作线程则将此函数传递给IO线程
     void SendDataByThread(const std::string &data);
+    // 追加一个数据生产者，发送缓冲区排空后按需拉取数据（背压），排在之前的所有数据之后发送
+    void SendStream(StreamProducer producer);
+    // 生产者返回 kPending 后数据已就绪，恢复拉取（任意线程均可调用）
+    void ResumeStream();
+    // 暂停/恢复读取对端数据：下游（如磁盘写入）积压时暂停，数据留在内核接收缓冲区，由 TCP 流控让对端放慢（任意线程均可调用）
+    void PauseReading();
+    void ResumeReading();
+    bool IsReadingPaused() const { return readingPaused_; }
 
     // 连接是否已断开
     bool IsCloseConnection();
@@ -70,6 +99,12 @@ public:
     // 修改context相关方法
     void SetContext(const std::shared_ptr<void>& context);
     const std::shared_ptr<void>& GetContext() const;
+
+private:
+    // 在IO线程中写入发送缓冲区；有流式发送进行中时排到队尾，保证发送顺序
+    void WriteInLoop(const std::function<void(Buffer*)>& writer);
+    // 将发送缓冲区尽量写入 socket，出错关闭连接时返回 false
+    bool FlushOutputBuffer();
 };
 
 
@@ -0,0 +1,82 @@
+#ifndef DISKIOEXECUTOR_H
+#define DISKIOEXECUTOR_H
+
+#include <string>
+#include <map>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <cstdint>
+#include <sys/types.h>
+
+#include "Common.h"
+
+class EventLoop;
+
+// 磁盘 I/O 执行器：文件读写、fsync、unlink 等可能阻塞的操作不在事件循环线程中执行
+// 每个块设备（st_dev）一个队列和一个线程，慢盘只拖慢访问该盘的任务；同一设备上的任务按提交顺序执行
+// 任务完成后通过 EventLoop::QueueInLoop 将完成回调投递回提交任务的事件循环
+class DiskIoExecutor
+{
+public:
+    using Work = std::function<void()>;
+    using Completion = std::function<void()>;
+
+private:
+    struct Job
+    {
+        Work work;               // 在磁盘线程中执行
+        EventLoop* loop;         // 完成回调投递的事件循环，为空时在磁盘线程中直接执行
+        Completion done;         // 完成回调，可为空
+    };
+
+    struct DeviceQueue
+    {
+        dev_t device;                        // 设备号
+        std::deque<Job> jobs;                // 待执行任务
+        std::mutex mutex;                    // 保护 jobs 与 stop
+        std::condition_variable condition;   // 有新任务或停止
+        std::thread thread;                  // 执行线程
+        bool stop = false;                   // 是否停止
+    };
+
+    std::string name_;                                               // 线程名（日志用）
+    std::mutex mutex_;                                               // 保护 queues_ 与 stopped_
+    std::map<dev_t, std::unique_ptr<DeviceQueue>> queues_;           // <设备号, 队列>，首次提交时创建
+    bool stopped_;                                                   // 已停止，不再接受任务
+
+    std::atomic<uint64_t> completed_;     // 已完成任务数
+    std::atomic<size_t> maxQueueDepth_;   // 观察到的最大排队任务数
+
+    // 设备队列的线程主循环
+    void Run(DeviceQueue* queue);
+
+public:
+    DISALLOW_COPY_AND_MOVE(DiskIoExecutor);
+    explicit DiskIoExecutor(const std::string& name);
+    ~DiskIoExecutor();
+
+    // 路径所在的设备号，路径不存在时取其所在目录
+    static dev_t DeviceOf(const std::string& path);
+
+    // 提交任务：work 在 device 对应的磁盘线程中执行，完成后 done 被投递到 loop 中执行
+    void Submit(dev_t device, Work work, EventLoop* loop = nullptr, Completion done = nullptr);
+
+    // 读取 fd 在 offset 处的 len 字节：数据与错误码（0 表示成功）随完成回调返回
+    void Pread(dev_t device, int fd, uint64_t offset, size_t len, EventLoop* loop,
+               std::function<void(std::shared_ptr<std::string> data, int err)> done);
+
+    // 执行完所有已提交的任务后停止全部磁盘线程
+    void Stop();
+
+    // 某设备当前排队的任务数
+    size_t Pending(dev_t device);
+    uint64_t Completed() const { return completed_; }
+    size_t MaxQueueDepth() const { return maxQueueDepth_; }
+};
+
+#endif // DISKIOEXECUTOR_H
@@ -5,6 +5,10 @@
 #include <mysql.h>
 #include <string>
 #include <ctime>
+#include <memory>
+#include <unordered_map>
+
+#include "MySqlStatement.h"
 
 
 // 数据库操作类
@@ -13,6 +17,7 @@ class MySqlConnection
 private:
     MYSQL *conn_; // 表示和MySQL Server的一条连接
     clockid_t startTime_; // 连接进入空闲状态的起始时间
+    std::unordered_map<std::string, std::unique_ptr<MySqlStatement>> statements_; // <SQL 文本, 预处理语句>
     
 public:
     // 初始化数据库连接
@@ -26,6 +31,17 @@ public:
     int Update(std::string sql);
     // 查询操作 select
     MYSQL_RES* Query(std::string sql);
+    // 查询操作 select，结果不缓存到客户端，逐行从服务器读取（结果集释放前连接不可执行其他语句）
+    MYSQL_RES* QueryUnbuffered(std::string sql);
+    // 执行语句，返回影响的行数，失败返回 -1（不退出进程，事务中的语句失败后由调用方回滚）
+    long long Execute(const std::string& sql);
+    // 事务：开启后直到提交或回滚前的语句不自动提交
+    bool BeginTransaction();
+    bool Commit();
+    void Rollback();
+    // 预处理语句：同一 SQL 文本在本连接上只准备一次，之后直接复用；失败返回 nullptr
+    // 返回的语句属于本连接，只能在持有本连接期间使用
+    MySqlStatement* Prepare(const std::string& sql);
     // 刷新一下连接起始空闲时间点
     void RefreshAliveTime(){ startTime_ = clock(); }
     clock_t GetAliveTime() {return clock() - startTime_;}
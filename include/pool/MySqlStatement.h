@@ -0,0 +1,83 @@
+#ifndef MYSQLSTATEMENT_H
+#define MYSQLSTATEMENT_H
+
+#include <string>
+#include <vector>
+#include <type_traits>
+#include <mysql.h>
+
+#include "Common.h"
+
+// 预处理语句（mysql_stmt_*）：SQL 只在准备时解析一次，参数与结果按二进制协议传输，无需转义与拼接
+// 整数列直接接收为 long long，其余列（字符串、日期时间、DECIMAL）由客户端库转换为字符串接收
+// 由 MySqlConnection::Prepare 创建并按 SQL 文本缓存，生命周期与连接相同，只能由持有该连接的线程使用
+class MySqlStatement
+{
+private:
+    // MySQL 8.0 为 bool，5.7 与 MariaDB 为 my_bool（char）
+    using Flag = std::remove_pointer<decltype(MYSQL_BIND::is_null)>::type;
+
+    struct Param
+    {
+        long long intValue;          // 整数参数
+        std::string stringValue;     // 字符串参数
+        unsigned long length;        // 字符串参数长度
+        enum_field_types type;       // MYSQL_TYPE_LONGLONG / MYSQL_TYPE_STRING / MYSQL_TYPE_NULL
+    };
+
+    struct Column
+    {
+        bool integer;                // 整数列，按 long long 接收
+        bool isUnsigned;             // 无符号整数列
+        std::vector<char> buffer;    // 接收缓冲区，字符串被截断时扩容后重新读取该列
+        unsigned long length;        // 实际长度
+        Flag isNull;                 // 是否为 NULL
+        Flag error;                  // 是否被截断
+    };
+
+    MYSQL_STMT* stmt_;
+    std::string sql_;
+    std::vector<Param> params_;
+    std::vector<Column> columns_;
+    std::vector<MYSQL_BIND> resultBinds_;
+    bool hasResult_;                 // 是否有未释放的结果集
+    bool failed_;                    // 执行或取行失败，连接可能已断开，缓存中的语句应重新准备
+
+    // 按当前缓冲区绑定结果列
+    bool BindResult();
+
+public:
+    DISALLOW_COPY_AND_MOVE(MySqlStatement);
+    MySqlStatement(MYSQL* mysql, const std::string& sql);
+    ~MySqlStatement();
+
+    // 是否准备成功
+    bool IsValid() const { return stmt_ != nullptr; }
+    // 上次执行或取行是否失败
+    bool Failed() const { return failed_; }
+    const std::string& Sql() const { return sql_; }
+
+    // 绑定第 index 个参数（从 0 开始），执行后保留，可只修改部分参数再次执行
+    MySqlStatement& BindInt(unsigned int index, long long value);
+    MySqlStatement& BindString(unsigned int index, const std::string& value);
+    MySqlStatement& BindNull(unsigned int index);
+
+    // 执行，释放上次未读完的结果集；buffered 为 true 时结果集整体读到客户端，读取期间连接可执行其他语句，
+    // 为 false 时逐行从服务器读取，释放结果集前连接不可执行其他语句
+    bool Execute(bool buffered = true);
+    // 读取下一行，没有更多行或失败时返回 false（用 Failed() 区分）
+    bool Fetch();
+    // 释放结果集，未读完的行被丢弃
+    void FreeResult();
+    // INSERT / UPDATE / DELETE 影响的行数
+    long long AffectedRows();
+
+    // 当前行第 index 列的值
+    bool IsNull(unsigned int index) const;
+    long long GetInt(unsigned int index) const;
+    std::string GetString(unsigned int index) const;
+    // 字符串列的数据与长度，指向内部缓冲区，下次 Fetch 前有效
+    const char* GetData(unsigned int index, unsigned long* length) const;
+};
+
+#endif // MYSQLSTATEMENT_H
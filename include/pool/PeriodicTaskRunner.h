@@ -0,0 +1,49 @@
+#ifndef PERIODICTASKRUNNER_H
+#define PERIODICTASKRUNNER_H
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <chrono>
+
+// 周期任务线程：在一个后台线程中按各自的间隔执行注册的任务（如批量写回、后台校准）
+// 任务在后台线程中串行执行，不占用事件循环线程
+class PeriodicTaskRunner
+{
+private:
+    struct Task
+    {
+        std::string name;                                // 任务名（日志用）
+        std::chrono::milliseconds interval;              // 执行间隔
+        std::chrono::steady_clock::time_point nextRun;   // 下次执行时间
+        std::function<void()> fn;                        // 任务函数
+    };
+
+    std::string name_;                    // 线程名（日志用）
+    std::vector<Task> tasks_;             // 已注册的任务
+    std::mutex mutex_;                    // 保护 tasks_ 与 stop_
+    std::condition_variable condition_;   // 用于等待下一个任务到期或停止
+    std::thread thread_;                  // 后台线程
+    bool started_;                        // 是否已启动
+    bool stop_;                           // 是否停止
+
+    void Run();
+
+public:
+    explicit PeriodicTaskRunner(const std::string& name);
+    ~PeriodicTaskRunner();
+
+    // 注册周期任务，启动前后均可调用，首次执行在一个间隔之后
+    void AddTask(const std::string& name, int intervalMs, std::function<void()> fn);
+
+    // 启动后台线程
+    void Start();
+
+    // 停止后台线程，等待正在执行的任务结束
+    void Stop();
+};
+
+#endif // PERIODICTASKRUNNER_H
@@ -0,0 +1,63 @@
+#ifndef BLOBSCRUBBER_H
+#define BLOBSCRUBBER_H
+
+#include <string>
+#include <deque>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+
+#include "Common.h"
+#include "BlockChecksum.h"
+
+// blob 完整性巡检：逐个读取 blob，按块与旁路文件中的 CRC32C 比对，发现位翻转与截断
+// 每次只校验有限字节数，进度跨调用保留，由周期任务按配置的速率驱动；缺少旁路文件的旧 blob 以当前内容补写校验和
+// Step() 只在上传目录所在设备的磁盘线程中调用，与 blob 的删除串行
+class BlobScrubber
+{
+private:
+    std::string blobDir_;                 // blob 根目录
+    std::deque<std::string> pending_;     // 本轮尚未巡检的 blob 路径
+    std::vector<char> buffer_;            // 读取缓冲区（一块）
+
+    // 当前正在巡检的 blob
+    std::string current_;                 // 路径，为空表示没有
+    int fd_;                              // 文件描述符
+    uint64_t size_;                       // 打开时的文件大小
+    uint64_t offset_;                     // 已校验到的偏移
+    BlockChecksum expected_;              // 旁路文件中的校验和
+    bool adopting_;                       // 无旁路文件，正在为其计算校验和
+    BlockChecksum computed_;              // adopting_ 时计算的校验和
+    bool inPass_;                         // 一轮巡检进行中
+
+    std::atomic<uint64_t> scannedBlobs_;  // 已巡检的 blob 数
+    std::atomic<uint64_t> scannedBytes_;  // 已读取的字节数
+    std::atomic<uint64_t> corrupted_;     // 发现损坏的 blob 数
+    std::atomic<uint64_t> adopted_;       // 补写旁路文件的 blob 数
+    std::atomic<uint64_t> passes_;        // 完成的全量巡检轮数
+
+    // 列出全部 blob，开始新一轮巡检
+    void Rescan();
+    // 打开下一个 blob，没有时返回 false
+    bool OpenNext();
+    // 结束当前 blob
+    void CloseCurrent();
+    // 当前 blob 校验失败
+    void ReportCorrupt(const std::string& reason);
+
+public:
+    DISALLOW_COPY_AND_MOVE(BlobScrubber);
+    explicit BlobScrubber(const std::string& blobDir);
+    ~BlobScrubber();
+
+    // 校验至多约 budget 字节（至少一块），返回实际读取的字节数
+    uint64_t Step(uint64_t budget);
+
+    uint64_t ScannedBlobs() const { return scannedBlobs_.load(); }
+    uint64_t ScannedBytes() const { return scannedBytes_.load(); }
+    uint64_t Corrupted() const { return corrupted_.load(); }
+    uint64_t Adopted() const { return adopted_.load(); }
+    uint64_t Passes() const { return passes_.load(); }
+};
+
+#endif // BLOBSCRUBBER_H
@@ -0,0 +1,56 @@
+#ifndef BLOBSTORE_H
+#define BLOBSTORE_H
+
+#include <string>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+#include "Common.h"
+#include "BlockChecksum.h"
+
+// 内容寻址的去重存储：相同内容（SHA-256）只保存一份 blob，位于 <上传目录>/.blobs/<摘要前两位>/<摘要>
+// 每个上传文件名都是 blob 的硬链接，引用计数即文件系统的链接数，下载路径无需任何改动
+// 每个 blob 旁边保存分块校验和 <摘要>.crc，供后台巡检与下载校验使用
+class BlobStore
+{
+private:
+    static constexpr size_t kLockStripes = 16;  // 按摘要分段加锁，同一摘要的提交与释放串行
+
+    std::string blobDir_;                      // blob 根目录
+    std::mutex locks_[kLockStripes];
+    std::atomic<uint64_t> stored_;             // 新建 blob 次数
+    std::atomic<uint64_t> deduplicated_;       // 命中已有 blob 次数
+    std::atomic<uint64_t> savedBytes_;         // 去重节省的字节数
+    std::atomic<uint64_t> released_;           // 最后一个引用删除、blob 被回收的次数
+
+    std::mutex& LockFor(const std::string& digest);
+
+public:
+    DISALLOW_COPY_AND_MOVE(BlobStore);
+    explicit BlobStore(const std::string& uploadDir);
+
+    // blob 根目录
+    const std::string& BlobDir() const { return blobDir_; }
+    // blob 路径
+    std::string BlobPath(const std::string& digest) const;
+    // blob 分块校验和旁路文件路径
+    std::string ChecksumPath(const std::string& digest) const;
+
+    // 上传完成后提交：已有相同内容的 blob 时将 filePath 原子替换为 blob 的硬链接（释放刚写入的副本），
+    // 否则将 filePath 登记为新 blob（仅增加一个硬链接，不拷贝数据）
+    // checksum 不为空时作为新 blob 的分块校验和写入旁路文件（已有 blob 缺少旁路文件时补写）
+    // 返回是否命中已有 blob，失败时 filePath 保持为独立文件
+    bool Commit(const std::string& filePath, const std::string& digest, uintmax_t size,
+                const BlockChecksum* checksum = nullptr);
+
+    // 删除文件：移除 filePath，若其 blob 已无其他引用则连同旁路文件一并回收；digest 为空（去重前的旧文件）时只删除文件
+    void Release(const std::string& filePath, const std::string& digest);
+
+    uint64_t Stored() const { return stored_.load(); }
+    uint64_t Deduplicated() const { return deduplicated_.load(); }
+    uint64_t SavedBytes() const { return savedBytes_.load(); }
+    uint64_t Released() const { return released_.load(); }
+};
+
+#endif // BLOBSTORE_H
@@ -0,0 +1,45 @@
+#ifndef BLOCKCHECKSUM_H
+#define BLOCKCHECKSUM_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// 按固定大小分块的 CRC32C 校验和：上传时边写边计算，随 blob 保存为旁路文件 <blob>.crc
+// 后台巡检与下载校验按块比对，定位到具体损坏的块
+class BlockChecksum
+{
+public:
+    static constexpr uint32_t kBlockSize = 1024 * 1024;  // 分块大小，与下载读取块大小一致
+
+private:
+    std::vector<uint32_t> blocks_;   // 已完成块的校验和
+    uint32_t current_;               // 当前未满块的校验和
+    uint32_t currentLen_;            // 当前未满块的字节数
+    uint64_t totalBytes_;            // 累计字节数
+    bool finished_;                  // 已结束计算
+
+public:
+    BlockChecksum();
+
+    // 追加数据
+    void Update(const void* data, size_t len);
+    // 结束计算，补上最后一个不满的块
+    void Finish();
+
+    // 各块校验和（Finish 或 Load 之后有效）
+    const std::vector<uint32_t>& Blocks() const { return blocks_; }
+    uint64_t TotalBytes() const { return totalBytes_; }
+    bool IsFinished() const { return finished_; }
+    // 第 index 块的数据是否与记录一致，index 超出范围时返回 false
+    bool VerifyBlock(size_t index, const void* data, size_t len) const;
+
+    // 旁路文件路径
+    static std::string SidecarPath(const std::string& blobPath) { return blobPath + ".crc"; }
+    // 写入旁路文件（先写临时文件再 rename，不会留下半个文件）
+    bool Save(const std::string& path) const;
+    // 读取旁路文件，文件不存在或格式不符时返回 false
+    bool Load(const std::string& path);
+};
+
+#endif // BLOCKCHECKSUM_H
@@ -10,38 +10,103 @@
 #include <cstdint>
 #include <experimental/filesystem>
 
+#include "HttpRange.h"
+#include "BodySource.h"
+#include "DiskIoExecutor.h"
+#include "BlockChecksum.h"
+
 namespace fs = std::experimental::filesystem; 
 
-// 文件下载上下文类
-class FileDownContext 
+// 文件下载上下文类：作为文件区间数据源，由连接在发送缓冲区排空后按块拉取
+// 启用异步读取后，文件数据由磁盘 I/O 执行器读取，事件循环线程不再阻塞在磁盘读上
+class FileDownContext : public BodySource, public std::enable_shared_from_this<FileDownContext>
 {
 private:
     std::string filepath_;        // 文件路径
     std::string originalFileName_; // 原始文件名
-    std::ifstream file_;          // 输入文件流描述符
+    int fd_;                      // 文件描述符
     uintmax_t fileSize_;          // 文件总大小
     uintmax_t currentPosition_;   // 当前读取位置
     bool isComplete_;             // 文件是否读取完成
 
+    std::vector<ByteRange> ranges_;   // 待发送的字节范围（按文件偏移排序）
+    size_t rangeIndex_;               // 当前正在发送的范围下标
+    bool multipart_;                  // 是否按 multipart/byteranges 封装多个范围
+    std::string boundary_;            // multipart 分隔符
+    std::string partContentType_;     // multipart 每个分段的 Content-Type
+    bool partHeaderSent_;             // 当前范围的分段头是否已发送
+    bool trailerSent_;                // multipart 结束分隔符是否已发送
+    bool readError_;                  // 读取失败（如文件在发送过程中被截断）
+
+    DiskIoExecutor* diskIo_;                  // 异步读取使用的执行器，为空时在调用线程中同步读取
+    dev_t device_;                            // 文件所在设备，异步读取提交到该设备的队列
+    EventLoop* loop_;                         // 读取完成回调投递的事件循环
+    std::weak_ptr<Connection> conn_;          // 数据就绪后恢复其发送
+    std::shared_ptr<std::string> ready_;      // 已读取、尚未发送的数据块
+    uintmax_t readyOffset_;                   // ready_ 在文件中的偏移
+    bool readInFlight_;                       // 是否有读取任务尚未完成
+
+    // 提交读取 [offset, offset + len) 的任务，完成后恢复连接的发送
+    void SubmitRead(uintmax_t offset, size_t len);
+    // 预取下一块：当前块交给发送缓冲区后立即提交下一块的读取，与发送重叠
+    void Prefetch();
+
+    uintmax_t readaheadEnd_;                  // 当前范围内已提交预读的末尾偏移
+    uintmax_t droppedTo_;                     // 当前范围内已释放页缓存的末尾偏移
+    bool dropBehind_;                         // 大文件：释放已发送部分的页缓存，避免一次性下载挤占缓存
+
+    // 按当前位置向内核提交预读并释放已发送部分的页缓存，异步读取时在磁盘线程中执行
+    void Advise(uintmax_t position, const ByteRange& range);
+    // 从 offset 开始、不超过 rangeEnd 的下一次读取长度
+    uintmax_t ChunkLength(uintmax_t offset, uintmax_t rangeEnd) const;
+
+    BlockChecksum checksum_;                  // 文件的分块校验和
+    bool verify_;                             // 发送前按块校验读出的数据
+
+    // 校验从 offset 开始的一段数据，只校验完整覆盖的块（文件末尾的短块视为完整），返回是否一致
+    bool VerifyChunk(uintmax_t offset, const char* data, size_t len) const;
+
+    std::string etag_;                // 强 ETag（由 inode、大小与纳秒级修改时间生成）
+    time_t mtime_;                    // 文件修改时间（秒）
+    std::string lastModified_;        // HTTP-date 格式的修改时间
+
+    // multipart 分段头：\r\n--boundary\r\nContent-Type: ...\r\nContent-Range: ...\r\n\r\n
+    std::string PartHeader(const ByteRange& range) const;
+    // multipart 结束分隔符：\r\n--boundary--\r\n
+    std::string Trailer() const;
+
 public:
     FileDownContext(const std::string& filepath, const std::string& originalFileName);
     ~FileDownContext();
 
-    // 将文件指针移至指定位置
-    void SeekTo(uintmax_t position);
+    // 设置要发送的字节范围，多个范围时按 multipart/byteranges 格式封装
+    void SetRanges(const std::vector<ByteRange>& ranges, const std::string& boundary = "",
+                   const std::string& partContentType = "application/octet-stream");
+
+    // 响应正文总长度（包含 multipart 分段头与结束分隔符），用于 Content-Length
+    uintmax_t GetBodyLength() const;
+    int64_t Length() const override { return static_cast<int64_t>(GetBodyLength()); }
 
-    // 读取下一个文件块
-    bool ReadNextChunk(std::string& chunk);
+    // 由磁盘 I/O 执行器异步读取文件（按文件所在设备排队），数据未就绪时 Read() 返回 kPending
+    void EnableAsyncRead(DiskIoExecutor* executor, const spConnection& conn);
 
-    // 检查文件是否读取完成
-    bool IsComplete() const;
+    // 发送前按 sidecarPath 中的分块校验和校验数据，发现不一致时中止发送；旁路文件不存在或与文件不符时返回 false
+    bool EnableVerify(const std::string& sidecarPath);
 
-    // 获取当前读取位置
-    uintmax_t GetCurrentPosition() const;
+    // 向发送缓冲区追加下一个正文块，在当前范围末尾精确停止
+    StreamState Read(Buffer* output) override;
 
     // 获取文件总大小
     uintmax_t GetFileSize() const;
 
     // 获取原始文件名
     const std::string& GetOriginalFileName() const;
+    // 文件路径
+    const std::string& GetFilePath() const { return filepath_; }
+
+    // 强校验 ETag，用于 If-None-Match / If-Range
+    const std::string& GetETag() const { return etag_; }
+    // 文件修改时间及其 HTTP-date 形式，用于 Last-Modified / If-Modified-Since
+    time_t GetModifiedTime() const { return mtime_; }
+    const std::string& GetLastModified() const { return lastModified_; }
 };
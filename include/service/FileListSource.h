@@ -0,0 +1,45 @@
+#ifndef FILELISTSOURCE_H
+#define FILELISTSOURCE_H
+
+#include <memory>
+
+#include "BodySource.h"
+#include "JsonWriter.h"
+#include "HttpCompressor.h"
+#include "MySqlConnection.h"
+
+// 文件列表响应体：当前页的结果行在处理函数中一次读出并生成 JSON（单页文件数有上限，内存占用有界），
+// 数据库连接在开始发送前即归还连接池，慢速客户端不会占住连接；发送时由连接在发送缓冲区排空后按批拉取，需要时边拉取边压缩
+class FileListSource : public BodySource
+{
+private:
+    long long limit_;                             // 分页大小
+    long long rowCount_;                          // 已输出的文件数
+    long long lastId_;                            // 最后一个文件 id，用作下一页游标
+    int64_t length_;                              // 未压缩时的响应体长度
+    bool finished_;                               // JSON 是否已全部输出
+
+    Buffer json_;                                 // 生成的 JSON，尚未发送的部分
+    JsonWriter writer_;                           // JSON 输出器
+    std::unique_ptr<StreamCompressor> compressor_; // 流式压缩器，不压缩时为空
+
+    // 将当前行写为文件信息对象
+    void WriteRow(const MySqlStatement& stmt);
+
+public:
+    DISALLOW_COPY_AND_MOVE(FileListSource);
+    FileListSource(long long limit, ContentEncoding encoding);
+
+    // 读出 stmt 的全部结果行并生成 JSON，列顺序与 HandleListFiles 的查询一致；取行失败返回 false
+    // 返回后不再引用 stmt，其所在的数据库连接可以归还
+    bool Load(MySqlStatement* stmt);
+
+    // 是否按协商结果压缩输出（需设置 Content-Encoding）
+    bool IsCompressed() const { return compressor_ != nullptr; }
+
+    // 不压缩时长度已知（Content-Length），压缩时按 chunked 发送
+    int64_t Length() const override { return compressor_ ? -1 : length_; }
+    StreamState Read(Buffer* output) override;
+};
+
+#endif // FILELISTSOURCE_H
@@ -0,0 +1,102 @@
+#ifndef FILEMETACACHE_H
+#define FILEMETACACHE_H
+
+#include <string>
+#include <vector>
+#include <list>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+#include <cstdint>
+#include <ctime>
+
+#include "Common.h"
+
+// 文件的一条分享记录
+struct ShareMeta
+{
+    int id;                   // 分享记录 ID
+    std::string shareType;    // 分享类型：public、protected、user
+    int sharedWithId;         // 指定用户分享的目标用户 ID，其他类型为 0
+    std::string shareCode;    // 分享码
+    std::string extractCode;  // 提取码（protected）
+    time_t expire;            // 过期时间戳，0 表示永不过期
+    std::string expireTime;   // 数据库中的过期时间原文（用于响应）
+    std::string createdAt;    // 分享时间原文
+
+    bool IsExpired(time_t now) const { return expire != 0 && expire <= now; }
+};
+
+// 文件元数据：下载、分享、删除的权限判断所需的全部信息
+struct FileMeta
+{
+    int id;                         // 文件 ID
+    std::string filename;           // 服务器文件名
+    std::string originalName;       // 原始文件名
+    uintmax_t size;                 // 文件大小
+    std::string fileType;           // 文件类型
+    int ownerId;                    // 所有者用户 ID
+    std::string ownerUsername;      // 所有者用户名
+    std::string contentHash;        // 内容摘要（去重存储的 blob），旧文件为空
+    std::vector<ShareMeta> shares;  // 该文件的全部分享记录
+
+    // 按分享码查找未过期的分享记录，不存在返回 nullptr
+    const ShareMeta* FindShare(const std::string& shareCode, time_t now) const;
+};
+
+// 文件元数据 LRU 缓存：以服务器文件名为键，另维护分享码、文件 ID 到文件名的索引
+// 上传、删除、分享变更时显式失效；未命中时由调用方查询数据库后写入
+class FileMetaCache
+{
+private:
+    using MetaPtr = std::shared_ptr<const FileMeta>;
+
+    struct Entry
+    {
+        MetaPtr meta;                              // 元数据（只读，命中后可在锁外使用）
+        time_t cacheExpire;                        // 缓存项本地有效期，兜底其他进程的修改
+        std::list<std::string>::iterator lruPos;   // 在 LRU 链表中的位置
+    };
+
+    std::mutex mutex_;
+    std::list<std::string> lru_;                                   // 最近使用的在前
+    std::unordered_map<std::string, Entry> entries_;               // <服务器文件名, 缓存项>
+    std::unordered_map<std::string, std::string> shareCodeIndex_;  // <分享码, 服务器文件名>
+    std::unordered_map<int, std::string> fileIdIndex_;             // <文件 ID, 服务器文件名>
+    uint64_t generation_;            // 每次失效递增，丢弃失效前开始加载的结果
+    int ttl_;                        // 缓存项本地有效期（秒）
+    size_t capacity_;                // 最多缓存的文件数
+    std::atomic<uint64_t> hits_;     // 命中次数
+    std::atomic<uint64_t> misses_;   // 未命中次数
+
+    // 删除缓存项及其索引，调用方需持有锁
+    void EraseLocked(std::unordered_map<std::string, Entry>::iterator it);
+    // 按文件名查找并更新 LRU 顺序，调用方需持有锁
+    MetaPtr GetLocked(const std::string& filename, time_t now);
+
+public:
+    DISALLOW_COPY_AND_MOVE(FileMetaCache);
+    FileMetaCache(int ttl, size_t capacity);
+    ~FileMetaCache();
+
+    // 按服务器文件名查询，未命中返回 nullptr
+    MetaPtr Get(const std::string& filename);
+    // 按分享码查询，未命中返回 nullptr
+    MetaPtr GetByShareCode(const std::string& shareCode);
+
+    // 当前代数，加载前获取，写入时传回
+    uint64_t Generation();
+    // 写入查询结果，期间若发生过失效则丢弃（避免旧数据覆盖失效）
+    void Put(const MetaPtr& meta, uint64_t generation);
+
+    // 失效指定文件（上传、删除时调用）
+    void InvalidateFile(const std::string& filename);
+    // 按文件 ID 失效（分享变更时调用）
+    void InvalidateFileId(int fileId);
+
+    uint64_t Hits() const { return hits_.load(); }
+    uint64_t Misses() const { return misses_.load(); }
+};
+
+#endif // FILEMETACACHE_H
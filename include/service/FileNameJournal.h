@@ -0,0 +1,70 @@
+#ifndef FILENAMEJOURNAL_H
+#define FILENAMEJOURNAL_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <unordered_map>
+#include <cstdint>
+
+#include "Common.h"
+
+// 文件名映射 <服务器文件名, 原始文件名> 的追加式日志存储
+// 每次修改只追加一条 put/delete 记录（带 CRC 校验），启动时顺序重放；
+// 失效记录过多时由后台任务压缩为快照，压缩期间的修改同时写入新文件，不阻塞请求
+// 记录格式：crc32(4) | 类型(1) | 键长度(4) | 值长度(4) | 键 | 值，crc 覆盖类型到值的全部字节
+class FileNameJournal
+{
+private:
+    std::string path_;                                         // 日志文件路径
+    int fd_;                                                   // 追加写的文件描述符
+    std::mutex mutex_;                                         // 保护以下所有成员
+    std::unordered_map<std::string, std::string> entries_;     // 当前映射
+    uint64_t records_;                                         // 日志文件中的记录数（含失效记录）
+    bool compacting_;                                          // 是否正在压缩
+    std::vector<std::string> pendingRecords_;                  // 压缩期间产生的记录，切换前补写到新文件
+    std::atomic<uint64_t> appends_;                            // 累计追加的记录数
+    std::atomic<uint64_t> compactions_;                        // 累计压缩次数
+
+    // 编码一条记录
+    static std::string Encode(uint8_t type, const std::string& key, const std::string& value);
+    // 将数据完整写入 fd
+    static bool WriteAll(int fd, const char* data, size_t len);
+    // 追加一条记录，调用方需持有锁
+    void AppendLocked(const std::string& record);
+    // 重放日志，末尾不完整或校验失败的记录（写入中途崩溃）被截断
+    bool Replay();
+
+public:
+    DISALLOW_COPY_AND_MOVE(FileNameJournal);
+    explicit FileNameJournal(const std::string& path);
+    ~FileNameJournal();
+
+    // 打开日志并重放，文件不存在时创建
+    bool Open();
+    // 导入旧版 JSON 映射文件（日志为空时），导入后写入快照并将旧文件重命名为 .migrated，返回导入的条目数
+    size_t ImportJson(const std::string& jsonPath);
+
+    // 写入或更新映射
+    void Put(const std::string& serverFileName, const std::string& originalFileName);
+    // 删除映射
+    void Erase(const std::string& serverFileName);
+    // 批量删除映射，全部删除记录一次写入
+    void EraseBatch(const std::vector<std::string>& serverFileNames);
+    // 查询原始文件名，不存在返回 false
+    bool Get(const std::string& serverFileName, std::string* originalFileName);
+    size_t Size();
+
+    // 失效记录数超过有效条目数（且记录足够多）时需要压缩
+    bool NeedsCompaction();
+    // 将当前映射写为新的快照文件并原子替换旧日志
+    bool Compact();
+    // 将已追加的记录刷到磁盘
+    void Sync();
+
+    uint64_t Appends() const { return appends_.load(); }
+    uint64_t Compactions() const { return compactions_.load(); }
+};
+
+#endif // FILENAMEJOURNAL_H
@@ -5,10 +5,18 @@
 #include <sys/types.h>
 #include <iostream>
 #include <cstdint>
+#include <memory>
+#include <atomic>
 #include <experimental/filesystem>
 
+#include "Sha256.h"
+#include "UploadWriter.h"
+#include "BlockChecksum.h"
+
 namespace fs = std::experimental::filesystem; 
 
+class QuotaReservation;
+
 // 上传解析状态枚举
 enum class State 
 {
@@ -19,26 +27,52 @@ enum class State
 };
 
 // 文件上传上下文类，用于管理上传过程中单个文件的写入状态、边界等信息
+// 事件循环线程解析出的文件数据先暂存，再整段交给磁盘 I/O 线程写入文件并计算摘要
 class FileUploadContext 
 {
 private:
     std::string fileName_;         // 文件在服务器上的保存路径
     std::string originalFileName_; // 上传文件的原始名称（如上传表单中文件名）
-    std::ofstream file_;           // 文件输出流，用于写入上传内容
+    UploadWriter writer_;          // 文件写入器（预分配空间、批量写入），仅在磁盘线程中使用
+    dev_t device_;                 // 文件所在设备，写入任务提交到该设备的队列
+    uint64_t expectedSize_;        // 预计大小，创建文件时按其预分配空间
+    std::shared_ptr<std::string> staged_; // 已解析、尚未提交写盘的数据
+    uint64_t inflightBytes_;       // 已提交、尚未写完的字节数（仅在事件循环线程中访问）
+    std::atomic<bool> failed_;     // 写盘失败
     uintmax_t totalBytes_;         // 累计写入的文件字节数
     State state_;                  // 上传状态
     std::string boundary_;         // multipart/form-data 边界字符串
+    Sha256 hasher_;                // 边写入边计算内容摘要，用于去重存储
+    std::string contentHash_;      // 内容摘要（上传完成后首次获取时计算）
+    BlockChecksum checksum_;       // 分块 CRC32C 校验和，随 blob 保存
+    std::shared_ptr<QuotaReservation> reservation_; // 上传预留的配额空间，随上下文销毁归还
 
 
 public:
-    // 构造函数：传入保存路径和原始文件名
-    FileUploadContext(const std::string& fileName, const std::string& originalFileName);
+    // 构造函数：传入保存路径、原始文件名、文件所在设备和预计大小（请求的 Content-Length，用于预分配空间）
+    // 只记录参数，文件由 Open() 在磁盘线程中创建
+    FileUploadContext(const std::string& fileName, const std::string& originalFileName, dev_t device,
+                      uint64_t expectedSize = 0);
 
-    // 析构函数：关闭文件句柄
-    ~FileUploadContext();
-
-    // 写入数据到文件
+    // 暂存一段文件数据，由 TakeStaged() 取出后提交写盘
     void WriteData(const char* data, size_t len);
+    // 取出暂存的数据（可能为空）
+    std::shared_ptr<std::string> TakeStaged();
+
+    // 以下在磁盘线程中调用
+    // 创建文件并预分配空间，须先于写入任务提交；失败时标记写盘失败，后续数据被忽略
+    bool Open();
+    // 写入数据并更新内容摘要与分块校验和，失败后忽略后续数据
+    void WriteToDisk(const std::string& data);
+    // 写出缓冲的数据并关闭文件，上传完成后、使用文件前调用
+    bool Finish();
+
+    // 写盘是否失败
+    bool HasFailed() const { return failed_; }
+    dev_t GetDevice() const { return device_; }
+    // 登记已提交/已写完的字节数，返回当前积压字节数
+    uint64_t AddInflight(uint64_t bytes) { return inflightBytes_ += bytes; }
+    uint64_t SubInflight(uint64_t bytes) { return inflightBytes_ -= bytes; }
 
     // 获取已写入总字节数
     uintmax_t GetTotalBytes() const;
@@ -49,11 +83,19 @@ public:
     // 获取客户端上传的原始文件名
     const std::string& GetOriginalFileName() const;
 
+    // 获取已写入内容的 SHA-256 十六进制摘要，获取后不应再写入数据
+    const std::string& GetContentHash();
+    // 获取分块校验和（Finish 之后有效）
+    const BlockChecksum& GetChecksum() const { return checksum_; }
+
     // 设置 multipart 边界字符串
     void SetBoundary(const std::string& boundary);
     // 获取 multipart 边界
     const std::string& GetBoundary()const;
 
+    // 绑定上传预留的配额空间
+    void SetReservation(std::shared_ptr<QuotaReservation> reservation) { reservation_ = std::move(reservation); }
+
     // 获取当前解析状态
     State GetState() const;
     // 设置当前解析状态
@@ -19,6 +19,20 @@
 #include "FileDownContext.h"
 #include "FileUploadContext.h"
 #include "MySqlConnectionPool.h"
+#include "StaticFileCache.h"
+#include "SessionCache.h"
+#include "FileMetaCache.h"
+#include "FileNameJournal.h"
+#include "BlobStore.h"
+#include "BlobScrubber.h"
+#include "UploadLayout.h"
+#include "UploadSessionManager.h"
+#include "SessionRefresher.h"
+#include "QuotaManager.h"
+#include "ShareCodeFilter.h"
+#include "UserSearchIndex.h"
+#include "PeriodicTaskRunner.h"
+#include "DiskIoExecutor.h"
 
 namespace fs = std::experimental::filesystem; 
 
@@ -59,12 +73,45 @@ private:
     std::string uploadDir_;             // 上传目录
     std::string mapFile_;               // 文件名映射文件
     std::atomic<int> activeRequests_;   // 活跃请求计数
-    std::mutex mapMutex_;               // 保护文件名映射的互斥锁
-    std::map<std::string, std::string> fileNameMap_;  // 文件名映射 <服务器文件名, 原始文件名>
+    FileNameJournal fileNameJournal_;   // 文件名映射 <服务器文件名, 原始文件名>（追加式日志）
+    UploadLayout uploadLayout_;         // 上传目录的分层布局（ab/cd/<文件名>）
+    BlobStore blobStore_;               // 按内容摘要去重的 blob 存储
+    BlobScrubber scrubber_;             // blob 完整性后台巡检
+    std::atomic<uint64_t> scrubRate_;   // 巡检读取速率（字节/秒），0 表示关闭
+    std::atomic<bool> scrubInFlight_;   // 已提交的巡检任务尚未完成
+    bool verifyDownloads_;              // 下载时按块校验 CRC32C
+    UploadSessionManager uploadSessions_; // 分片上传会话
+
+    uint64_t maxUploadSize_;            // 单个上传请求体的最大字节数，超出返回 413
+
+    // 静态页面与图标缓存
+    StaticFileCache staticCache_;
+
+    // 会话缓存，ValidateSession 命中时不再查询数据库
+    SessionCache sessionCache_;
+    // 会话滑动过期的延迟批量写回
+    SessionRefresher sessionRefresher_;
+    // 文件元数据缓存，下载、分享、删除的权限判断命中时不再查询数据库
+    FileMetaCache fileMetaCache_;
+    // 用户存储配额与已用空间
+    QuotaManager quota_;
+    // 分享码存在性过滤（Bloom 过滤器 + 负缓存），不存在的分享码不查询数据库
+    ShareCodeFilter shareCodes_;
+    // 用户名搜索索引（前缀 + 三元组），用户搜索不查询数据库
+    UserSearchIndex userIndex_;
+    // 后台周期任务线程
+    PeriodicTaskRunner backgroundTasks_;
+    uint64_t lastCompressionIn_;        // 上次输出压缩统计时的累计输入字节数，只在后台任务线程中访问
+    // 磁盘 I/O 执行器：上传写盘、下载读盘、删除等在磁盘线程中执行，完成后回到事件循环
+    DiskIoExecutor diskIo_;
+    dev_t uploadDevice_;                // 上传目录所在设备
 
     // 路由表
     std::vector<RoutePattern> routes_;
 
+    // 预渲染的固定错误响应 <(状态码, 消息), 报文>，构造时生成，之后只读
+    std::map<std::pair<int, std::string>, PrerenderedResponse> cannedResponses_;
+
 public:
     // 构造函数，初始化服务器监听地址、线程数及线程池大小
     HttpServer(const std::string& ip, 
@@ -80,6 +127,13 @@ public:
 
     // 停止服务器服务，包括线程池与 TcpServer 以及异步日志
     void StopService();
+
+    // 设置单个上传请求体的最大字节数
+    void SetMaxUploadSize(uint64_t maxUploadSize) { maxUploadSize_ = maxUploadSize; }
+    // 设置 blob 巡检的读取速率（字节/秒），0 表示关闭巡检
+    void SetScrubRate(uint64_t bytesPerSecond) { scrubRate_ = bytesPerSecond; }
+    // 设置下载时是否按块校验数据，校验失败时中止该下载
+    void SetVerifyDownloads(bool verify) { verifyDownloads_ = verify; }
     
 
 private:
@@ -97,6 +151,10 @@ private:
     // 生成响应
     std::string GenerateHttpResponse(const std::string& message, 
                                    const HttpStatusCode code);
+    // 预渲染常用错误响应
+    void InitCannedResponses();
+    // 将响应直接序列化到连接的发送缓冲区
+    void SendResponse(const spConnection &conn, HttpResponse* response);
     // 发送错误报文
     void SendBadRequestResponse(spConnection conn, const HttpStatusCode code, const std::string& message);
 
@@ -106,20 +164,60 @@ private:
     void OnMessage(spConnection conn, std::string &message);
 
     void OnRequest(const spConnection &conn, HttpRequest &request, HttpResponse* response);
+    // 请求头到达后、请求体到达前的预检查（会话、大小限制），通过时按需回复 100 Continue
+    bool PrecheckRequest(const spConnection &conn, HttpRequest &request, bool bodyPending);
+    // 拒绝请求：发送错误响应后关闭连接，不再读取剩余请求体
+    void RejectRequest(const spConnection &conn, const HttpStatusCode code, const std::string& message);
     
     // HTTP 请求处理器，用于处理访问网站首页或静态 HTML 页面
     void HandleIndex(const spConnection &conn, HttpRequest &request, HttpResponse *response);
 
     // 处理文件上传
     void HandleFileUpload(const spConnection &conn, HttpRequest &request, HttpResponse *response);
+    // 分片上传：创建会话、上传分片（PUT，按偏移写入）、查询已接收区间、提交、取消
+    void HandleCreateUploadSession(const spConnection &conn, HttpRequest &request, HttpResponse *response);
+    void HandleUploadPart(const spConnection &conn, HttpRequest &request, HttpResponse *response);
+    void HandleUploadSessionStatus(const spConnection &conn, HttpRequest &request, HttpResponse *response);
+    void HandleCommitUploadSession(const spConnection &conn, HttpRequest &request, HttpResponse *response);
+    void HandleAbortUploadSession(const spConnection &conn, HttpRequest &request, HttpResponse *response);
+    // 将上传解析出的数据提交到磁盘线程写入，积压过多时暂停读取该连接
+    void SubmitUploadData(const spConnection &conn, const std::shared_ptr<FileUploadContext>& uploadContext);
+    // 在磁盘线程中创建上传文件并预分配空间，失败时拒绝该上传
+    void OpenUploadFile(const spConnection &conn, const std::shared_ptr<FileUploadContext>& uploadContext);
+    // 上传数据全部写盘并按内容去重后登记文件并响应（事件循环线程）
+    void CompleteFileUpload(const spConnection &conn, const std::shared_ptr<FileUploadContext>& uploadContext,
+                            int userId, bool finished, bool deduplicated);
+    // 将一段分片数据提交到磁盘线程写入
+    void SubmitUploadPartData(const spConnection &conn, const std::shared_ptr<UploadPartContext>& part,
+                              std::shared_ptr<const std::string> data);
+    // 分片数据全部写盘后保存进度并响应（事件循环线程）
+    void FinishUploadPart(const spConnection &conn, const std::shared_ptr<UploadPartContext>& part);
+    // 查找属于当前登录用户的上传会话，失败时发送错误响应并返回 nullptr
+    std::shared_ptr<UploadSession> FindUploadSession(const spConnection &conn, HttpRequest &request, 
+                                                     const std::string& uploadId);
+    // 登记上传完成的文件：写入数据库与文件名映射，返回文件 ID
+    // 按内容去重（BlobStore::Commit）须已在磁盘线程中完成，deduplicated 为其结果
+    int RegisterUploadedFile(const std::string& filepath, const std::string& originalFileName, uintmax_t fileSize,
+                             const std::string& contentHash, int userId, bool deduplicated);
     // 查询数据库并根据文件的所有者和共享信息构建文件列表
     void HandleListFiles(const spConnection &conn, HttpRequest &request, HttpResponse *response);
     // 处理文件下载请求，根据请求的类型返回不同的文件内容
     void HandleDownload(const spConnection &conn, HttpRequest &request, HttpResponse *response);
+    // 下载已上传的文件（两个下载接口共用）：在上传目录的磁盘队列中定位并打开文件，与布局迁移串行，
+    // 不会在文件移动途中找不到文件；contentHash 用于定位分块校验和，启用下载校验时使用
+    void SendStoredFile(const spConnection &conn, const HttpRequest &request, const std::string& fileName,
+                        const std::string& originalFileName, const std::string& contentHash);
+    // 发送已打开文件的内容：处理 HEAD 与单/多范围 Range 请求，按 Content-Length 定长分块发送
+    void SendFileContent(const spConnection &conn, const HttpRequest &request, HttpResponse *response,
+                         const std::shared_ptr<FileDownContext>& downContext);
     // 删除文件
     void HandleDelete(const spConnection &conn, HttpRequest &request, HttpResponse *response);
     // 文件分享处理函数
     void HandleShareFile(const spConnection &conn, HttpRequest &request, HttpResponse *response);
+    // 批量删除文件：{"filenames": [...]}，在一个事务中完成，blob 回收异步执行
+    void HandleBatchDelete(const spConnection &conn, HttpRequest &request, HttpResponse *response);
+    // 批量分享文件：{"fileIds": [...], "shareType": ..., "expireTime": ..., "sharedWithId": ...}，在一个事务中完成
+    void HandleBatchShare(const spConnection &conn, HttpRequest &request, HttpResponse *response);
     // 通过分享码访问文件
     void HandleShareAccess(const spConnection &conn, HttpRequest &request, HttpResponse *response); 
     // 处理通过分享链接下载文件（支持权限判断与断点续传）
@@ -128,6 +226,9 @@ private:
     void HandleShareInfo(const spConnection &conn, HttpRequest &request, HttpResponse *response);
     // 处理 favicon.ico 请求（返回浏览器标签页图标）
     void HandleFavicon(const spConnection &conn, HttpRequest &request, HttpResponse *response);
+    // 发送缓存的静态资源，支持 If-None-Match / If-Modified-Since 返回 304
+    void SendStaticAsset(const spConnection &conn, HttpRequest &request, HttpResponse *response,
+                         const std::shared_ptr<const StaticAsset>& asset);
 
     // 用户注册
     void HandleRegister(const spConnection &conn, HttpRequest &request, HttpResponse *response);
@@ -138,13 +239,8 @@ private:
     // 检索用户
     void HandleSearchUsers(const spConnection &conn, HttpRequest &request, HttpResponse *response);
 
-    // 加载文件名映射
+    // 加载文件名映射（重放日志，首次启动时导入旧版 JSON 映射文件）
     void LoadFileNameMap(); 
-    // 内部函数，不加锁，加载文件名映射
-    void LoadFileNameMapInternal();
-    // 保存文件名映射
-    void SaveFileNameMap(); 
-    void SaveFileNameMapInternal(); 
 
     // 初始化路由表
     void InitRoutes();
@@ -161,6 +257,13 @@ private:
     bool ValidateSession(const std::string& sessionId, int& userId, std::string& username);
     // 结束会话，删除 session 数据
     void DeleteSession(const std::string& sessionId);
+    // 剩余有效期低于阈值时登记一次延迟刷新，并同步延长缓存中的过期时间
+    void RefreshSessionExpire(const std::string& sessionId, time_t sessionExpire);
+
+    // 获取文件元数据（含全部分享记录），优先读缓存，文件不存在返回 nullptr
+    std::shared_ptr<const FileMeta> LoadFileMeta(const std::string& filename);
+    // 按分享码获取文件元数据，分享不存在返回 nullptr
+    std::shared_ptr<const FileMeta> LoadFileMetaByShareCode(const std::string& shareCode);
 
 };
 
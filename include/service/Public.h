@@ -8,6 +8,8 @@
 #include <random>
 #include <iomanip>
 #include <string>
+#include <regex>
+#include <algorithm>
 #include <mysql.h>
 
 static std::string ParseCookie(const std::string& cookieHeader, const std::string& key) 
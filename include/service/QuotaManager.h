@@ -0,0 +1,90 @@
+#ifndef QUOTAMANAGER_H
+#define QUOTAMANAGER_H
+
+#include <mutex>
+#include <memory>
+#include <atomic>
+#include <cstdint>
+#include <unordered_map>
+
+#include "Common.h"
+#include "MySqlConnectionPool.h"
+
+class QuotaReservation;
+
+// 用户存储配额：已用空间（users.storage_used）由上传完成与删除路径增量维护，并缓存在内存中
+// 上传开始时预留声明的大小（检查与预留在同一把锁内完成），同一用户的并发上传合计不会超出配额；
+// 配额检查只查内存（每个用户首次检查时从数据库加载一次），后台周期任务按 files 表校正计数
+class QuotaManager
+{
+    friend class QuotaReservation;
+
+private:
+    struct Usage
+    {
+        uint64_t used;    // 已用字节数
+        uint64_t quota;   // 配额字节数
+    };
+
+    // 已预留、尚未登记的字节数：预留对象持有其引用，连接与上传会话晚于 QuotaManager 析构时仍可归还
+    struct Reservations
+    {
+        std::mutex mutex;                             // 保护 bytes，在 QuotaManager::mutex_ 之后获取
+        std::unordered_map<int, uint64_t> bytes;      // <用户 ID, 预留字节数>
+    };
+
+    std::mutex mutex_;                            // 保护 usage_，预留时与检查一起持有
+    std::unordered_map<int, Usage> usage_;        // <用户 ID, 用量>
+    std::shared_ptr<Reservations> reservations_;  // 进行中的上传预留的空间，校正时不清空
+    uint64_t defaultQuota_;                       // storage_quota 为 NULL 时的配额
+
+    std::atomic<uint64_t> rejected_;     // 因超出配额被拒绝的上传次数
+    std::atomic<uint64_t> loads_;        // 从数据库加载用量的次数
+    std::atomic<uint64_t> corrected_;    // 校正时计数有偏差的用户数（累计）
+
+    // 从数据库加载用户用量
+    bool Load(int userId, ConnectionPool* pool, Usage* usage);
+
+public:
+    DISALLOW_COPY_AND_MOVE(QuotaManager);
+    explicit QuotaManager(uint64_t defaultQuota);
+    ~QuotaManager();
+
+    // 已用空间加上进行中的上传已预留的空间，再写入 bytes 字节后仍在配额内时预留 bytes 字节并返回预留对象，否则返回 nullptr
+    // 预留对象销毁时归还空间：上传失败、取消或会话被清理时随上传状态销毁；登记成功时 Adjust 已计入实际大小，随后销毁即完成转换
+    // used / quota 返回当前用量（含预留）与配额，可为空
+    std::shared_ptr<QuotaReservation> TryReserve(int userId, uint64_t bytes, ConnectionPool* pool,
+                                                 uint64_t* used = nullptr, uint64_t* quota = nullptr);
+
+    // 上传完成（delta > 0）或删除文件（delta < 0）后更新用量，conn 为调用方已持有的数据库连接
+    // 数据库更新失败时返回 false，内存不变，偏差由周期校正修复
+    bool Adjust(int userId, int64_t delta, MySqlConnection* conn);
+    // Adjust 的两步，供事务使用：在事务中更新数据库计数，提交后再更新内存
+    bool AdjustStored(int userId, int64_t delta, MySqlConnection* conn);
+    void AdjustCached(int userId, int64_t delta);
+
+    // 按 files 表重新计算全部用户的已用空间并清空内存缓存（由周期任务线程调用），返回计数有偏差的用户数
+    size_t Reconcile(ConnectionPool* pool);
+
+    uint64_t Rejected() const { return rejected_.load(); }
+    uint64_t Loads() const { return loads_.load(); }
+    uint64_t Corrected() const { return corrected_.load(); }
+};
+
+// 一次上传预留的配额空间，销毁时归还
+class QuotaReservation
+{
+private:
+    std::shared_ptr<QuotaManager::Reservations> reservations_;
+    int userId_;
+    uint64_t bytes_;
+
+public:
+    DISALLOW_COPY_AND_MOVE(QuotaReservation);
+    QuotaReservation(std::shared_ptr<QuotaManager::Reservations> reservations, int userId, uint64_t bytes);
+    ~QuotaReservation();
+
+    uint64_t Bytes() const { return bytes_; }
+};
+
+#endif // QUOTAMANAGER_H
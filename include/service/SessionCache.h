@@ -0,0 +1,60 @@
+#ifndef SESSIONCACHE_H
+#define SESSIONCACHE_H
+
+#include <string>
+#include <mutex>
+#include <atomic>
+#include <unordered_map>
+#include <ctime>
+
+#include "Common.h"
+
+// 进程内会话缓存：按 sessionId 哈希分片，每个分片独立加锁，命中时无需访问 MySQL
+class SessionCache
+{
+private:
+    static constexpr size_t kShardCount = 16;  // 分片数
+
+    struct Entry
+    {
+        int userId;            // 用户 ID
+        std::string username;  // 用户名
+        time_t sessionExpire;  // 会话在数据库中的过期时间
+        time_t cacheExpire;    // 缓存项本地有效期，到期后回源校验（防止其他进程删除会话后长期误判）
+    };
+
+    struct Shard
+    {
+        std::mutex mutex;
+        std::unordered_map<std::string, Entry> entries;
+    };
+
+    Shard shards_[kShardCount];
+    int ttl_;                        // 缓存项本地有效期（秒）
+    size_t maxEntriesPerShard_;      // 每个分片最多缓存的会话数
+    std::atomic<uint64_t> hits_;     // 命中次数
+    std::atomic<uint64_t> misses_;   // 未命中次数
+
+    Shard& GetShard(const std::string& sessionId);
+    // 分片已满时清理过期项，仍然超出则随机淘汰一项，调用方需持有分片锁
+    void EvictIfFull(Shard& shard, time_t now);
+
+public:
+    DISALLOW_COPY_AND_MOVE(SessionCache);
+    SessionCache(int ttl, size_t maxEntriesPerShard);
+    ~SessionCache();
+
+    // 查询会话，命中且会话与缓存项均未过期时返回 true，sessionExpire 非空时返回会话过期时间
+    bool Get(const std::string& sessionId, int& userId, std::string& username, time_t* sessionExpire = nullptr);
+    // 写入或更新会话
+    void Put(const std::string& sessionId, int userId, const std::string& username, time_t sessionExpire);
+    // 延长已缓存会话的过期时间（滑动过期）
+    void Touch(const std::string& sessionId, time_t sessionExpire);
+    // 删除会话（退出登录、会话被删除时调用）
+    void Invalidate(const std::string& sessionId);
+
+    uint64_t Hits() const { return hits_.load(); }
+    uint64_t Misses() const { return misses_.load(); }
+};
+
+#endif // SESSIONCACHE_H
@@ -0,0 +1,49 @@
+#ifndef SESSIONREFRESHER_H
+#define SESSIONREFRESHER_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <unordered_set>
+
+#include "Common.h"
+#include "MySqlConnectionPool.h"
+
+// 会话过期时间的延迟批量写回：请求路径只在内存中登记，由后台周期任务合并为一条 UPDATE 写入数据库
+class SessionRefresher
+{
+private:
+    std::mutex mutex_;                          // 保护 pending_
+    std::unordered_set<std::string> pending_;   // 待刷新的 sessionId（同一会话多次登记只保留一次）
+    size_t maxBatchSize_;                       // 单条 UPDATE 最多包含的会话数
+    int lifetime_;                              // 会话有效期（秒），刷新后 expire_time = NOW() + lifetime_
+
+    std::atomic<uint64_t> requested_;   // 登记次数
+    std::atomic<uint64_t> coalesced_;   // 被合并（已在待刷新集合中）的登记次数
+    std::atomic<uint64_t> flushed_;     // 实际写入数据库的会话数
+    std::atomic<uint64_t> batches_;     // 执行的批量 UPDATE 次数
+
+    // 将 ids[from, end) 放回待刷新集合
+    void Requeue(const std::vector<std::string>& ids, size_t from);
+
+public:
+    DISALLOW_COPY_AND_MOVE(SessionRefresher);
+    explicit SessionRefresher(int lifetime, size_t maxBatchSize = 500);
+    ~SessionRefresher();
+
+    // 登记一次滑动过期刷新
+    void MarkForRefresh(const std::string& sessionId);
+    // 会话已删除，取消其待刷新记录
+    void Cancel(const std::string& sessionId);
+    // 将待刷新的会话批量写入数据库（由周期任务线程调用，停止服务时再调用一次）
+    // 无可用连接或某批写入失败时，未写入的会话放回待刷新集合，下次再试
+    void Flush(ConnectionPool* pool);
+
+    uint64_t Requested() const { return requested_.load(); }
+    uint64_t Coalesced() const { return coalesced_.load(); }
+    uint64_t Flushed() const { return flushed_.load(); }
+    uint64_t Batches() const { return batches_.load(); }
+};
+
+#endif // SESSIONREFRESHER_H
@@ -0,0 +1,72 @@
+#ifndef SHARECODEFILTER_H
+#define SHARECODEFILTER_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <ctime>
+#include <unordered_map>
+
+#include "Common.h"
+#include "MySqlConnectionPool.h"
+
+// 分享码存在性过滤：不存在的分享码（输错、失效、暴力枚举）在查询数据库前被拒绝
+// 1. Bloom 过滤器：包含全部未过期分享码，启动时从数据库构建，创建分享时加入；判定不存在时一定不存在
+// 2. 负缓存：短期记住数据库中查不到的分享码与刚删除的分享码，Bloom 误判或尚未重建时也不再重复查询
+// Bloom 过滤器不支持删除，删除的分享码只计数，失效条目过多、容量不足或超过最长使用时间时由后台任务重建
+class ShareCodeFilter
+{
+private:
+    struct Bloom;
+
+    std::mutex mutex_;
+    std::shared_ptr<Bloom> bloom_;           // 为空表示尚未成功构建，此时全部放行
+    size_t capacity_;                        // 当前 Bloom 过滤器按该数量的分享码设计
+    size_t live_;                            // 已加入的分享码数
+    size_t stale_;                           // 加入后又被删除的分享码数
+    time_t builtAt_;                         // 上次构建时间
+    int maxAge_;                             // 最长使用时间（秒），兜底已过期分享与其他进程的修改
+    bool rebuilding_;                        // 正在重建
+    std::vector<std::string> addedDuringRebuild_;  // 重建期间新创建的分享码，重建完成后补入
+
+    std::unordered_map<std::string, time_t> negative_;  // <分享码, 过期时间>
+    int negativeTtl_;                        // 负缓存有效期（秒）
+    size_t negativeCapacity_;                // 负缓存最多条目数
+
+    std::atomic<uint64_t> filtered_;         // 被 Bloom 过滤器拒绝的查询次数
+    std::atomic<uint64_t> negativeHits_;     // 被负缓存拒绝的查询次数
+    std::atomic<uint64_t> misses_;           // 放行后数据库中不存在的次数（Bloom 误判或失效条目）
+
+    // 加入负缓存，调用方需持有锁
+    void AddNegativeLocked(const std::string& shareCode, time_t now);
+
+public:
+    DISALLOW_COPY_AND_MOVE(ShareCodeFilter);
+    ShareCodeFilter(int negativeTtl, size_t negativeCapacity, int maxAge);
+    ~ShareCodeFilter();
+
+    // 分享码是否可能存在，返回 false 时无需查询数据库
+    bool MayExist(const std::string& shareCode);
+    // 放行后数据库中查不到：加入负缓存
+    void RecordMiss(const std::string& shareCode);
+
+    // 创建分享
+    void Add(const std::string& shareCode);
+    // 删除分享：加入负缓存并计为失效条目
+    void Remove(const std::string& shareCode);
+    // 删除了 count 条分享记录但不知道具体分享码（如文件设为私有）
+    void NoteRemoved(size_t count);
+
+    // 是否需要重建
+    bool NeedsRebuild();
+    // 从数据库加载全部未过期分享码重建 Bloom 过滤器，返回加载的数量，失败时保留原过滤器
+    size_t Rebuild(ConnectionPool* pool);
+
+    uint64_t Filtered() const { return filtered_.load(); }
+    uint64_t NegativeHits() const { return negativeHits_.load(); }
+    uint64_t Misses() const { return misses_.load(); }
+};
+
+#endif // SHARECODEFILTER_H
@@ -0,0 +1,65 @@
+#ifndef STATICFILECACHE_H
+#define STATICFILECACHE_H
+
+#include <string>
+#include <memory>
+#include <atomic>
+#include <unordered_map>
+#include <ctime>
+
+#include "Common.h"
+
+// 已加载到内存中的静态资源（加载后只读，可被多个连接共享）
+struct StaticAsset
+{
+    std::shared_ptr<const std::string> content; // 文件内容
+    std::string contentType;                    // MIME 类型
+    std::string etag;                           // 强校验 ETag（基于内容哈希）
+    std::shared_ptr<const std::string> gzipContent; // 预压缩的 gzip 版本，不值得压缩时为空
+    std::string gzipEtag;                       // gzip 版本的 ETag（不同表示需使用不同的强校验值）
+    std::string lastModified;                   // HTTP-date 格式的修改时间
+    time_t mtime;                               // 文件修改时间
+};
+
+// 静态资源缓存：启动时加载页面和图标，按修改时间重新校验，避免每次请求读磁盘
+// 资源表在启动时注册完成后不再变化，命中时无锁读取；重新校验与加载不持有任何锁，完成后原子替换当前版本
+class StaticFileCache
+{
+private:
+    // 一次加载的结果，加载后只读
+    struct Version
+    {
+        std::shared_ptr<const StaticAsset> asset;  // 缓存的资源，文件不存在时为空
+        time_t mtime;                              // 加载时的文件修改时间
+        off_t size;                                // 加载时的文件大小
+    };
+
+    struct Entry
+    {
+        std::string path;                          // 磁盘路径
+        std::string contentType;                   // MIME 类型
+        std::shared_ptr<const Version> current;    // 当前版本，通过 std::atomic_load / atomic_store 访问
+        std::atomic<time_t> lastCheck;             // 上次检查 mtime 的时间，抢到更新权的线程负责本轮校验
+    };
+
+    std::string rootDir_;        // 静态资源所在目录
+    int revalidateInterval_;     // 两次检查 mtime 的最小间隔（秒）
+    std::unordered_map<std::string, std::unique_ptr<Entry>> entries_; // <资源名, 缓存项>，注册后只读
+
+    // 从磁盘加载资源，失败时返回的版本中 asset 为空
+    static std::shared_ptr<const Version> LoadVersion(const Entry& entry);
+
+public:
+    DISALLOW_COPY_AND_MOVE(StaticFileCache);
+    explicit StaticFileCache(const std::string& rootDir, int revalidateInterval = 1);
+    ~StaticFileCache();
+
+    // 注册并立即加载一个静态资源，name 为查找键，fileName 为相对 rootDir 的文件名
+    // 只能在开始处理请求之前调用
+    void Register(const std::string& name, const std::string& fileName, const std::string& contentType);
+
+    // 获取资源；距离上次检查超过 revalidateInterval 秒时会比较 mtime，变化则重新加载
+    std::shared_ptr<const StaticAsset> Get(const std::string& name);
+};
+
+#endif // STATICFILECACHE_H
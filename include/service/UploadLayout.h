@@ -0,0 +1,48 @@
+#ifndef UPLOADLAYOUT_H
+#define UPLOADLAYOUT_H
+
+#include <string>
+#include <atomic>
+#include <cstdint>
+#include <unordered_set>
+
+#include "Common.h"
+
+// 上传目录的分层布局：文件按文件名哈希放入两级子目录 <上传目录>/ab/cd/<文件名>，避免单个目录下文件过多
+// 旧版本平铺在 <上传目录>/<文件名> 的文件在线逐批迁移，迁移完成前查找时兼容两种位置
+class UploadLayout
+{
+private:
+    std::string root_;                   // 上传目录
+    std::atomic<bool> migrationDone_;    // 平铺文件已全部迁移
+    bool scanDone_;                      // 平铺文件已全部处理（可能有无法迁移的），只在磁盘线程访问
+    std::atomic<uint64_t> migrated_;     // 已迁移的文件数
+    std::unordered_set<std::string> skipped_;  // 无法迁移的文件名，之后的批次跳过，只在磁盘线程访问
+
+    // 旧版平铺路径
+    std::string LegacyPathFor(const std::string& fileName) const;
+
+public:
+    DISALLOW_COPY_AND_MOVE(UploadLayout);
+    explicit UploadLayout(const std::string& uploadDir);
+
+    // 文件名对应的两级子目录，如 "3f/a9"
+    static std::string ShardOf(const std::string& fileName);
+    // 创建 path 的父目录（两级子目录）
+    static bool EnsureParentDir(const std::string& path);
+
+    // 新文件的存放路径
+    std::string PathFor(const std::string& fileName) const;
+    // 已有文件的实际路径：优先分层路径，迁移完成前兼容尚未迁移的平铺文件
+    // 须在上传目录的磁盘队列中调用并在同一任务中使用结果，与 MigrateStep 串行，不会落在 stat 与 rename 之间
+    std::string Resolve(const std::string& fileName) const;
+
+    // 迁移一批平铺文件到分层路径（rename，不拷贝数据，硬链接关系不变），返回本批迁移的数量
+    // 与删除文件在同一磁盘队列中执行，避免删除与迁移交错
+    size_t MigrateStep(size_t maxFiles);
+
+    bool MigrationDone() const { return migrationDone_; }
+    uint64_t Migrated() const { return migrated_; }
+};
+
+#endif // UPLOADLAYOUT_H
@@ -0,0 +1,94 @@
+#ifndef UPLOADSESSION_H
+#define UPLOADSESSION_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <memory>
+#include <utility>
+#include <cstdint>
+#include <ctime>
+#include <sys/types.h>
+
+#include "Common.h"
+
+class QuotaReservation;
+
+// 分片上传会话：数据写入预分配的临时文件，各分片按偏移 pwrite，可来自多个连接并发写入
+// 已接收的字节区间按起点合并保存，连同会话信息持久化到 <id>.json，服务重启后可继续上传
+class UploadSession
+{
+private:
+    std::string id_;                          // 上传会话 ID
+    int userId_;                              // 所属用户
+    std::string originalFileName_;            // 原始文件名
+    uint64_t size_;                           // 文件总大小
+    std::string dataPath_;                    // 临时数据文件路径
+    std::string metaPath_;                    // 会话信息文件路径
+    int fd_;                                  // 数据文件描述符
+    dev_t device_;                            // 数据文件所在设备
+
+    std::mutex mutex_;                        // 保护以下成员
+    std::map<uint64_t, uint64_t> received_;   // 已接收区间 <起点, 终点（不含）>，互不重叠且不相邻
+    uint64_t receivedBytes_;                  // 已接收字节数
+    time_t lastActive_;                       // 最近一次写入时间
+    bool committing_;                         // 正在提交或已提交，不再接受写入
+    std::shared_ptr<QuotaReservation> reservation_; // 会话预留的配额空间，会话销毁（提交、取消、清理）时归还
+
+    // 登记已写入的区间并与相邻区间合并，调用方需持有锁
+    void MarkReceivedLocked(uint64_t start, uint64_t end);
+
+public:
+    DISALLOW_COPY_AND_MOVE(UploadSession);
+    UploadSession(const std::string& id, int userId, const std::string& originalFileName, uint64_t size,
+                  const std::string& dataPath, const std::string& metaPath);
+    ~UploadSession();
+
+    // 打开数据文件，create 为 true 时创建并预分配全部空间
+    bool Open(bool create);
+    // 从会话信息文件恢复会话（服务重启后），失败返回 nullptr
+    static std::shared_ptr<UploadSession> Restore(const std::string& metaPath, const std::string& dataPath);
+
+    const std::string& GetId() const { return id_; }
+    int GetUserId() const { return userId_; }
+    const std::string& GetOriginalFileName() const { return originalFileName_; }
+    uint64_t GetSize() const { return size_; }
+    const std::string& GetDataPath() const { return dataPath_; }
+    dev_t GetDevice() const { return device_; }
+
+    // 会话预留的配额空间；重启后恢复的会话没有预留，提交时补上
+    bool HasReservation();
+    void SetReservation(std::shared_ptr<QuotaReservation> reservation);
+
+    // 在 offset 处写入一段数据并登记，会话已提交或越界时返回 false
+    bool Write(uint64_t offset, const char* data, size_t len);
+    // 已接收的区间（按起点排序）
+    std::vector<std::pair<uint64_t, uint64_t>> GetReceivedRanges();
+    uint64_t GetReceivedBytes();
+    time_t GetLastActive();
+
+    // 全部数据已接收时进入提交状态（之后拒绝写入）并刷盘、关闭数据文件，返回是否成功
+    bool BeginCommit();
+    // 持久化会话信息（写临时文件后原子替换）
+    bool SaveMeta();
+    // 删除临时数据文件与会话信息文件
+    void RemoveFiles();
+};
+
+// 单个分片请求的处理状态（请求体分多次到达时保存在连接上下文中，仅在事件循环线程中访问）
+struct UploadPartContext
+{
+    std::shared_ptr<UploadSession> session;  // 所属上传会话
+    uint64_t offset;                         // 分片在文件中的起始偏移
+    uint64_t written;                        // 本分片已提交写盘的字节数
+    uint64_t inflight;                       // 已提交、尚未写完的字节数
+    bool requestDone;                        // 请求体已全部接收
+    bool failed;                             // 写入失败，剩余请求体丢弃
+
+    UploadPartContext(std::shared_ptr<UploadSession> s, uint64_t off)
+        : session(std::move(s)), offset(off), written(0), inflight(0), requestDone(false), failed(false)
+    {}
+};
+
+#endif // UPLOADSESSION_H
@@ -0,0 +1,45 @@
+#ifndef UPLOADSESSIONMANAGER_H
+#define UPLOADSESSIONMANAGER_H
+
+#include <string>
+#include <mutex>
+#include <memory>
+#include <unordered_map>
+#include <cstdint>
+
+#include "UploadSession.h"
+#include "Common.h"
+
+// 分片上传会话管理：会话的创建、查找、删除，启动时恢复未完成的会话，后台清理长时间无写入的会话
+// 临时文件位于 <上传目录>/.partial/<id>.part，会话信息位于 <id>.json
+class UploadSessionManager
+{
+private:
+    std::string dir_;                                                         // 临时文件目录
+    int idleTimeout_;                                                         // 会话无写入的最长保留时间（秒）
+    std::mutex mutex_;                                                        // 保护 sessions_
+    std::unordered_map<std::string, std::shared_ptr<UploadSession>> sessions_; // <会话 ID, 会话>
+
+public:
+    DISALLOW_COPY_AND_MOVE(UploadSessionManager);
+    UploadSessionManager(const std::string& uploadDir, int idleTimeout);
+
+    // 恢复上次运行时未完成的会话，返回恢复的数量
+    size_t Load();
+
+    // 创建会话并预分配临时文件，失败返回 nullptr；涉及预分配与刷盘，在磁盘线程中调用
+    std::shared_ptr<UploadSession> Create(const std::string& id, int userId, const std::string& originalFileName,
+                                          uint64_t size);
+    // 查找会话，不存在返回 nullptr
+    std::shared_ptr<UploadSession> Get(const std::string& id);
+    // 移除会话，removeFiles 为 true 时删除临时文件（取消上传）
+    void Remove(const std::string& id, bool removeFiles);
+
+    // 清理超过 idleTimeout 无写入的会话，返回清理的数量
+    size_t ReapIdle();
+    // 持久化所有会话的已接收区间（定期与停止服务时调用）
+    void SaveAll();
+    size_t Size();
+};
+
+#endif // UPLOADSESSIONMANAGER_H
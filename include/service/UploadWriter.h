@@ -0,0 +1,49 @@
+#ifndef UPLOADWRITER_H
+#define UPLOADWRITER_H
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+#include "Common.h"
+
+// 上传文件写入器：按预计大小预分配磁盘空间，小块数据先攒入对齐的缓冲区，满一块再整块写入
+// 超大文件可选 O_DIRECT 写入，绕过页缓存，避免挤掉热点下载文件的缓存
+class UploadWriter
+{
+private:
+    std::string path_;        // 文件路径
+    int fd_;                  // 文件描述符
+    bool direct_;             // 当前是否以 O_DIRECT 写入
+    char* buffer_;            // 对齐的写缓冲区
+    size_t bufferLen_;        // 缓冲区中待写入的字节数
+    uint64_t fileOffset_;     // 缓冲区数据在文件中的起始偏移
+    uint64_t preallocated_;   // 预分配的字节数
+    uint64_t flushes_;        // 实际写盘次数
+
+    // 将 len 字节整块写入 fileOffset_ 处
+    bool WriteBlock(const char* data, size_t len);
+    // 关闭 O_DIRECT，改用普通写入（文件系统不支持或写入尾部不对齐数据时）
+    void DisableDirect();
+
+public:
+    DISALLOW_COPY_AND_MOVE(UploadWriter);
+    explicit UploadWriter(const std::string& path);
+    ~UploadWriter();
+
+    // 创建文件，expectedSize 大于 0 时预分配空间，directIo 为 true 时尝试 O_DIRECT
+    bool Open(uint64_t expectedSize, bool directIo);
+    // 追加数据
+    bool Write(const char* data, size_t len);
+    // 写出缓冲区剩余数据，截去多预分配的部分并关闭文件
+    bool Close();
+
+    bool IsOpen() const { return fd_ >= 0; }
+    bool IsDirect() const { return direct_; }
+    uint64_t GetFlushes() const { return flushes_; }
+
+    static const size_t kBlockSize = 1024 * 1024;  // 缓冲区大小，满一块写一次
+    static const size_t kAlignment = 4096;         // O_DIRECT 要求的缓冲区、偏移与长度对齐
+};
+
+#endif // UPLOADWRITER_H
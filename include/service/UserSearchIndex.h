@@ -0,0 +1,57 @@
+#ifndef USERSEARCHINDEX_H
+#define USERSEARCHINDEX_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <unordered_map>
+
+#include "Common.h"
+#include "MySqlConnectionPool.h"
+
+// 用户名搜索索引（分享对话框的输入联想）：启动时从数据库加载全部用户，注册时追加，查询不访问数据库
+// 前缀匹配使用按用户名排序的数组二分查找，子串匹配使用三元组（trigram）倒排表求交后逐个确认
+// 用户名按字节处理、ASCII 字母不区分大小写，与 MySQL 默认排序规则下的 LIKE 结果基本一致
+class UserSearchIndex
+{
+public:
+    struct User
+    {
+        int id;                  // 用户 ID
+        std::string username;    // 用户名
+        std::string email;       // 邮箱，可为空
+    };
+
+private:
+    std::mutex mutex_;
+    std::vector<User> users_;                                   // 全部用户，下标即内部编号
+    std::vector<std::string> lowered_;                          // 与 users_ 对应的小写用户名
+    std::vector<std::pair<std::string, uint32_t>> sorted_;      // <小写用户名, 编号>，按用户名排序，用于前缀查找
+    std::unordered_map<uint32_t, std::vector<uint32_t>> trigrams_;  // <三元组, 含该三元组的编号（升序）>
+
+    std::atomic<uint64_t> searches_;   // 查询次数
+
+    // 加入一个用户，调用方需持有锁
+    void AddLocked(int id, const std::string& username, const std::string& email, bool keepSorted);
+
+public:
+    DISALLOW_COPY_AND_MOVE(UserSearchIndex);
+    UserSearchIndex();
+    ~UserSearchIndex();
+
+    // 从数据库加载全部用户（替换现有内容），返回用户数，失败返回 0 且保留现有内容
+    size_t Load(ConnectionPool* pool);
+    // 注册新用户
+    void Add(int id, const std::string& username, const std::string& email);
+
+    // 查找用户名包含 keyword 的用户，排除 excludeId，最多 limit 个
+    // 排序：前缀匹配在前（按用户名字典序，完全相同的在最前），其余按匹配位置、用户名长度排序
+    std::vector<User> Search(const std::string& keyword, int excludeId, size_t limit);
+
+    size_t Size();
+    uint64_t Searches() const { return searches_.load(); }
+};
+
+#endif // USERSEARCHINDEX_H
@@ -0,0 +1,128 @@
+#include <cstring>
+
+#include "Crc32c.h"
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#define CRC32C_X86 1
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define CRC32C_ARM 1
+#endif
+
+static const uint32_t kPolynomial = 0x82f63b78;  // Castagnoli 多项式（反射形式）
+
+// 查表实现（slicing-by-8）：每次处理 8 字节
+struct Crc32cTable
+{
+    uint32_t table[8][256];
+
+    Crc32cTable()
+    {
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            uint32_t crc = i;
+            for (int k = 0; k < 8; ++k)
+            {
+                crc = (crc >> 1) ^ ((crc & 1) ? kPolynomial : 0);
+            }
+            table[0][i] = crc;
+        }
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            for (int t = 1; t < 8; ++t)
+            {
+                table[t][i] = (table[t - 1][i] >> 8) ^ table[0][table[t - 1][i] & 0xff];
+            }
+        }
+    }
+};
+
+static uint32_t ExtendSoftware(uint32_t crc, const uint8_t* p, size_t len)
+{
+    static const Crc32cTable tables;
+    const uint32_t (*t)[256] = tables.table;
+
+    crc = ~crc;
+    while (len >= 8)
+    {
+        uint32_t lo, hi;
+        memcpy(&lo, p, 4);
+        memcpy(&hi, p + 4, 4);
+        lo ^= crc;
+        crc = t[7][lo & 0xff] ^ t[6][(lo >> 8) & 0xff] ^ t[5][(lo >> 16) & 0xff] ^ t[4][lo >> 24] ^
+              t[3][hi & 0xff] ^ t[2][(hi >> 8) & 0xff] ^ t[1][(hi >> 16) & 0xff] ^ t[0][hi >> 24];
+        p += 8;
+        len -= 8;
+    }
+    while (len-- > 0)
+    {
+        crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xff];
+    }
+    return ~crc;
+}
+
+#if defined(CRC32C_X86)
+// SSE4.2 crc32 指令：函数级启用指令集，其余代码仍可运行在不支持 SSE4.2 的 CPU 上
+__attribute__((target("sse4.2")))
+static uint32_t ExtendHardware(uint32_t crc, const uint8_t* p, size_t len)
+{
+    uint64_t crc64 = ~crc & 0xffffffffu;
+    while (len >= 8)
+    {
+        uint64_t word;
+        memcpy(&word, p, 8);
+        crc64 = _mm_crc32_u64(crc64, word);
+        p += 8;
+        len -= 8;
+    }
+    uint32_t crc32 = static_cast<uint32_t>(crc64);
+    while (len-- > 0)
+    {
+        crc32 = _mm_crc32_u8(crc32, *p++);
+    }
+    return ~crc32;
+}
+
+static bool DetectHardware()
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse4.2");
+}
+#elif defined(CRC32C_ARM)
+// ARMv8 CRC 扩展指令
+static uint32_t ExtendHardware(uint32_t crc, const uint8_t* p, size_t len)
+{
+    crc = ~crc;
+    while (len >= 8)
+    {
+        uint64_t word;
+        memcpy(&word, p, 8);
+        crc = __crc32cd(crc, word);
+        p += 8;
+        len -= 8;
+    }
+    while (len-- > 0)
+    {
+        crc = __crc32cb(crc, *p++);
+    }
+    return ~crc;
+}
+
+static bool DetectHardware() { return true; }
+#else
+static uint32_t ExtendHardware(uint32_t crc, const uint8_t* p, size_t len) { return ExtendSoftware(crc, p, len); }
+static bool DetectHardware() { return false; }
+#endif
+
+bool Crc32c::IsHardwareAccelerated()
+{
+    static const bool hardware = DetectHardware();
+    return hardware;
+}
+
+uint32_t Crc32c::Extend(uint32_t crc, const void* data, size_t len)
+{
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    return IsHardwareAccelerated() ? ExtendHardware(crc, p, len) : ExtendSoftware(crc, p, len);
+}
@@ -3,6 +3,7 @@
 #include <signal.h>
 
 #include "HttpServer.h"
+#include "HttpCompressor.h"
 #include "AsyncLog.h"
 #include "Log.h"
 
@@ -63,6 +64,13 @@ int main(int argc, char *argv[])
 
     asynclog->Start();
 
+    // 响应压缩参数：压缩级别、最小压缩大小、每个事件循环线程每秒的压缩字节预算
+    CompressionOptions compression;
+    compression.level = 6;
+    compression.minSize = 1024;
+    compression.cpuBudgetBytesPerSecond = 32 * 1024 * 1024;
+    HttpCompressor::SetOptions(compression);
+
     // 创建 HttpServer 并绑定日志系统
     httpServer = new HttpServer(argv[1], 
                                 atoi(argv[2]), 
@@ -71,6 +79,10 @@ int main(int argc, char *argv[])
                                 "./uploads", // 上传文件二进制存储位置
                                 "uploads/filename_mapping.json" ); // 映射文件位置
 
+    // 后台 blob 完整性巡检速率（字节/秒，0 为关闭），下载时是否按块校验
+    httpServer->SetScrubRate(8 * 1024 * 1024);
+    httpServer->SetVerifyDownloads(false);
+
     // 事件循环
     httpServer->Start();
 
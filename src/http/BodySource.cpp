@@ -0,0 +1,61 @@
+#include <cstdio>
+#include <algorithm>
+
+#include "BodySource.h"
+
+static constexpr size_t kMemoryChunkSize = 256 * 1024;  // 内存数据每次拉取的大小
+
+// 将数据源包装为连接的数据生产者
+StreamProducer BodySource::MakeProducer(const std::shared_ptr<BodySource>& source)
+{
+    if (source->Length() >= 0)
+    {
+        // 长度已知：直接写入发送缓冲区
+        return [source](Buffer* output) { return source->Read(output); };
+    }
+
+    // 长度未知：每段数据加上 chunk 头尾，结束时写入终止块
+    std::shared_ptr<Buffer> scratch = std::make_shared<Buffer>();
+    return [source, scratch](Buffer* output)
+    {
+        StreamState state = source->Read(scratch.get());
+        if (scratch->ReadableBytes() > 0)
+        {
+            char header[32];
+            int len = snprintf(header, sizeof(header), "%zx\r\n", scratch->ReadableBytes());
+            output->Append(header, static_cast<size_t>(len));
+            output->Append(scratch->Peek(), scratch->ReadableBytes());
+            output->Append("\r\n", 2);
+            scratch->RetrieveAll();
+        }
+        if (state == StreamState::kDone) output->Append("0\r\n\r\n", 5);
+        return state;
+    };
+}
+
+MemoryBodySource::MemoryBodySource(std::shared_ptr<const std::string> data)
+                : data_(std::move(data)),
+                  offset_(0)
+{}
+
+int64_t MemoryBodySource::Length() const { return static_cast<int64_t>(data_->size()); }
+
+StreamState MemoryBodySource::Read(Buffer* output)
+{
+    size_t n = std::min(kMemoryChunkSize, data_->size() - offset_);
+    output->Append(data_->data() + offset_, n);
+    offset_ += n;
+    return offset_ >= data_->size() ? StreamState::kDone : StreamState::kMore;
+}
+
+GeneratorBodySource::GeneratorBodySource(Generator generator, int64_t length)
+                   : generator_(std::move(generator)),
+                     length_(length)
+{}
+
+int64_t GeneratorBodySource::Length() const { return length_; }
+
+StreamState GeneratorBodySource::Read(Buffer* output)
+{
+    return generator_(output) ? StreamState::kMore : StreamState::kDone;
+}
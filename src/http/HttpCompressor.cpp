@@ -0,0 +1,176 @@
+#include <ctime>
+#include <cstdlib>
+#include <algorithm>
+
+#include "HttpCompressor.h"
+
+static constexpr size_t kCompressStep = 16 * 1024;  // 每次为压缩输出预留的空间
+
+// 默认参数：级别 6，1KB 以下不压缩，每线程每秒最多压缩 32MB
+CompressionOptions HttpCompressor::options_ = {6, 1024, 32 * 1024 * 1024};
+std::atomic<uint64_t> HttpCompressor::totalIn_(0);
+std::atomic<uint64_t> HttpCompressor::totalOut_(0);
+
+StreamCompressor::StreamCompressor(ContentEncoding encoding, int level)
+                : initialized_(false),
+                  totalIn_(0),
+                  totalOut_(0)
+{
+    memset(&stream_, 0, sizeof(stream_));
+    // windowBits: 15 为 zlib 格式（HTTP deflate），+16 为 gzip 格式
+    int windowBits = (encoding == ContentEncoding::kGzip) ? 15 + 16 : 15;
+    initialized_ = deflateInit2(&stream_, level, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+}
+
+StreamCompressor::~StreamCompressor()
+{
+    if (initialized_) deflateEnd(&stream_);
+}
+
+// 压缩数据并直接写入 Buffer 的可写区域
+void StreamCompressor::Deflate(const char* data, size_t len, int flush, Buffer* output)
+{
+    stream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    stream_.avail_in = static_cast<uInt>(len);
+
+    do
+    {
+        output->EnsureWritableBytes(kCompressStep);
+        stream_.next_out = reinterpret_cast<Bytef*>(output->BeginWrite());
+        stream_.avail_out = static_cast<uInt>(kCompressStep);
+
+        deflate(&stream_, flush);
+
+        size_t produced = kCompressStep - stream_.avail_out;
+        output->HasWritten(produced);
+        totalOut_ += produced;
+    } while (stream_.avail_out == 0);
+
+    totalIn_ += len;
+}
+
+void StreamCompressor::Write(const char* data, size_t len, Buffer* output)
+{
+    if (len > 0) Deflate(data, len, Z_NO_FLUSH, output);
+}
+
+void StreamCompressor::Flush(Buffer* output)
+{
+    Deflate(nullptr, 0, Z_SYNC_FLUSH, output);
+}
+
+void StreamCompressor::Finish(Buffer* output)
+{
+    Deflate(nullptr, 0, Z_FINISH, output);
+    HttpCompressor::Record(totalIn_, totalOut_);
+}
+
+void HttpCompressor::SetOptions(const CompressionOptions& options) { options_ = options; }
+
+const CompressionOptions& HttpCompressor::GetOptions() { return options_; }
+
+// 解析 Accept-Encoding，例如：gzip, deflate;q=0.5, br
+ContentEncoding HttpCompressor::Negotiate(const std::string& acceptEncoding)
+{
+    double gzipQ = 0, deflateQ = 0, anyQ = 0;
+    bool gzipSeen = false, deflateSeen = false;
+
+    size_t start = 0;
+    while (start < acceptEncoding.size())
+    {
+        size_t comma = acceptEncoding.find(',', start);
+        std::string item = acceptEncoding.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+
+        // 拆分编码名与 q 值
+        double q = 1.0;
+        size_t semi = item.find(';');
+        std::string name = item.substr(0, semi);
+        if (semi != std::string::npos)
+        {
+            size_t qPos = item.find("q=", semi);
+            if (qPos != std::string::npos) q = atof(item.c_str() + qPos + 2);
+        }
+        name.erase(std::remove_if(name.begin(), name.end(), ::isspace), name.end());
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+
+        if (name == "gzip" || name == "x-gzip") { gzipQ = q; gzipSeen = true; }
+        else if (name == "deflate") { deflateQ = q; deflateSeen = true; }
+        else if (name == "*") { anyQ = q; }
+
+        if (comma == std::string::npos) break;
+        start = comma + 1;
+    }
+
+    if (!gzipSeen) gzipQ = anyQ;
+    if (!deflateSeen) deflateQ = anyQ;
+
+    if (gzipQ > 0 && gzipQ >= deflateQ) return ContentEncoding::kGzip;
+    if (deflateQ > 0) return ContentEncoding::kDeflate;
+    return ContentEncoding::kIdentity;
+}
+
+const char* HttpCompressor::EncodingName(ContentEncoding encoding)
+{
+    switch (encoding)
+    {
+        case ContentEncoding::kGzip: return "gzip";
+        case ContentEncoding::kDeflate: return "deflate";
+        default: return "identity";
+    }
+}
+
+// 只压缩文本类内容；图片、视频、压缩包及 application/octet-stream 文件下载不压缩
+bool HttpCompressor::IsCompressibleType(const std::string& contentType)
+{
+    return contentType.compare(0, 5, "text/") == 0 ||
+           contentType.find("json") != std::string::npos ||
+           contentType.find("javascript") != std::string::npos ||
+           contentType.find("xml") != std::string::npos ||
+           contentType.find("image/svg") != std::string::npos ||
+           contentType.find("image/x-icon") != std::string::npos;
+}
+
+// 每个事件循环线程独立计算的每秒压缩预算
+bool HttpCompressor::AcquireBudget(size_t bytes)
+{
+    static __thread time_t t_budgetSecond = 0;
+    static __thread size_t t_budgetUsed = 0;
+
+    time_t now = time(nullptr);
+    if (now != t_budgetSecond)
+    {
+        t_budgetSecond = now;
+        t_budgetUsed = 0;
+    }
+
+    if (t_budgetUsed + bytes > options_.cpuBudgetBytesPerSecond) return false;
+    t_budgetUsed += bytes;
+    return true;
+}
+
+// 一次性压缩整段数据
+bool HttpCompressor::Compress(const char* data, size_t len, ContentEncoding encoding, int level, std::string* output)
+{
+    if (encoding == ContentEncoding::kIdentity) return false;
+
+    StreamCompressor compressor(encoding, level);
+    if (!compressor.IsValid()) return false;
+
+    Buffer buffer(compressBound(static_cast<uLong>(len)) + 32);
+    compressor.Write(data, len, &buffer);
+    compressor.Finish(&buffer);
+    *output = buffer.RetrieveAllAsString();
+    return true;
+}
+
+void HttpCompressor::Record(size_t in, size_t out)
+{
+    totalIn_ += in;
+    totalOut_ += out;
+}
+
+double HttpCompressor::CompressionRatio()
+{
+    uint64_t in = totalIn_.load();
+    return in == 0 ? 1.0 : static_cast<double>(totalOut_.load()) / static_cast<double>(in);
+}
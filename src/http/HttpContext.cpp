@@ -4,6 +4,7 @@
 
 #include <memory>
 #include <iostream>
+#include <cstdlib>
 
 #define DEBUG_HTTP_PARSE 0  // 设置为 1 可开启 Debug 日志输出
 
@@ -26,7 +27,13 @@ static void ParseUrlEncodedForm(const std::string& body, HttpRequest* request)
 }
 
 // 构造函数，初始化状态为 START，分配一个新的 HttpRequest 对象
-HttpContext::HttpContext() : state_(HttpRequestParseState::START)
+HttpContext::HttpContext() 
+            : state_(HttpRequestParseState::START),
+              contentLength_(0),
+              bodyReceived_(0),
+              isChunked_(false),
+              headersChecked_(false),
+              rejected_(false)
 {
     request_ = std::unique_ptr<HttpRequest>(new HttpRequest()); 
 }
@@ -304,13 +311,14 @@ HttpRequestParseState HttpContext::ParseRequest(const char* begin, int size)
                 // CR_LF_CR 后如果是 LF 则判断是否需要解析 Body
                 if (ch == LF) 
                 {
-                    int content_length = 0;
+                    contentLength_ = 0;
+                    bodyReceived_ = 0;
                     if (request_->GetHeaders().count("Content-Length")) 
                     {
-                        content_length = atoi(request_->GetHeader("Content-Length").c_str());
+                        contentLength_ = strtoull(request_->GetHeader("Content-Length").c_str(), nullptr, 10);
                     }
 
-                    if (content_length > 0) 
+                    if (contentLength_ > 0) 
                     {
                         state_ = HttpRequestParseState::BODY;
                     } 
@@ -329,17 +337,15 @@ HttpRequestParseState HttpContext::ParseRequest(const char* begin, int size)
 
             case HttpRequestParseState::BODY: 
             {
-                // 解析请求体
-                int content_length = 0;
-                if (request_->GetHeaders().count("Content-Length")) 
-                {
-                    content_length = atoi(request_->GetHeader("Content-Length").c_str());
-                }
+                // 解析请求体：请求体可能跨多次读取到达，按已接收字节数判断是否完整
+                // 本次数据追加到请求体，流式处理的请求（如上传）在处理后自行清空，避免整个请求体驻留内存
+                size_t available = static_cast<size_t>(size - (start - begin));
+                size_t remaining = contentLength_ - bodyReceived_;
 
-                // 判断 Body 是否完整
-                if (size - (start - begin) >= content_length) 
+                if (available >= remaining) 
                 {
-                    request_->SetBody(std::string(start, start + content_length));
+                    request_->AppendBody(start, remaining);
+                    bodyReceived_ += remaining;
                     state_ = HttpRequestParseState::COMPLETE;
                     if (request_->GetMethodString() == "POST") 
                     {
@@ -350,16 +356,15 @@ HttpRequestParseState HttpContext::ParseRequest(const char* begin, int size)
                             ParseUrlEncodedForm(request_->GetBody(), request_.get());
                         }
                     }
-
+                    return state_;
                 } 
                 else 
                 {
-                    request_->SetBody(std::string(start, size - (start - begin)));
+                    request_->AppendBody(start, available);
+                    bodyReceived_ += available;
                     return HttpRequestParseState::kHeadersComplete;
                     // Body 未完整，等待更多数据
                 }
-                
-                break;
             }
 
             default:
@@ -381,4 +386,9 @@ void HttpContext::ResetContextStatus()
 {
     state_ = HttpRequestParseState::START;
     request_ = std::unique_ptr<HttpRequest>(new HttpRequest()); ;  // 重新分配一个 HttpRequest
+    contentLength_ = 0;
+    bodyReceived_ = 0;
+    headersChecked_ = false;
+    rejected_ = false;
+    requestHold_.reset();
 }
@@ -0,0 +1,130 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cctype>
+#include <ctime>
+
+#include "HttpRange.h"
+
+namespace HttpRange
+{
+    // 单个请求允许的最大范围数，超出时忽略 Range 头，防止大量碎片范围放大开销
+    static const size_t kMaxRanges = 64;
+
+    // 去除首尾空白
+    static std::string Trim(const std::string& str)
+    {
+        size_t begin = str.find_first_not_of(" \t");
+        if (begin == std::string::npos) return "";
+        size_t end = str.find_last_not_of(" \t");
+        return str.substr(begin, end - begin + 1);
+    }
+
+    // 解析非负十进制整数，不允许为空或包含其他字符
+    static bool ParseNumber(const std::string& str, uint64_t* value)
+    {
+        if (str.empty() || str.size() > 19) return false;
+        uint64_t result = 0;
+        for (char c : str)
+        {
+            if (!isdigit(static_cast<unsigned char>(c))) return false;
+            result = result * 10 + static_cast<uint64_t>(c - '0');
+        }
+        *value = result;
+        return true;
+    }
+
+    RangeParseResult Parse(const std::string& header, uint64_t size, std::vector<ByteRange>* ranges)
+    {
+        ranges->clear();
+
+        std::string value = Trim(header);
+        if (value.compare(0, 6, "bytes=") != 0) return RangeParseResult::kNone;
+
+        std::vector<ByteRange> satisfiable;
+        size_t specCount = 0;
+        size_t start = 6;
+        while (start <= value.size())
+        {
+            size_t comma = value.find(',', start);
+            std::string spec = Trim(value.substr(start, comma == std::string::npos ? std::string::npos : comma - start));
+            start = (comma == std::string::npos) ? value.size() + 1 : comma + 1;
+
+            if (spec.empty()) continue;  // 允许 "bytes=0-1, , 5-6" 形式的空项
+            if (++specCount > kMaxRanges) return RangeParseResult::kNone;
+
+            size_t dash = spec.find('-');
+            if (dash == std::string::npos) return RangeParseResult::kNone;
+
+            std::string first = spec.substr(0, dash);
+            std::string last = spec.substr(dash + 1);
+            uint64_t a = 0, b = 0;
+
+            if (first.empty())
+            {
+                // 后缀范围：-500 表示最后 500 字节
+                if (!ParseNumber(last, &b)) return RangeParseResult::kNone;
+                if (b == 0 || size == 0) continue;
+                satisfiable.push_back({size - std::min(b, size), size - 1});
+            }
+            else
+            {
+                if (!ParseNumber(first, &a)) return RangeParseResult::kNone;
+                if (last.empty())
+                {
+                    b = UINT64_MAX;
+                }
+                else if (!ParseNumber(last, &b) || b < a)
+                {
+                    return RangeParseResult::kNone;  // 语法无效的范围使整个 Range 头被忽略
+                }
+
+                if (a >= size) continue;  // 超出文件大小的范围不可满足
+                satisfiable.push_back({a, std::min(b, size - 1)});
+            }
+        }
+
+        if (specCount == 0) return RangeParseResult::kNone;
+        if (satisfiable.empty()) return RangeParseResult::kUnsatisfiable;
+
+        // 按起始位置排序并合并重叠或相邻的范围
+        std::sort(satisfiable.begin(), satisfiable.end(),
+                  [](const ByteRange& l, const ByteRange& r) { return l.start < r.start; });
+        for (const ByteRange& range : satisfiable)
+        {
+            if (!ranges->empty() && range.start <= ranges->back().end + 1)
+            {
+                ranges->back().end = std::max(ranges->back().end, range.end);
+            }
+            else
+            {
+                ranges->push_back(range);
+            }
+        }
+        return RangeParseResult::kSatisfiable;
+    }
+
+    std::string ContentRange(const ByteRange& range, uint64_t size)
+    {
+        char buf[96];
+        snprintf(buf, sizeof(buf), "bytes %llu-%llu/%llu",
+                 static_cast<unsigned long long>(range.start),
+                 static_cast<unsigned long long>(range.end),
+                 static_cast<unsigned long long>(size));
+        return buf;
+    }
+
+    std::string UnsatisfiedContentRange(uint64_t size)
+    {
+        return "bytes */" + std::to_string(size);
+    }
+
+    std::string MakeBoundary()
+    {
+        static std::atomic<uint32_t> counter(0);
+        char buf[48];
+        snprintf(buf, sizeof(buf), "ReactorFileBoundary%08lx%08x",
+                 static_cast<unsigned long>(time(nullptr)), counter.fetch_add(1));
+        return buf;
+    }
+}
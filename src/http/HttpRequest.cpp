@@ -129,6 +129,17 @@ const std::map<std::string, std::string> & HttpRequest::GetHeaders() const
 // 设置请求体内容
 void HttpRequest::SetBody(const std::string &str) {body_ = str;}
 
+// 追加请求体
+void HttpRequest::AppendBody(const char* data, size_t len) {body_.append(data, len);}
+
+// 取出请求体并清空
+std::string HttpRequest::TakeBody()
+{
+    std::string body;
+    body.swap(body_);
+    return body;
+}
+
 // 获取请求体的常量引用
 const std::string & HttpRequest::GetBody() const {return body_;}
 
@@ -1,12 +1,14 @@
 #include "HttpResponse.h"
 #include <ctime>
+#include <cstdio>
 #include <sstream>
 
 HttpResponse::HttpResponse(bool closeConnection)
             : statusCode_(HttpStatusCode::kUnknown),
               statusMessage_(""),
               version_("HTTP/1.1"),
-              closeConnection_(closeConnection)
+              closeConnection_(closeConnection),
+              acceptEncoding_(ContentEncoding::kIdentity)
 {}
 
 HttpResponse::~HttpResponse() {}
@@ -57,65 +59,170 @@ void HttpResponse::AddSetCookie(const std::string& cookie)
     headers_.insert({"Set-Cookie", cookie});
 }
 
-// 添加 Date 响应头（格式为 GMT 时间）
-void HttpResponse::AddDateHeader() 
-{
-    char buf[100];
-    std::time_t now = std::time(nullptr);
-    std::tm gmt;
-    gmtime_r(&now, &gmt);
-    std::strftime(buf, sizeof(buf), "%a, %d %b %Y %H:%M:%S GMT", &gmt);
-    AddHeader("Date", buf);
-}
-
 // 返回是否关闭连接
 bool HttpResponse::IsCloseConnection() const 
 {
     return closeConnection_;
 }
 
-// 构造完整响应字符串（包含响应行、头部和正文）
-std::string HttpResponse::ResponseMessage() 
+// 写入 Date 响应头（GMT 时间）
+// 每个事件循环运行在独立线程中，线程局部缓存即“每个事件循环每秒格式化一次”
+void HttpResponse::AppendDateHeader(Buffer* output)
 {
-    std::string message;
+    static __thread time_t t_lastSecond = 0;
+    static __thread char t_dateHeader[64];
+    static __thread size_t t_dateHeaderLength = 0;
 
-    AddDateHeader(); // 加入标准时间字段
+    std::time_t now = std::time(nullptr);
+    if (now != t_lastSecond)
+    {
+        std::tm gmt;
+        gmtime_r(&now, &gmt);
+        t_dateHeaderLength = std::strftime(t_dateHeader, sizeof(t_dateHeader),
+                                           "Date: %a, %d %b %Y %H:%M:%S GMT\r\n", &gmt);
+        t_lastSecond = now;
+    }
+    output->Append(t_dateHeader, t_dateHeaderLength);
+}
 
+// 将完整响应（响应行、头部和正文）直接序列化到发送缓冲区，避免中间字符串拼接与拷贝
+void HttpResponse::AppendToBuffer(Buffer* output) const
+{
     // 1、响应行
-    message += GetStatusLine();
+    AppendStatusLine(output);
 
-    // 2、Content-Length 必须有
-    message += "Content-Length: " + std::to_string(body_.size()) + "\r\n";
+    // 2、标准时间字段
+    AppendDateHeader(output);
 
-    // 3、Connection 控制头
-    if (closeConnection_) 
-    {
-        message += "Connection: close\r\n";
-    } 
-    else 
+    // 3、其余头部 + 正文
+    AppendHeadersAndBody(output);
+}
+
+// 构造完整响应字符串（调试用）
+std::string HttpResponse::ResponseMessage() const
+{
+    Buffer output;
+    AppendToBuffer(&output);
+    return output.RetrieveAllAsString();
+}
+
+// 预渲染除 Date 外的完整报文，用于固定内容的错误响应
+PrerenderedResponse HttpResponse::Prerender() const
+{
+    PrerenderedResponse prerendered;
+    Buffer output;
+
+    AppendStatusLine(&output);
+    prerendered.statusLine = output.RetrieveAllAsString();
+
+    AppendHeadersAndBody(&output);
+    prerendered.rest = output.RetrieveAllAsString();
+
+    return prerendered;
+}
+
+// 将预渲染报文写入发送缓冲区，Date 头使用缓存值
+void HttpResponse::AppendPrerendered(const PrerenderedResponse& prerendered, Buffer* output)
+{
+    output->Append(prerendered.statusLine);
+    AppendDateHeader(output);
+    output->Append(prerendered.rest);
+}
+
+// 构造响应状态行，例如：HTTP/1.1 200 OK
+void HttpResponse::AppendStatusLine(Buffer* output) const 
+{
+    char buf[16];
+    int len = snprintf(buf, sizeof(buf), " %d ", static_cast<int>(statusCode_));
+
+    output->Append(version_);
+    output->Append(buf, static_cast<size_t>(len));
+    output->Append(statusMessage_);
+    output->Append("\r\n", 2);
+}
+
+// 动态压缩正文：仅对可压缩类型、足够大且未显式设置编码的正文，在本线程压缩预算内进行
+bool HttpResponse::CompressBody(std::string* compressed) const
+{
+    const CompressionOptions& options = HttpCompressor::GetOptions();
+    if (bodySource_) return false;
+    if (acceptEncoding_ == ContentEncoding::kIdentity || body_.size() < options.minSize) return false;
+    if (headers_.find("Content-Encoding") != headers_.end()) return false;
+
+    auto type = headers_.find("Content-Type");
+    if (type == headers_.end() || !HttpCompressor::IsCompressibleType(type->second)) return false;
+
+    // 超出 CPU 预算时直接发送原文
+    if (!HttpCompressor::AcquireBudget(body_.size())) return false;
+
+    if (!HttpCompressor::Compress(body_.data(), body_.size(), acceptEncoding_, options.level, compressed)) return false;
+
+    // 压缩后没有变小则不使用
+    return compressed->size() < body_.size();
+}
+
+// 写入头部、空行和正文
+void HttpResponse::AppendHeadersAndBody(Buffer* output) const
+{
+    std::string compressed;
+    bool isCompressed = CompressBody(&compressed);
+    const std::string& body = isCompressed ? compressed : body_;
+
+    // 1、Content-Length 必须有（处理器显式设置或使用分块传输时除外）
+    //    流式响应体长度未知时使用 chunked 传输编码
+    //    304 / 204 没有正文，不自动添加：304 的 Content-Length 表示的是完整表示的长度（RFC 9110 §8.6），204 不得携带
+    bool noBody = statusCode_ == HttpStatusCode::k304NotModified || statusCode_ == HttpStatusCode::k204NoContent;
+    if (!noBody &&
+        headers_.find("Content-Length") == headers_.end() &&
+        headers_.find("Transfer-Encoding") == headers_.end())
     {
-        message += "Connection: Keep-Alive\r\n";
+        if (bodySource_ && bodySource_->Length() < 0)
+        {
+            output->Append("Transfer-Encoding: chunked\r\n");
+        }
+        else
+        {
+            uint64_t length = bodySource_ ? static_cast<uint64_t>(bodySource_->Length()) : body.size();
+            char buf[64];
+            int len = snprintf(buf, sizeof(buf), "Content-Length: %llu\r\n", static_cast<unsigned long long>(length));
+            output->Append(buf, static_cast<size_t>(len));
+        }
     }
 
-    // 4、附加头部字段
-    for (const auto& header : headers_) 
+    // 压缩编码及缓存区分头
+    if (isCompressed)
     {
-        message += header.first + ": " + header.second + "\r\n";
+        output->Append("Content-Encoding: ");
+        output->Append(HttpCompressor::EncodingName(acceptEncoding_));
+        output->Append("\r\n", 2);
+        if (headers_.find("Vary") == headers_.end()) output->Append("Vary: Accept-Encoding\r\n");
     }
 
-    // 5、空行 + 正文
-    message += "\r\n";
-    message += body_;
+    // 2、Connection 控制头（处理器显式设置时以其为准）
+    if (headers_.find("Connection") == headers_.end())
+    {
+        if (closeConnection_) 
+        {
+            output->Append("Connection: close\r\n", 19);
+        } 
+        else 
+        {
+            output->Append("Connection: Keep-Alive\r\n", 24);
+        }
+    }
 
-    return message;
-}
+    // 3、附加头部字段
+    for (const auto& header : headers_) 
+    {
+        output->Append(header.first);
+        output->Append(": ", 2);
+        output->Append(header.second);
+        output->Append("\r\n", 2);
+    }
 
-// 构造响应状态行，例如：HTTP/1.1 200 OK
-std::string HttpResponse::GetStatusLine() const 
-{
-    return version_ + " " +
-           std::to_string(static_cast<int>(statusCode_)) + " " +
-           statusMessage_ + "\r\n";
+    // 4、空行 + 正文（流式响应体由连接随后拉取）
+    output->Append("\r\n", 2);
+    if (!bodySource_ && !noBody) output->Append(body);
 }
 
 // 根据状态码返回默认状态消息
@@ -127,12 +234,18 @@ std::string HttpResponse::GetDefaultStatusMessage(HttpStatusCode code)
         case HttpStatusCode::k200OK: return "OK";
         case HttpStatusCode::k201Created: return "Created";
         case HttpStatusCode::k204NoContent: return "No Content";
+        case HttpStatusCode::k206PartialContent: return "Partial Content";
         case HttpStatusCode::k302Found: return "Found";
+        case HttpStatusCode::k304NotModified: return "Not Modified";
         case HttpStatusCode::k400BadRequest: return "Bad Request";
         case HttpStatusCode::k401Unauthorized: return "Unauthorized";
         case HttpStatusCode::k403Forbidden: return "Forbidden";
         case HttpStatusCode::k404NotFound: return "Not Found";
         case HttpStatusCode::k405MethodNotAllowed: return "Method Not Allowed";
+        case HttpStatusCode::k409Conflict: return "Conflict";
+        case HttpStatusCode::k413PayloadTooLarge: return "Payload Too Large";
+        case HttpStatusCode::k416RangeNotSatisfiable: return "Range Not Satisfiable";
+        case HttpStatusCode::k503ServiceUnavailable: return "Service Unavailable";
         case HttpStatusCode::k500InternalServerError: return "Internal Server Error";
         default: return "Unknown";
     }
@@ -142,6 +255,6 @@ std::string HttpResponse::GetDefaultStatusMessage(HttpStatusCode code)
 void HttpResponse::DebugPrint() const 
 {
     std::cout << "----- HTTP Response Begin -----\n";
-    std::cout << const_cast<HttpResponse*>(this)->ResponseMessage();
+    std::cout << ResponseMessage();
     std::cout << "\n----- HTTP Response End -----\n";
 }
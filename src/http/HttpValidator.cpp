@@ -0,0 +1,104 @@
+#include "HttpValidator.h"
+
+#include <cstring>
+
+namespace HttpValidator
+{
+    // 格式化为 HTTP-date（GMT）
+    std::string FormatHttpDate(time_t t)
+    {
+        char buf[64];
+        std::tm gmt;
+        gmtime_r(&t, &gmt);
+        size_t len = std::strftime(buf, sizeof(buf), "%a, %d %b %Y %H:%M:%S GMT", &gmt);
+        return std::string(buf, len);
+    }
+
+    // 解析 HTTP-date（仅支持 RFC 7231 推荐的 IMF-fixdate 格式）
+    bool ParseHttpDate(const std::string& str, time_t* t)
+    {
+        std::tm gmt;
+        memset(&gmt, 0, sizeof(gmt));
+        const char* end = strptime(str.c_str(), "%a, %d %b %Y %H:%M:%S GMT", &gmt);
+        if (end == nullptr) return false;
+
+        *t = timegm(&gmt);
+        return *t != static_cast<time_t>(-1);
+    }
+
+    // 去掉首尾空白
+    static std::string Trim(const std::string& str)
+    {
+        size_t begin = str.find_first_not_of(" \t");
+        if (begin == std::string::npos) return "";
+        size_t end = str.find_last_not_of(" \t");
+        return str.substr(begin, end - begin + 1);
+    }
+
+    // 判断 ETag 列表是否匹配
+    bool ETagListMatches(const std::string& headerValue, const std::string& etag, bool weak)
+    {
+        if (etag.empty()) return false;
+
+        std::string value = Trim(headerValue);
+        if (value == "*") return true;
+
+        bool etagIsWeak = etag.compare(0, 2, "W/") == 0;
+        if (!weak && etagIsWeak) return false;
+        std::string opaqueTag = etagIsWeak ? etag.substr(2) : etag;
+
+        size_t start = 0;
+        while (start < value.size())
+        {
+            size_t comma = value.find(',', start);
+            std::string candidate = Trim(value.substr(start, comma == std::string::npos ? std::string::npos : comma - start));
+
+            bool candidateIsWeak = candidate.compare(0, 2, "W/") == 0;
+            if (candidateIsWeak) candidate = candidate.substr(2);
+
+            if ((weak || !candidateIsWeak) && candidate == opaqueTag) return true;
+
+            if (comma == std::string::npos) break;
+            start = comma + 1;
+        }
+        return false;
+    }
+
+    // 条件请求判断：If-None-Match 存在时忽略 If-Modified-Since（RFC 7232 6）
+    bool IsNotModified(const HttpRequest& request, const std::string& etag, time_t lastModified)
+    {
+        std::string ifNoneMatch = request.GetHeader("If-None-Match");
+        if (!ifNoneMatch.empty())
+        {
+            return ETagListMatches(ifNoneMatch, etag, true);
+        }
+
+        std::string ifModifiedSince = request.GetHeader("If-Modified-Since");
+        if (!ifModifiedSince.empty())
+        {
+            time_t since = 0;
+            if (ParseHttpDate(ifModifiedSince, &since))
+            {
+                return lastModified <= since;
+            }
+        }
+        return false;
+    }
+
+    // If-Range 校验：资源未变化时才继续断点续传，否则返回完整内容（RFC 7233 3.2）
+    bool IfRangeMatches(const HttpRequest& request, const std::string& etag, time_t lastModified)
+    {
+        std::string ifRange = Trim(request.GetHeader("If-Range"));
+        if (ifRange.empty()) return true;
+
+        // 实体标签：弱校验器永远不匹配
+        if (ifRange[0] == '"' || ifRange.compare(0, 2, "W/") == 0)
+        {
+            if (ifRange.compare(0, 2, "W/") == 0 || etag.compare(0, 2, "W/") == 0) return false;
+            return ifRange == etag;
+        }
+
+        time_t date = 0;
+        return ParseHttpDate(ifRange, &date) && date == lastModified;
+    }
+}
@@ -0,0 +1,146 @@
+#include <cstdio>
+#include <cstring>
+#include <cinttypes>
+
+#include "JsonWriter.h"
+
+JsonWriter::JsonWriter(Buffer* output)
+          : output_(output),
+            afterKey_(false)
+{}
+
+// 写值之前按需补逗号，并标记所在容器已有元素
+void JsonWriter::BeforeValue()
+{
+    if (afterKey_)
+    {
+        afterKey_ = false;
+        return;
+    }
+    if (!hasElement_.empty())
+    {
+        if (hasElement_.back()) output_->Append(",", 1);
+        hasElement_.back() = true;
+    }
+}
+
+// 按 JSON 规则转义字符串，非 ASCII 字节（UTF-8）原样输出
+void JsonWriter::AppendEscaped(const char* data, size_t len)
+{
+    static const char kHex[] = "0123456789abcdef";
+    size_t start = 0;
+    for (size_t i = 0; i < len; ++i)
+    {
+        unsigned char c = static_cast<unsigned char>(data[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+
+        // 先输出之前无需转义的一段
+        if (i > start) output_->Append(data + start, i - start);
+        start = i + 1;
+
+        switch (c)
+        {
+        case '"':  output_->Append("\\\"", 2); break;
+        case '\\': output_->Append("\\\\", 2); break;
+        case '\b': output_->Append("\\b", 2); break;
+        case '\f': output_->Append("\\f", 2); break;
+        case '\n': output_->Append("\\n", 2); break;
+        case '\r': output_->Append("\\r", 2); break;
+        case '\t': output_->Append("\\t", 2); break;
+        default:
+        {
+            char escaped[6] = {'\\', 'u', '0', '0', kHex[c >> 4], kHex[c & 0x0F]};
+            output_->Append(escaped, sizeof(escaped));
+        }
+        }
+    }
+    if (len > start) output_->Append(data + start, len - start);
+}
+
+JsonWriter& JsonWriter::BeginObject()
+{
+    BeforeValue();
+    output_->Append("{", 1);
+    hasElement_.push_back(false);
+    return *this;
+}
+
+JsonWriter& JsonWriter::EndObject()
+{
+    output_->Append("}", 1);
+    hasElement_.pop_back();
+    return *this;
+}
+
+JsonWriter& JsonWriter::BeginArray()
+{
+    BeforeValue();
+    output_->Append("[", 1);
+    hasElement_.push_back(false);
+    return *this;
+}
+
+JsonWriter& JsonWriter::EndArray()
+{
+    output_->Append("]", 1);
+    hasElement_.pop_back();
+    return *this;
+}
+
+JsonWriter& JsonWriter::Key(const char* key)
+{
+    BeforeValue();
+    output_->Append("\"", 1);
+    AppendEscaped(key, strlen(key));
+    output_->Append("\":", 2);
+    afterKey_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::String(const char* data, size_t len)
+{
+    BeforeValue();
+    output_->Append("\"", 1);
+    AppendEscaped(data, len);
+    output_->Append("\"", 1);
+    return *this;
+}
+
+JsonWriter& JsonWriter::String(const char* value)
+{
+    if (value == nullptr) return Null();
+    return String(value, strlen(value));
+}
+
+JsonWriter& JsonWriter::Int(int64_t value)
+{
+    BeforeValue();
+    char buf[32];
+    int len = snprintf(buf, sizeof(buf), "%" PRId64, value);
+    output_->Append(buf, static_cast<size_t>(len));
+    return *this;
+}
+
+JsonWriter& JsonWriter::Uint(uint64_t value)
+{
+    BeforeValue();
+    char buf[32];
+    int len = snprintf(buf, sizeof(buf), "%" PRIu64, value);
+    output_->Append(buf, static_cast<size_t>(len));
+    return *this;
+}
+
+JsonWriter& JsonWriter::Bool(bool value)
+{
+    BeforeValue();
+    if (value) output_->Append("true", 4);
+    else output_->Append("false", 5);
+    return *this;
+}
+
+JsonWriter& JsonWriter::Null()
+{
+    BeforeValue();
+    output_->Append("null", 4);
+    return *this;
+}
@@ -4,12 +4,15 @@
 #include "Connection.h"
 
 static constexpr size_t MAX_CHUNK_SIZE = 512 * 1024;  // 8kb
+static constexpr int MAX_STREAM_PULLS = 4;            // 每次写事件最多拉取的生产者数据段数，避免单个大文件长期占用事件循环
 
 Connection::Connection(EventLoop* loop, std::unique_ptr<Socket> clientSock)
            :loop_(loop), 
             clientSock_(std::move(clientSock)), 
             disConnect_(false),
-            clientChannel_(new Channel(loop_, clientSock_->GetFd()))
+            clientChannel_(new Channel(loop_, clientSock_->GetFd())),
+            streamPending_(false),
+            readingPaused_(false)
 {
     clientChannel_->SetReadCallBack(bind(&Connection::HandleMessage, this));
     clientChannel_->SetCloseCallBack(bind(&Connection::CloseCallBack,this));
@@ -114,14 +117,12 @@ void Connection::ErrorCallBack()
     errorCallBack_(shared_from_this());
 }
 
-/**
- * 处理写事件的回调函数，供Channel回调
- */
-void Connection::WriteCallback()
+// 将发送缓冲区尽量写入 socket，内核发送缓冲区满时保留剩余数据
+bool Connection::FlushOutputBuffer()
 {
     while (outputBuffer_->ReadableBytes() > 0)
     {
-        size_t chunkSize = std::min(outputBuffer_->ReadableBytes(), MAX_CHUNK_SIZE);  // 限制块大小（例如 1MB）
+        size_t chunkSize = std::min(outputBuffer_->ReadableBytes(), MAX_CHUNK_SIZE);  // 限制块大小
 
         ssize_t n = ::send(GetFd(), outputBuffer_->Peek(), chunkSize, 0);
         if (n > 0)
@@ -138,30 +139,76 @@ void Connection::WriteCallback()
             else if (errno == EINTR)
             {
                 // 被中断，重试
-                break;
+                continue;
             }
             else
             {
                 std::cerr << "send error, fd: " << GetFd() << ", errno: " << errno << std::endl;
                 CloseCallBack();
-                return;
+                return false;
             }
         }
-        else if (n == 0)
+        else
         {
             // 一般不会发生，但作为保护性代码保留
             break;
         }
     }
+    return true;
+}
 
-    if (outputBuffer_->ReadableBytes() == 0) 
+/**
+ * 处理写事件的回调函数，供Channel回调
+ * 发送缓冲区排空后依次从生产者队列拉取数据，直到 socket 写满、生产者暂无数据或队列为空
+ */
+void Connection::WriteCallback()
+{
+    int pulls = 0;
+    while (true)
     {
-        clientChannel_->DisableWriting(); // 完成发送，停止关注写事件
-        if (sendCompleteCallback_)
-            sendCompleteCallback_(shared_from_this());
+        if (!FlushOutputBuffer()) return;
+
+        // 内核发送缓冲区已满，保持关注写事件
+        if (outputBuffer_->ReadableBytes() > 0) return;
+
+        if (streams_.empty()) break;
+
+        // 队首生产者暂无数据，停止关注写事件，等待 ResumeStream()
+        if (streamPending_)
+        {
+            clientChannel_->DisableWriting();
+            return;
+        }
+
+        // 本次写事件拉取次数已用完：重新注册写事件（ET 模式下会再次触发），让出事件循环
+        if (pulls++ >= MAX_STREAM_PULLS)
+        {
+            clientChannel_->EnableWriting();
+            return;
+        }
+
+        StreamState state = streams_.front()(outputBuffer_.get());
+        if (state == StreamState::kDone)
+        {
+            streams_.pop_front();
+        }
+        else if (state == StreamState::kPending)
+        {
+            streamPending_ = true;
+        }
+        else if (state == StreamState::kError)
+        {
+            std::cerr << "stream producer error, fd: " << GetFd() << std::endl;
+            streams_.clear();
+            CloseCallBack();
+            return;
+        }
     }
-}
 
+    clientChannel_->DisableWriting(); // 完成发送，停止关注写事件
+    if (sendCompleteCallback_)
+        sendCompleteCallback_(shared_from_this());
+}
 
 // 设置关闭fd_的回调函数。
 void Connection::SetCloseCallBack(const std::function<void(spConnection)>& fn)
@@ -186,37 +233,151 @@ void Connection::SetSendCompleteCallback(std::function<void(spConnection)> fn)
     sendCompleteCallback_ = fn;
 }
 
+// 在IO线程中写入发送缓冲区
+void Connection::WriteInLoop(const std::function<void(Buffer*)>& writer)
+{
+    if (streams_.empty())
+    {
+        // 直接追加到发送缓冲区，无需中间拷贝
+        writer(outputBuffer_.get());
+        clientChannel_->EnableWriting();
+    }
+    else
+    {
+        // 前面还有流式数据未发送完，作为一次性生产者排到队尾
+        std::shared_ptr<Buffer> buffer = std::make_shared<Buffer>();
+        writer(buffer.get());
+        streams_.push_back([buffer](Buffer* output) {
+            output->Append(buffer->Peek(), buffer->ReadableBytes());
+            return StreamState::kDone;
+        });
+        if (!streamPending_) clientChannel_->EnableWriting();
+    }
+}
+
 // 发送数据
 void Connection::SendData(const char *data, size_t size)
 { 
     if (disConnect_) return;
-    
-    // 创建 data_copy 来存储数据副本
-    std::string data_copy(data, size); 
 
     // 判断当前线程是否为事件循环线程(IO线程）
     if (loop_->IsInLoopThread())
     {
-        // 如果是IO线程，直接调用发送数据操作
-        SendDataByThread(data_copy);
+        WriteInLoop([data, size](Buffer* output) { output->Append(data, size); });
     }
     else
     {
-        // 如果不是IO线程，将发送数据的操作交给IO线程
+        // 如果不是IO线程，创建数据副本并将发送数据的操作交给IO线程
+        std::string data_copy(data, size);
         loop_->QueueInLoop([this, data_copy](){
             SendDataByThread(data_copy);
         });
     }
 }
 
+// 由 writer 直接向发送缓冲区序列化数据
+void Connection::SendToBuffer(const std::function<void(Buffer*)>& writer)
+{
+    if (disConnect_) return;
+
+    if (loop_->IsInLoopThread())
+    {
+        // IO线程：直接写入发送缓冲区
+        WriteInLoop(writer);
+    }
+    else
+    {
+        // 工作线程：先写入临时缓冲区，再整体交给IO线程
+        std::shared_ptr<Buffer> buffer = std::make_shared<Buffer>();
+        writer(buffer.get());
+        spConnection self = shared_from_this();
+        loop_->QueueInLoop([self, buffer](){
+            self->WriteInLoop([&buffer](Buffer* output) {
+                output->Append(buffer->Peek(), buffer->ReadableBytes());
+            });
+        });
+    }
+}
+
 // 发送数据（如果是IO线程直接调用，否则将此函数传递给IO线程）
 void Connection::SendDataByThread(const std::string &data)
 {
     // 把数据保存到 Connection 的发送缓冲区中
-    outputBuffer_->Append(data.c_str(), data.size());  // 将 std::string 转为 C 风格字符串传递
-    clientChannel_->EnableWriting();  // 启用写事件监听
+    WriteInLoop([&data](Buffer* output) { output->Append(data.data(), data.size()); });
+}
+
+// 追加数据生产者
+void Connection::SendStream(StreamProducer producer)
+{
+    if (disConnect_) return;
+
+    if (loop_->IsInLoopThread())
+    {
+        streams_.push_back(std::move(producer));
+        if (!streamPending_) clientChannel_->EnableWriting();  // 写事件触发后开始拉取
+    }
+    else
+    {
+        spConnection self = shared_from_this();
+        loop_->QueueInLoop([self, producer](){
+            self->SendStream(producer);
+        });
+    }
+}
+
+// 恢复拉取暂无数据的生产者
+void Connection::ResumeStream()
+{
+    if (loop_->IsInLoopThread())
+    {
+        if (disConnect_ || !streamPending_) return;
+        streamPending_ = false;
+        clientChannel_->EnableWriting();
+    }
+    else
+    {
+        spConnection self = shared_from_this();
+        loop_->QueueInLoop([self](){
+            self->ResumeStream();
+        });
+    }
 }
 
+// 暂停读取对端数据
+void Connection::PauseReading()
+{
+    if (loop_->IsInLoopThread())
+    {
+        if (disConnect_ || readingPaused_) return;
+        readingPaused_ = true;
+        clientChannel_->DisableReading();
+    }
+    else
+    {
+        spConnection self = shared_from_this();
+        loop_->QueueInLoop([self](){
+            self->PauseReading();
+        });
+    }
+}
+
+// 恢复读取：重新注册读事件，期间已到达的数据会立即触发一次读事件（ET 模式下 EPOLL_CTL_MOD 会重新检查就绪状态）
+void Connection::ResumeReading()
+{
+    if (loop_->IsInLoopThread())
+    {
+        if (disConnect_ || !readingPaused_) return;
+        readingPaused_ = false;
+        clientChannel_->EnableReading();
+    }
+    else
+    {
+        spConnection self = shared_from_this();
+        loop_->QueueInLoop([self](){
+            self->ResumeReading();
+        });
+    }
+}
 
 // 连接是否已断开
 bool Connection::IsCloseConnection()
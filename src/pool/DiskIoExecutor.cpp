@@ -0,0 +1,174 @@
+#include <cerrno>
+#include <cstring>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "DiskIoExecutor.h"
+#include "EventLoop.h"
+#include "Log.h"
+
+DiskIoExecutor::DiskIoExecutor(const std::string& name)
+              : name_(name),
+                stopped_(false),
+                completed_(0),
+                maxQueueDepth_(0)
+{}
+
+DiskIoExecutor::~DiskIoExecutor()
+{
+    Stop();
+}
+
+// 路径所在的设备号
+dev_t DiskIoExecutor::DeviceOf(const std::string& path)
+{
+    struct stat st;
+    if (stat(path.c_str(), &st) == 0) return st.st_dev;
+
+    size_t pos = path.find_last_of('/');
+    std::string dir = pos == std::string::npos ? "." : (pos == 0 ? "/" : path.substr(0, pos));
+    if (stat(dir.c_str(), &st) == 0) return st.st_dev;
+    return 0;
+}
+
+// 提交任务
+void DiskIoExecutor::Submit(dev_t device, Work work, EventLoop* loop, Completion done)
+{
+    DeviceQueue* queue = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!stopped_)
+        {
+            std::unique_ptr<DeviceQueue>& slot = queues_[device];
+            if (!slot)
+            {
+                // 首次访问该设备时创建队列与线程
+                slot.reset(new DeviceQueue());
+                slot->device = device;
+                slot->thread = std::thread(&DiskIoExecutor::Run, this, slot.get());
+                LOG_INFO << "DiskIoExecutor " << name_ << ": queue for device " << device << " started";
+            }
+            queue = slot.get();
+        }
+    }
+
+    Job job{std::move(work), loop, std::move(done)};
+    if (!queue)
+    {
+        // 已停止（服务退出过程中）：在调用线程中执行，保证任务不丢失
+        if (job.work) job.work();
+        if (job.done && job.loop) job.loop->QueueInLoop(std::move(job.done));
+        else if (job.done) job.done();
+        return;
+    }
+
+    size_t depth;
+    {
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        queue->jobs.push_back(std::move(job));
+        depth = queue->jobs.size();
+    }
+    queue->condition.notify_one();
+
+    size_t maxDepth = maxQueueDepth_;
+    while (depth > maxDepth && !maxQueueDepth_.compare_exchange_weak(maxDepth, depth)) {}
+}
+
+// 设备队列的线程主循环：逐个执行任务，完成回调投递回事件循环
+void DiskIoExecutor::Run(DeviceQueue* queue)
+{
+    while (true)
+    {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(queue->mutex);
+            queue->condition.wait(lock, [queue] { return queue->stop || !queue->jobs.empty(); });
+            // 停止前先执行完已提交的任务（如上传数据写盘）
+            if (queue->jobs.empty()) return;
+            job = std::move(queue->jobs.front());
+            queue->jobs.pop_front();
+        }
+
+        try
+        {
+            if (job.work) job.work();
+        }
+        catch (const std::exception& e)
+        {
+            LOG_ERROR << "DiskIoExecutor " << name_ << ": job failed: " << e.what();
+        }
+        ++completed_;
+
+        if (!job.done) continue;
+        if (job.loop)
+        {
+            job.loop->QueueInLoop(std::move(job.done));
+        }
+        else
+        {
+            job.done();
+        }
+    }
+}
+
+// 读取 fd 在 offset 处的 len 字节，读到文件末尾时返回的数据可能较短
+void DiskIoExecutor::Pread(dev_t device, int fd, uint64_t offset, size_t len, EventLoop* loop,
+                           std::function<void(std::shared_ptr<std::string> data, int err)> done)
+{
+    std::shared_ptr<std::string> data = std::make_shared<std::string>();
+    std::shared_ptr<int> err = std::make_shared<int>(0);
+    Submit(device, [fd, offset, len, data, err]() {
+        data->resize(len);
+        size_t got = 0;
+        while (got < len)
+        {
+            ssize_t n = pread(fd, &(*data)[got], len - got, static_cast<off_t>(offset + got));
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0) *err = errno;
+            if (n <= 0) break;
+            got += static_cast<size_t>(n);
+        }
+        data->resize(got);
+    }, loop, [data, err, done]() { done(data, *err); });
+}
+
+// 停止全部磁盘线程
+void DiskIoExecutor::Stop()
+{
+    std::map<dev_t, std::unique_ptr<DeviceQueue>> queues;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopped_) return;
+        stopped_ = true;
+        queues.swap(queues_);
+    }
+
+    for (auto& item : queues)
+    {
+        {
+            std::lock_guard<std::mutex> lock(item.second->mutex);
+            item.second->stop = true;
+        }
+        item.second->condition.notify_all();
+    }
+    for (auto& item : queues)
+    {
+        if (item.second->thread.joinable()) item.second->thread.join();
+    }
+    LOG_INFO << "DiskIoExecutor " << name_ << " stopped, " << completed_ << " jobs completed, max queue depth "
+             << maxQueueDepth_;
+}
+
+// 某设备当前排队的任务数
+size_t DiskIoExecutor::Pending(dev_t device)
+{
+    DeviceQueue* queue = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = queues_.find(device);
+        if (it == queues_.end()) return 0;
+        queue = it->second.get();
+    }
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    return queue->jobs.size();
+}
@@ -1,6 +1,8 @@
 #include "MySqlConnection.h"
 #include "Log.h"
 
+static const size_t kMaxCachedStatements = 64;  // 每个连接缓存的预处理语句上限（服务器端 max_prepared_stmt_count 为全局限制）
+
 MySqlConnection::MySqlConnection()
 {
     conn_ = mysql_init(nullptr);
@@ -8,6 +10,7 @@ MySqlConnection::MySqlConnection()
 // 释放数据库连接资源
 MySqlConnection::~MySqlConnection()
 {
+    statements_.clear();  // 语句须在连接关闭前释放
     if (conn_ != nullptr)
         mysql_close(conn_);
 }
@@ -41,3 +44,74 @@ MYSQL_RES* MySqlConnection::Query(std::string sql)
     return mysql_store_result(conn_);
 }
 
+// 执行语句，失败返回 -1
+long long MySqlConnection::Execute(const std::string& sql)
+{
+    if (mysql_query(conn_, sql.c_str()))
+    {
+        LOG_ERROR << "执行失败：" << sql << "，" << mysql_error(conn_);
+        return -1;
+    }
+    return static_cast<long long>(mysql_affected_rows(conn_));
+}
+
+// 开启事务
+bool MySqlConnection::BeginTransaction()
+{
+    if (mysql_autocommit(conn_, 0))
+    {
+        LOG_ERROR << "开启事务失败：" << mysql_error(conn_);
+        return false;
+    }
+    return true;
+}
+
+// 提交事务并恢复自动提交
+bool MySqlConnection::Commit()
+{
+    bool ok = mysql_commit(conn_) == 0;
+    if (!ok) LOG_ERROR << "提交事务失败：" << mysql_error(conn_);
+    else mysql_autocommit(conn_, 1);
+    return ok;
+}
+
+// 回滚事务并恢复自动提交，连接归还连接池前必须调用（提交失败时也需要）
+void MySqlConnection::Rollback()
+{
+    mysql_rollback(conn_);
+    mysql_autocommit(conn_, 1);
+}
+
+// 预处理语句：命中缓存直接返回；上次执行失败的语句（如连接中断后服务器端已释放）丢弃后重新准备
+MySqlStatement* MySqlConnection::Prepare(const std::string& sql)
+{
+    auto it = statements_.find(sql);
+    if (it != statements_.end())
+    {
+        if (!it->second->Failed()) return it->second.get();
+        statements_.erase(it);
+    }
+
+    std::unique_ptr<MySqlStatement> stmt(new MySqlStatement(conn_, sql));
+    if (!stmt->IsValid()) return nullptr;
+    // SQL 文本应为固定模板，超出上限说明有调用方拼接了参数，清空缓存避免服务器端语句无限增长
+    if (statements_.size() >= kMaxCachedStatements)
+    {
+        LOG_WARN << "预处理语句缓存已满，清空：" << statements_.size();
+        statements_.clear();
+    }
+    MySqlStatement* raw = stmt.get();
+    statements_[sql] = std::move(stmt);
+    return raw;
+}
+
+// 查询操作 select，逐行读取结果
+MYSQL_RES* MySqlConnection::QueryUnbuffered(std::string sql)
+{
+    if (mysql_query(conn_, sql.c_str()))
+    {
+        LOG_ERROR << "查询失败:" << sql;
+        return nullptr;
+    }
+    return mysql_use_result(conn_);
+}
@@ -0,0 +1,243 @@
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+
+#include "MySqlStatement.h"
+#include "Log.h"
+
+static const unsigned long kMaxInitialColumnBuffer = 4096;  // 字符串列接收缓冲区的初始上限，更长的值按需扩容
+
+// 准备语句并按结果列类型分配接收缓冲区
+MySqlStatement::MySqlStatement(MYSQL* mysql, const std::string& sql)
+              : stmt_(mysql_stmt_init(mysql)),
+                sql_(sql),
+                hasResult_(false),
+                failed_(false)
+{
+    if (!stmt_) return;
+    if (mysql_stmt_prepare(stmt_, sql.data(), sql.size()))
+    {
+        LOG_ERROR << "预处理失败：" << sql << "，" << mysql_stmt_error(stmt_);
+        mysql_stmt_close(stmt_);
+        stmt_ = nullptr;
+        return;
+    }
+
+    params_.resize(mysql_stmt_param_count(stmt_));
+    for (Param& param : params_)
+    {
+        param.intValue = 0;
+        param.length = 0;
+        param.type = MYSQL_TYPE_NULL;
+    }
+
+    // 无结果集的语句（INSERT / UPDATE / DELETE）没有元数据
+    MYSQL_RES* meta = mysql_stmt_result_metadata(stmt_);
+    if (!meta) return;
+    unsigned int count = mysql_num_fields(meta);
+    MYSQL_FIELD* fields = mysql_fetch_fields(meta);
+    columns_.resize(count);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        Column& column = columns_[i];
+        switch (fields[i].type)
+        {
+        case MYSQL_TYPE_TINY:
+        case MYSQL_TYPE_SHORT:
+        case MYSQL_TYPE_INT24:
+        case MYSQL_TYPE_LONG:
+        case MYSQL_TYPE_LONGLONG:
+        case MYSQL_TYPE_YEAR:
+            column.integer = true;
+            break;
+        default:
+            column.integer = false;
+            break;
+        }
+        column.isUnsigned = (fields[i].flags & UNSIGNED_FLAG) != 0;
+        column.buffer.resize(column.integer ? sizeof(long long)
+                                            : std::min(fields[i].length, kMaxInitialColumnBuffer) + 1);
+        column.length = 0;
+        column.isNull = 0;
+        column.error = 0;
+    }
+    mysql_free_result(meta);
+    resultBinds_.resize(count);
+}
+
+MySqlStatement::~MySqlStatement()
+{
+    if (stmt_) mysql_stmt_close(stmt_);
+}
+
+// 按当前缓冲区绑定结果列
+bool MySqlStatement::BindResult()
+{
+    for (size_t i = 0; i < columns_.size(); ++i)
+    {
+        Column& column = columns_[i];
+        MYSQL_BIND& bind = resultBinds_[i];
+        memset(&bind, 0, sizeof(bind));
+        bind.buffer_type = column.integer ? MYSQL_TYPE_LONGLONG : MYSQL_TYPE_STRING;
+        bind.buffer = column.buffer.data();
+        bind.buffer_length = column.buffer.size();
+        bind.is_unsigned = column.isUnsigned;
+        bind.length = &column.length;
+        bind.is_null = &column.isNull;
+        bind.error = &column.error;
+    }
+    return columns_.empty() || !mysql_stmt_bind_result(stmt_, resultBinds_.data());
+}
+
+MySqlStatement& MySqlStatement::BindInt(unsigned int index, long long value)
+{
+    if (index < params_.size())
+    {
+        params_[index].type = MYSQL_TYPE_LONGLONG;
+        params_[index].intValue = value;
+    }
+    return *this;
+}
+
+MySqlStatement& MySqlStatement::BindString(unsigned int index, const std::string& value)
+{
+    if (index < params_.size())
+    {
+        params_[index].type = MYSQL_TYPE_STRING;
+        params_[index].stringValue = value;
+        params_[index].length = value.size();
+    }
+    return *this;
+}
+
+MySqlStatement& MySqlStatement::BindNull(unsigned int index)
+{
+    if (index < params_.size()) params_[index].type = MYSQL_TYPE_NULL;
+    return *this;
+}
+
+// 执行语句
+bool MySqlStatement::Execute(bool buffered)
+{
+    if (!stmt_) return false;
+    FreeResult();
+
+    std::vector<MYSQL_BIND> binds(params_.size());
+    for (size_t i = 0; i < params_.size(); ++i)
+    {
+        Param& param = params_[i];
+        MYSQL_BIND& bind = binds[i];
+        memset(&bind, 0, sizeof(bind));
+        bind.buffer_type = param.type;
+        if (param.type == MYSQL_TYPE_LONGLONG)
+        {
+            bind.buffer = &param.intValue;
+        }
+        else if (param.type == MYSQL_TYPE_STRING)
+        {
+            bind.buffer = const_cast<char*>(param.stringValue.data());
+            bind.buffer_length = param.length;
+            bind.length = &param.length;
+        }
+    }
+
+    failed_ = (!binds.empty() && mysql_stmt_bind_param(stmt_, binds.data())) || mysql_stmt_execute(stmt_) != 0;
+    if (!failed_ && !columns_.empty())
+    {
+        failed_ = !BindResult() || (buffered && mysql_stmt_store_result(stmt_) != 0);
+        hasResult_ = !failed_;
+    }
+    if (failed_)
+    {
+        LOG_ERROR << "执行预处理语句失败：" << sql_ << "，" << mysql_stmt_error(stmt_);
+        return false;
+    }
+    return true;
+}
+
+// 读取下一行，字符串列被截断时扩容后单独重新读取该列，并用新缓冲区绑定后续行
+bool MySqlStatement::Fetch()
+{
+    if (!hasResult_) return false;
+    int rc = mysql_stmt_fetch(stmt_);
+    if (rc == MYSQL_DATA_TRUNCATED)
+    {
+        for (size_t i = 0; i < columns_.size(); ++i)
+        {
+            Column& column = columns_[i];
+            if (!column.error || column.integer) continue;
+            column.buffer.resize(column.length + 1);
+            MYSQL_BIND& bind = resultBinds_[i];
+            bind.buffer = column.buffer.data();
+            bind.buffer_length = column.buffer.size();
+            if (mysql_stmt_fetch_column(stmt_, &bind, static_cast<unsigned int>(i), 0) != 0)
+            {
+                rc = 1;
+                break;
+            }
+            column.error = 0;
+        }
+        if (rc != 1 && !BindResult()) rc = 1;
+        if (rc != 1) rc = 0;
+    }
+    if (rc == 0) return true;
+
+    if (rc != MYSQL_NO_DATA)
+    {
+        failed_ = true;
+        LOG_ERROR << "读取预处理语句结果失败：" << sql_ << "，" << mysql_stmt_error(stmt_);
+    }
+    FreeResult();
+    return false;
+}
+
+// 释放结果集：逐行模式下未读完的行由客户端库读尽，之后连接才能执行其他语句
+void MySqlStatement::FreeResult()
+{
+    if (!hasResult_) return;
+    mysql_stmt_free_result(stmt_);
+    hasResult_ = false;
+}
+
+long long MySqlStatement::AffectedRows()
+{
+    return stmt_ ? static_cast<long long>(mysql_stmt_affected_rows(stmt_)) : -1;
+}
+
+bool MySqlStatement::IsNull(unsigned int index) const
+{
+    return index >= columns_.size() || columns_[index].isNull;
+}
+
+long long MySqlStatement::GetInt(unsigned int index) const
+{
+    if (IsNull(index)) return 0;
+    const Column& column = columns_[index];
+    if (column.integer)
+    {
+        long long value;
+        memcpy(&value, column.buffer.data(), sizeof(value));
+        return value;
+    }
+    // 非整数列（如 UNIX_TIMESTAMP 返回的 DECIMAL）按字符串解析
+    return strtoll(std::string(column.buffer.data(), column.length).c_str(), nullptr, 10);
+}
+
+std::string MySqlStatement::GetString(unsigned int index) const
+{
+    if (IsNull(index)) return "";
+    const Column& column = columns_[index];
+    if (column.integer) return std::to_string(GetInt(index));
+    return std::string(column.buffer.data(), column.length);
+}
+
+const char* MySqlStatement::GetData(unsigned int index, unsigned long* length) const
+{
+    if (IsNull(index) || columns_[index].integer)
+    {
+        *length = 0;
+        return "";
+    }
+    *length = columns_[index].length;
+    return columns_[index].buffer.data();
+}
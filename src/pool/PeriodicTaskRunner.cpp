@@ -0,0 +1,88 @@
+#include "PeriodicTaskRunner.h"
+#include "Log.h"
+
+PeriodicTaskRunner::PeriodicTaskRunner(const std::string& name)
+                  : name_(name),
+                    started_(false),
+                    stop_(false)
+{}
+
+PeriodicTaskRunner::~PeriodicTaskRunner()
+{
+    Stop();
+}
+
+// 注册周期任务
+void PeriodicTaskRunner::AddTask(const std::string& name, int intervalMs, std::function<void()> fn)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Task task;
+        task.name = name;
+        task.interval = std::chrono::milliseconds(intervalMs);
+        task.nextRun = std::chrono::steady_clock::now() + task.interval;
+        task.fn = std::move(fn);
+        tasks_.push_back(std::move(task));
+    }
+    condition_.notify_one();
+}
+
+// 启动后台线程
+void PeriodicTaskRunner::Start()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (started_) return;
+    started_ = true;
+    thread_ = std::thread(&PeriodicTaskRunner::Run, this);
+}
+
+// 停止后台线程
+void PeriodicTaskRunner::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stop_) return;
+        stop_ = true;
+    }
+    condition_.notify_all();
+    if (thread_.joinable()) thread_.join();
+}
+
+// 后台线程主循环：等待最早到期的任务，执行时释放锁
+void PeriodicTaskRunner::Run()
+{
+    LOG_INFO << "PeriodicTaskRunner " << name_ << " started";
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_)
+    {
+        auto now = std::chrono::steady_clock::now();
+        auto wakeUp = now + std::chrono::seconds(1);
+
+        for (size_t i = 0; i < tasks_.size() && !stop_; ++i)
+        {
+            if (tasks_[i].nextRun <= now)
+            {
+                tasks_[i].nextRun = now + tasks_[i].interval;
+                std::function<void()> fn = tasks_[i].fn;
+                std::string taskName = tasks_[i].name;
+
+                lock.unlock();
+                try
+                {
+                    fn();
+                }
+                catch (const std::exception& e)
+                {
+                    LOG_ERROR << "Periodic task " << taskName << " failed: " << e.what();
+                }
+                lock.lock();
+            }
+            if (i < tasks_.size() && tasks_[i].nextRun < wakeUp) wakeUp = tasks_[i].nextRun;
+        }
+
+        condition_.wait_until(lock, wakeUp);
+    }
+
+    LOG_INFO << "PeriodicTaskRunner " << name_ << " stopped";
+}
@@ -0,0 +1,190 @@
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "BlobScrubber.h"
+#include "Log.h"
+
+// 是否以 suffix 结尾
+static bool EndsWith(const std::string& s, const std::string& suffix)
+{
+    return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+BlobScrubber::BlobScrubber(const std::string& blobDir)
+            : blobDir_(blobDir),
+              buffer_(BlockChecksum::kBlockSize),
+              fd_(-1),
+              size_(0),
+              offset_(0),
+              adopting_(false),
+              inPass_(false),
+              scannedBlobs_(0),
+              scannedBytes_(0),
+              corrupted_(0),
+              adopted_(0),
+              passes_(0)
+{}
+
+BlobScrubber::~BlobScrubber()
+{
+    if (fd_ >= 0) close(fd_);
+}
+
+// 列出 <blob 根目录>/<两位前缀>/<摘要>，跳过旁路文件与临时文件
+void BlobScrubber::Rescan()
+{
+    DIR* root = opendir(blobDir_.c_str());
+    if (!root) return;  // 尚未有任何 blob
+
+    struct dirent* shard;
+    while ((shard = readdir(root)) != nullptr)
+    {
+        if (shard->d_name[0] == '.') continue;
+        std::string shardDir = blobDir_ + "/" + shard->d_name;
+        DIR* dir = opendir(shardDir.c_str());
+        if (!dir) continue;
+
+        struct dirent* entry;
+        while ((entry = readdir(dir)) != nullptr)
+        {
+            std::string name = entry->d_name;
+            if (name[0] == '.' || EndsWith(name, ".crc") || EndsWith(name, ".tmp")) continue;
+            pending_.push_back(shardDir + "/" + name);
+        }
+        closedir(dir);
+    }
+    closedir(root);
+
+    inPass_ = !pending_.empty();
+}
+
+// 打开下一个 blob 并加载其校验和
+bool BlobScrubber::OpenNext()
+{
+    while (!pending_.empty())
+    {
+        std::string path = pending_.front();
+        pending_.pop_front();
+
+        // 列出后已被删除的 blob 直接跳过
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) continue;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode))
+        {
+            close(fd);
+            continue;
+        }
+        posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+        current_ = path;
+        fd_ = fd;
+        size_ = static_cast<uint64_t>(st.st_size);
+        offset_ = 0;
+        expected_ = BlockChecksum();
+        computed_ = BlockChecksum();
+        adopting_ = !expected_.Load(BlockChecksum::SidecarPath(path));
+
+        // 文件大小与记录不符：上传不完整或被截断，无需再逐块读取
+        if (!adopting_ && expected_.TotalBytes() != size_)
+        {
+            ReportCorrupt("size " + std::to_string(size_) + ", expected " + std::to_string(expected_.TotalBytes()));
+            continue;
+        }
+        return true;
+    }
+    return false;
+}
+
+// 结束当前 blob
+void BlobScrubber::CloseCurrent()
+{
+    if (fd_ >= 0) close(fd_);
+    fd_ = -1;
+    current_.clear();
+}
+
+// 当前 blob 校验失败：记录后跳过，blob 与引用它的文件保持不变，由管理员处理
+void BlobScrubber::ReportCorrupt(const std::string& reason)
+{
+    ++corrupted_;
+    LOG_ERROR << "BlobScrubber: " << current_ << " is corrupted: " << reason;
+    CloseCurrent();
+}
+
+// 校验至多约 budget 字节
+uint64_t BlobScrubber::Step(uint64_t budget)
+{
+    if (current_.empty() && pending_.empty()) Rescan();
+
+    uint64_t bytesRead = 0;
+    while (bytesRead == 0 || bytesRead < budget)
+    {
+        if (current_.empty() && !OpenNext())
+        {
+            if (inPass_)
+            {
+                inPass_ = false;
+                ++passes_;
+                LOG_INFO << "BlobScrubber: pass " << passes_ << " finished, " << scannedBlobs_ << " blobs / "
+                         << scannedBytes_ << " bytes scanned, " << corrupted_ << " corrupted, " << adopted_ << " adopted";
+            }
+            break;
+        }
+
+        // 当前 blob 已读完
+        if (offset_ >= size_)
+        {
+            if (adopting_)
+            {
+                // 旧 blob 没有旁路文件：以当前内容作为基准，仍存在（未被删除）且期间没有写入旁路文件时才保存
+                std::string sidecar = BlockChecksum::SidecarPath(current_);
+                computed_.Finish();
+                if (access(current_.c_str(), F_OK) == 0 && access(sidecar.c_str(), F_OK) != 0 &&
+                    computed_.Save(sidecar))
+                {
+                    ++adopted_;
+                }
+            }
+            ++scannedBlobs_;
+            CloseCurrent();
+            continue;
+        }
+
+        // 读取一块并比对
+        size_t len = static_cast<size_t>(std::min<uint64_t>(BlockChecksum::kBlockSize, size_ - offset_));
+        size_t got = 0;
+        while (got < len)
+        {
+            ssize_t n = pread(fd_, buffer_.data() + got, len - got, static_cast<off_t>(offset_ + got));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) break;
+            got += static_cast<size_t>(n);
+        }
+        bytesRead += got;
+        scannedBytes_ += got;
+        if (got != len)
+        {
+            ReportCorrupt("read failed at offset " + std::to_string(offset_ + got));
+            continue;
+        }
+
+        size_t index = static_cast<size_t>(offset_ / BlockChecksum::kBlockSize);
+        if (adopting_)
+        {
+            computed_.Update(buffer_.data(), len);
+        }
+        else if (!expected_.VerifyBlock(index, buffer_.data(), len))
+        {
+            ReportCorrupt("checksum mismatch in block " + std::to_string(index));
+            continue;
+        }
+        offset_ += len;
+    }
+    return bytesRead;
+}
@@ -0,0 +1,106 @@
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <functional>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "BlobStore.h"
+#include "Log.h"
+
+BlobStore::BlobStore(const std::string& uploadDir)
+         : blobDir_(uploadDir + "/.blobs"),
+           stored_(0),
+           deduplicated_(0),
+           savedBytes_(0),
+           released_(0)
+{}
+
+std::mutex& BlobStore::LockFor(const std::string& digest)
+{
+    return locks_[std::hash<std::string>()(digest) % kLockStripes];
+}
+
+std::string BlobStore::BlobPath(const std::string& digest) const
+{
+    return blobDir_ + "/" + digest.substr(0, 2) + "/" + digest;
+}
+
+std::string BlobStore::ChecksumPath(const std::string& digest) const
+{
+    return BlockChecksum::SidecarPath(BlobPath(digest));
+}
+
+// 上传完成后提交
+bool BlobStore::Commit(const std::string& filePath, const std::string& digest, uintmax_t size,
+                       const BlockChecksum* checksum)
+{
+    std::string blobPath = BlobPath(digest);
+    std::lock_guard<std::mutex> lock(LockFor(digest));
+
+    // 1. 已有相同内容：先链接到临时名，再原子替换上传文件，刚写入的副本随之释放
+    struct stat st;
+    if (stat(blobPath.c_str(), &st) == 0 && static_cast<uintmax_t>(st.st_size) == size)
+    {
+        std::string linkPath = filePath + ".dedup";
+        if (link(blobPath.c_str(), linkPath.c_str()) == 0)
+        {
+            if (rename(linkPath.c_str(), filePath.c_str()) == 0)
+            {
+                // 去重前创建的 blob 没有旁路文件，用本次上传计算的校验和补上
+                std::string crcPath = ChecksumPath(digest);
+                if (checksum && access(crcPath.c_str(), F_OK) != 0) checksum->Save(crcPath);
+                ++deduplicated_;
+                savedBytes_ += size;
+                return true;
+            }
+            unlink(linkPath.c_str());
+        }
+        LOG_WARN << "BlobStore: failed to link " << filePath << " to " << blobPath << ": " << strerror(errno);
+        return false;
+    }
+
+    // 2. 新内容：上传文件本身成为 blob（增加一个硬链接）
+    mkdir(blobDir_.c_str(), 0755);
+    mkdir((blobDir_ + "/" + digest.substr(0, 2)).c_str(), 0755);
+    if (link(filePath.c_str(), blobPath.c_str()) != 0)
+    {
+        LOG_WARN << "BlobStore: failed to store " << blobPath << ": " << strerror(errno);
+        return false;
+    }
+    if (checksum && !checksum->Save(ChecksumPath(digest)))
+    {
+        LOG_WARN << "BlobStore: failed to save checksums of " << blobPath << ": " << strerror(errno);
+    }
+    ++stored_;
+    return false;
+}
+
+// 删除文件并按需回收 blob
+void BlobStore::Release(const std::string& filePath, const std::string& digest)
+{
+    if (digest.empty())
+    {
+        if (unlink(filePath.c_str()) != 0 && errno != ENOENT)
+        {
+            LOG_WARN << "Failed to delete file: " << filePath << ", error: " << strerror(errno);
+        }
+        return;
+    }
+
+    std::string blobPath = BlobPath(digest);
+    std::lock_guard<std::mutex> lock(LockFor(digest));
+    if (unlink(filePath.c_str()) != 0 && errno != ENOENT)
+    {
+        LOG_WARN << "Failed to delete file: " << filePath << ", error: " << strerror(errno);
+        return;
+    }
+
+    // 只剩 blob 自身这一个链接时说明已无文件引用
+    struct stat st;
+    if (stat(blobPath.c_str(), &st) == 0 && st.st_nlink <= 1)
+    {
+        if (unlink(blobPath.c_str()) == 0) ++released_;
+        unlink(ChecksumPath(digest).c_str());
+    }
+}
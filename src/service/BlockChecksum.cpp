@@ -0,0 +1,123 @@
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+#include "BlockChecksum.h"
+#include "Crc32c.h"
+
+const uint32_t BlockChecksum::kBlockSize;
+
+// 旁路文件格式：magic(4) | 块大小(4) | 文件大小(8) | 块数(4) | 各块校验和(4 * 块数) | 以上内容的校验和(4)
+static const char kMagic[4] = {'R', 'F', 'C', 'K'};
+static const size_t kHeaderSize = 20;
+
+BlockChecksum::BlockChecksum()
+             : current_(0),
+               currentLen_(0),
+               totalBytes_(0),
+               finished_(false)
+{}
+
+// 追加数据：按块边界切分
+void BlockChecksum::Update(const void* data, size_t len)
+{
+    const char* p = static_cast<const char*>(data);
+    totalBytes_ += len;
+    while (len > 0)
+    {
+        size_t n = std::min(len, static_cast<size_t>(kBlockSize - currentLen_));
+        current_ = Crc32c::Extend(current_, p, n);
+        currentLen_ += static_cast<uint32_t>(n);
+        p += n;
+        len -= n;
+
+        if (currentLen_ == kBlockSize)
+        {
+            blocks_.push_back(current_);
+            current_ = 0;
+            currentLen_ = 0;
+        }
+    }
+}
+
+// 结束计算
+void BlockChecksum::Finish()
+{
+    if (finished_) return;
+    if (currentLen_ > 0) blocks_.push_back(current_);
+    current_ = 0;
+    currentLen_ = 0;
+    finished_ = true;
+}
+
+// 校验一块数据
+bool BlockChecksum::VerifyBlock(size_t index, const void* data, size_t len) const
+{
+    if (index >= blocks_.size()) return false;
+    return Crc32c::Value(data, len) == blocks_[index];
+}
+
+// 写入旁路文件
+bool BlockChecksum::Save(const std::string& path) const
+{
+    uint32_t blockSize = kBlockSize;
+    uint32_t count = static_cast<uint32_t>(blocks_.size());
+
+    std::string content(kMagic, sizeof(kMagic));
+    content.append(reinterpret_cast<const char*>(&blockSize), sizeof(blockSize));
+    content.append(reinterpret_cast<const char*>(&totalBytes_), sizeof(totalBytes_));
+    content.append(reinterpret_cast<const char*>(&count), sizeof(count));
+    if (!blocks_.empty())
+    {
+        content.append(reinterpret_cast<const char*>(blocks_.data()), blocks_.size() * sizeof(uint32_t));
+    }
+    uint32_t trailer = Crc32c::Value(content.data(), content.size());
+    content.append(reinterpret_cast<const char*>(&trailer), sizeof(trailer));
+
+    std::string tmpPath = path + ".tmp";
+    FILE* fp = fopen(tmpPath.c_str(), "wb");
+    if (!fp) return false;
+    bool ok = fwrite(content.data(), 1, content.size(), fp) == content.size();
+    ok = fclose(fp) == 0 && ok;
+    if (!ok || rename(tmpPath.c_str(), path.c_str()) != 0)
+    {
+        remove(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+// 读取旁路文件
+bool BlockChecksum::Load(const std::string& path)
+{
+    FILE* fp = fopen(path.c_str(), "rb");
+    if (!fp) return false;
+    std::string content;
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), fp)) > 0) content.append(buf, n);
+    fclose(fp);
+
+    // 校验头部、长度与整体校验和，旁路文件自身损坏时视为不存在
+    if (content.size() < kHeaderSize + sizeof(uint32_t) || memcmp(content.data(), kMagic, sizeof(kMagic)) != 0)
+    {
+        return false;
+    }
+    uint32_t blockSize, count, trailer;
+    uint64_t totalBytes;
+    memcpy(&blockSize, content.data() + 4, sizeof(blockSize));
+    memcpy(&totalBytes, content.data() + 8, sizeof(totalBytes));
+    memcpy(&count, content.data() + 16, sizeof(count));
+    size_t expectedSize = kHeaderSize + (static_cast<size_t>(count) + 1) * sizeof(uint32_t);
+    if (blockSize != kBlockSize || content.size() != expectedSize) return false;
+    memcpy(&trailer, content.data() + content.size() - sizeof(trailer), sizeof(trailer));
+    if (Crc32c::Value(content.data(), content.size() - sizeof(trailer)) != trailer) return false;
+
+    blocks_.resize(count);
+    if (count > 0) memcpy(blocks_.data(), content.data() + kHeaderSize, count * sizeof(uint32_t));
+    totalBytes_ = totalBytes;
+    current_ = 0;
+    currentLen_ = 0;
+    finished_ = true;
+    return true;
+}
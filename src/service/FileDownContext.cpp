@@ -1,82 +1,345 @@
+#include <cstdio>
+#include <cstring>
+
 #include "FileDownContext.h"
+#include "HttpValidator.h"
 #include "Log.h"
 
+static constexpr uintmax_t kChunkSize = 1024 * 1024; // 1MB 每次读取的数据块大小
+static_assert(kChunkSize == BlockChecksum::kBlockSize, "download chunks must align with checksum blocks");
+static constexpr uintmax_t kReadaheadWindow = 8 * 1024 * 1024;       // 在发送位置之前保持预读的字节数
+static constexpr uintmax_t kDropBehindThreshold = 64 * 1024 * 1024;  // 不小于该大小的文件发送后释放页缓存
+static constexpr uintmax_t kDropBehindBatch = 8 * 1024 * 1024;       // 每发送这么多字节释放一次
+
 // 构造函数，初始化下载上下文
 FileDownContext::FileDownContext(const std::string& filepath, const std::string& originalFileName)
                 : filepath_(filepath),
                   originalFileName_(originalFileName), // 原始文件名
                   fileSize_(0),                        // 文件大小，初始化为0
                   currentPosition_(0),                 // 当前读取位置，初始化为0
-                  isComplete_(false)                   // 是否完成，初始化为false
+                  isComplete_(false),                  // 是否完成，初始化为false
+                  rangeIndex_(0),
+                  multipart_(false),
+                  partHeaderSent_(false),
+                  trailerSent_(false),
+                  readError_(false),
+                  diskIo_(nullptr),
+                  device_(0),
+                  loop_(nullptr),
+                  readyOffset_(0),
+                  readInFlight_(false),
+                  readaheadEnd_(0),
+                  droppedTo_(0),
+                  dropBehind_(false),
+                  verify_(false),
+                  mtime_(0)
 {
-    // 获取文件大小
-    fileSize_ = fs::file_size(filepath_);
-    
+    // 获取文件大小与校验信息：inode + 大小 + 纳秒级修改时间，任何一项变化都会生成新的 ETag
+    struct stat st;
+    if (stat(filepath_.c_str(), &st) != 0)
+    {
+        LOG_ERROR << "Failed to stat file: " << filepath_;
+        throw std::runtime_error("Failed to stat file: " + filepath_);
+    }
+    fileSize_ = static_cast<uintmax_t>(st.st_size);
+    dropBehind_ = fileSize_ >= kDropBehindThreshold;
+    device_ = st.st_dev;
+    mtime_ = st.st_mtim.tv_sec;
+    lastModified_ = HttpValidator::FormatHttpDate(mtime_);
+
+    char etag[96];
+    snprintf(etag, sizeof(etag), "\"%llx-%llx-%llx.%lx\"",
+             static_cast<unsigned long long>(st.st_ino),
+             static_cast<unsigned long long>(st.st_size),
+             static_cast<unsigned long long>(st.st_mtim.tv_sec),
+             static_cast<long>(st.st_mtim.tv_nsec));
+    etag_ = etag;
+
     // 打开文件
-    file_.open(filepath_, std::ios::binary | std::ios::in);
-    if (!file_.is_open()) 
+    fd_ = open(filepath_.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd_ < 0) 
     {
         LOG_ERROR << "Failed to open file: " << filepath_;
         throw std::runtime_error("Failed to open file: " + filepath_);
     }
     LOG_INFO << "Opening file for download: " << filepath_ << ", size: " << fileSize_;
+
+    // 默认发送完整文件
+    std::vector<ByteRange> ranges;
+    if (fileSize_ > 0) ranges.push_back({0, fileSize_ - 1});
+    SetRanges(ranges);
 }
 
 // 析构函数，关闭文件
 FileDownContext::~FileDownContext() 
 {
-    if (file_.is_open()) file_.close();
+    if (fd_ >= 0) close(fd_);
 }
 
-// 将文件指针移至指定位置
-void FileDownContext::SeekTo(uintmax_t position) 
+// 设置要发送的字节范围
+void FileDownContext::SetRanges(const std::vector<ByteRange>& ranges, const std::string& boundary,
+                                const std::string& partContentType)
 {
      // 如果文件未成功打开，抛出异常
-    if (!file_.is_open()) 
+    if (fd_ < 0) 
     {
         throw std::runtime_error("File is not open: " + filepath_);
     }
-    file_.seekg(position);  // 移动文件指针
-    currentPosition_ = position;// 更新当前读取位置
-    isComplete_ = false;// 重置完成标志
+
+    ranges_ = ranges;
+    rangeIndex_ = 0;
+    multipart_ = ranges_.size() > 1;
+    boundary_ = boundary;
+    partContentType_ = partContentType;
+    partHeaderSent_ = false;
+    trailerSent_ = false;
+    isComplete_ = false; // 重置完成标志
+
+    currentPosition_ = ranges_.empty() ? fileSize_ : ranges_[0].start;
+    readaheadEnd_ = currentPosition_;
+    droppedTo_ = currentPosition_;
+    ready_.reset();
+
+    // 单个范围从头读到尾：让内核加大该文件的预读窗口；多个范围之间有跳跃，保持默认
+    posix_fadvise(fd_, 0, 0, ranges_.size() == 1 ? POSIX_FADV_SEQUENTIAL : POSIX_FADV_NORMAL);
 }
 
-// 读取下一个文件块
-bool FileDownContext::ReadNextChunk(std::string& chunk) 
+// 启用异步读取
+void FileDownContext::EnableAsyncRead(DiskIoExecutor* executor, const spConnection& conn)
 {
-    // 如果文件未打开或已经完成，返回 false
-    if (!file_.is_open() || isComplete_) return false;
+    diskIo_ = executor;
+    loop_ = conn->GetLoop();
+    conn_ = conn;
+}
+
+// 启用下载校验
+bool FileDownContext::EnableVerify(const std::string& sidecarPath)
+{
+    if (!checksum_.Load(sidecarPath) || checksum_.TotalBytes() != fileSize_) return false;
+    verify_ = true;
+    return true;
+}
 
-    const uintmax_t chunkSize = 1024 * 1024; // 1MB 每次读取的数据块大小
-    uintmax_t remainingBytes = fileSize_ - currentPosition_; // 剩余未读取的字节数
-    uintmax_t bytesToRead = std::min(chunkSize, remainingBytes); // 本次要读取的字节数
+// 校验一段数据：Read() 在启用校验时按块边界切分读取，范围起点不对齐时第一段不是完整块，跳过
+bool FileDownContext::VerifyChunk(uintmax_t offset, const char* data, size_t len) const
+{
+    if (!verify_ || offset % kChunkSize != 0) return true;
+    if (len != kChunkSize && offset + len != fileSize_) return true;
+    if (checksum_.VerifyBlock(static_cast<size_t>(offset / kChunkSize), data, len)) return true;
+
+    LOG_ERROR << "Checksum mismatch in " << filepath_ << " at block " << offset / kChunkSize << ", download aborted";
+    return false;
+}
+
+// 提交读取任务，完成回调在连接所在的事件循环中执行
+void FileDownContext::SubmitRead(uintmax_t offset, size_t len)
+{
+    readInFlight_ = true;
+    std::shared_ptr<FileDownContext> self = shared_from_this();
+    diskIo_->Pread(device_, fd_, offset, len, loop_, [self, offset, len](std::shared_ptr<std::string> data, int err) {
+        self->readInFlight_ = false;
+        if (err != 0 || data->size() != len)
+        {
+            // 文件在发送过程中被截断，无法再满足已声明的 Content-Length
+            LOG_ERROR << "Short read on " << self->filepath_ << " at " << offset << ": " << strerror(err);
+            self->readError_ = true;
+        }
+        self->ready_ = data;
+        self->readyOffset_ = offset;
 
-    if (bytesToRead == 0) 
+        spConnection conn = self->conn_.lock();
+        if (conn) conn->ResumeStream();
+    });
+}
+
+// 预取下一块，跨到下一个范围时从其起点读取
+void FileDownContext::Prefetch()
+{
+    if (readInFlight_ || readError_ || rangeIndex_ >= ranges_.size()) return;
+    uintmax_t offset = currentPosition_;
+    size_t index = rangeIndex_;
+    if (offset > ranges_[index].end)
+    {
+        if (++index >= ranges_.size()) return;
+        offset = ranges_[index].start;
+    }
+    SubmitRead(offset, static_cast<size_t>(ChunkLength(offset, ranges_[index].end)));
+}
+
+// 下一次读取长度：不超过一块与范围末尾，启用校验时不跨块边界
+uintmax_t FileDownContext::ChunkLength(uintmax_t offset, uintmax_t rangeEnd) const
+{
+    uintmax_t length = std::min(kChunkSize, rangeEnd + 1 - offset);
+    // 范围起点不对齐时先读到下一个块边界，之后的读取都是完整块
+    if (verify_) length = std::min(length, kChunkSize - offset % kChunkSize);
+    return length;
+}
+
+// 预读与释放页缓存：position 之前的数据已复制到发送缓冲区
+// 预读剩余不足半个窗口时才补发，释放按批进行，避免每块都发起系统调用
+void FileDownContext::Advise(uintmax_t position, const ByteRange& range)
+{
+    uintmax_t aheadFrom = 0, aheadLength = 0;
+    uintmax_t target = std::min(range.end + 1, position + kReadaheadWindow);
+    if (readaheadEnd_ < position) readaheadEnd_ = position;
+    if (readaheadEnd_ < target && readaheadEnd_ - position < kReadaheadWindow / 2)
+    {
+        aheadFrom = readaheadEnd_;
+        aheadLength = target - readaheadEnd_;
+        readaheadEnd_ = target;
+    }
+
+    uintmax_t dropFrom = 0, dropLength = 0;
+    if (dropBehind_ && position > droppedTo_ && (position - droppedTo_ >= kDropBehindBatch || position > range.end))
+    {
+        dropFrom = droppedTo_;
+        dropLength = position - droppedTo_;
+        droppedTo_ = position;
+    }
+    if (aheadLength == 0 && dropLength == 0) return;
+
+    int fd = fd_;
+    auto hint = [fd, aheadFrom, aheadLength, dropFrom, dropLength]() {
+        if (aheadLength > 0) readahead(fd, static_cast<off64_t>(aheadFrom), static_cast<size_t>(aheadLength));
+        if (dropLength > 0) posix_fadvise(fd, static_cast<off_t>(dropFrom), static_cast<off_t>(dropLength), POSIX_FADV_DONTNEED);
+    };
+    if (diskIo_)
+    {
+        // readahead 可能在读取文件元数据时阻塞，交给磁盘线程；任务持有 self，文件描述符在执行前不会被关闭
+        std::shared_ptr<FileDownContext> self = shared_from_this();
+        diskIo_->Submit(device_, [self, hint]() { hint(); });
+    }
+    else
     {
-        // 如果没有数据可读取，标记为完成并返回 false
+        hint();
+    }
+}
+
+// multipart 分段头
+std::string FileDownContext::PartHeader(const ByteRange& range) const
+{
+    return "\r\n--" + boundary_ + "\r\n"
+           "Content-Type: " + partContentType_ + "\r\n"
+           "Content-Range: " + HttpRange::ContentRange(range, fileSize_) + "\r\n\r\n";
+}
+
+// multipart 结束分隔符
+std::string FileDownContext::Trailer() const
+{
+    return "\r\n--" + boundary_ + "--\r\n";
+}
+
+// 响应正文总长度
+uintmax_t FileDownContext::GetBodyLength() const
+{
+    uintmax_t length = 0;
+    for (const ByteRange& range : ranges_)
+    {
+        length += range.Length();
+        if (multipart_) length += PartHeader(range).size();
+    }
+    if (multipart_) length += Trailer().size();
+    return length;
+}
+
+// 向发送缓冲区追加下一个正文块
+StreamState FileDownContext::Read(Buffer* output) 
+{
+    // 如果文件未打开或已经完成，直接结束
+    if (fd_ < 0 || isComplete_) return readError_ ? StreamState::kError : StreamState::kDone;
+    if (readError_)
+    {
+        isComplete_ = true;
+        return StreamState::kError;
+    }
+
+    // 当前范围已发送完毕，切换到下一个范围
+    if (rangeIndex_ < ranges_.size() && currentPosition_ > ranges_[rangeIndex_].end)
+    {
+        ++rangeIndex_;
+        partHeaderSent_ = false;
+        if (rangeIndex_ < ranges_.size())
+        {
+            currentPosition_ = ranges_[rangeIndex_].start;
+            readaheadEnd_ = currentPosition_;
+            droppedTo_ = currentPosition_;
+        }
+    }
+
+    if (rangeIndex_ >= ranges_.size())
+    {
+        // 所有范围发送完毕，multipart 还需发送结束分隔符
+        if (multipart_ && !trailerSent_)
+        {
+            output->Append(Trailer());
+            trailerSent_ = true;
+        }
         isComplete_ = true;
-        return false;
+        return StreamState::kDone;
+    }
+
+    const ByteRange& range = ranges_[rangeIndex_];
+    if (multipart_ && !partHeaderSent_)
+    {
+        output->Append(PartHeader(range));
+        partHeaderSent_ = true;
     }
 
-    std::vector<char> buffer(bytesToRead); // 缓冲区，用于存储读取的数据
-    file_.read(buffer.data(), bytesToRead);// 从文件读取数据
-    chunk.assign(buffer.data(), bytesToRead);// 将读取到的内容存入 chunk
-    currentPosition_ += bytesToRead;// 更新当前读取位置
+    // 本次读取不超过当前范围的末尾
+    uintmax_t bytesToRead = ChunkLength(currentPosition_, range.end);
+    if (diskIo_)
+    {
+        // 异步读取：数据未就绪时提交读取任务并等待，就绪后由完成回调恢复发送
+        if (!ready_ || readyOffset_ != currentPosition_ || ready_->size() != bytesToRead)
+        {
+            if (!readInFlight_) SubmitRead(currentPosition_, static_cast<size_t>(bytesToRead));
+            return StreamState::kPending;
+        }
+        if (!VerifyChunk(currentPosition_, ready_->data(), ready_->size()))
+        {
+            // 响应头已发出，只能中止连接，客户端据长度不足判断下载失败，而不是收到损坏的数据
+            readError_ = true;
+            isComplete_ = true;
+            return StreamState::kError;
+        }
+        output->Append(*ready_);
+        ready_.reset();
+        currentPosition_ += bytesToRead;
+        // 预读提示先于预取入队，同一设备按序执行，预取的读取可以命中预读
+        Advise(currentPosition_, range);
+        Prefetch();
+        return StreamState::kMore;
+    }
+
+    // 同步读取：直接读入发送缓冲区
+    output->EnsureWritableBytes(bytesToRead);
+    ssize_t n = pread(fd_, output->BeginWrite(), bytesToRead, static_cast<off_t>(currentPosition_));
+    if (n < 0 || static_cast<uintmax_t>(n) != bytesToRead)
+    {
+        // 文件在发送过程中被截断，无法再满足已声明的 Content-Length
+        LOG_ERROR << "Short read on " << filepath_ << " at " << currentPosition_;
+        readError_ = true;
+        isComplete_ = true;
+        return StreamState::kError;
+    }
+    if (!VerifyChunk(currentPosition_, output->BeginWrite(), static_cast<size_t>(bytesToRead)))
+    {
+        readError_ = true;
+        isComplete_ = true;
+        return StreamState::kError;
+    }
+    output->HasWritten(bytesToRead);
+    currentPosition_ += bytesToRead; // 更新当前读取位置
+    Advise(currentPosition_, range);
 
     // 记录日志，显示已读取的字节数和当前位置
     LOG_INFO << "Read chunk of " << bytesToRead << " bytes, current position: " 
                 << currentPosition_ << "/" << fileSize_;
-    return true;
+    return StreamState::kMore;
 }
 
-// 检查文件是否读取完成
-bool FileDownContext::IsComplete() const { return isComplete_; }
-
-// 获取当前读取位置
-uintmax_t FileDownContext::GetCurrentPosition() const { return currentPosition_; }
-
 // 获取文件总大小
 uintmax_t FileDownContext::GetFileSize() const { return fileSize_; }
 
 // 获取原始文件名
-const std::string& FileDownContext::GetOriginalFileName() const { return originalFileName_; }
\ No newline at end of file
+const std::string& FileDownContext::GetOriginalFileName() const { return originalFileName_; }
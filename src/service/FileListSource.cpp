@@ -0,0 +1,130 @@
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+#include "FileListSource.h"
+#include "Log.h"
+
+static constexpr size_t kListBatchBytes = 64 * 1024;  // 每次拉取最多生成的 JSON 字节数
+
+FileListSource::FileListSource(long long limit, ContentEncoding encoding)
+              : limit_(limit),
+                rowCount_(0),
+                lastId_(0),
+                length_(0),
+                finished_(false),
+                writer_(&json_)
+{
+    // 首批数据申请到压缩预算才启用压缩
+    if (encoding != ContentEncoding::kIdentity && HttpCompressor::AcquireBudget(kListBatchBytes))
+    {
+        compressor_.reset(new StreamCompressor(encoding, HttpCompressor::GetOptions().level));
+        if (!compressor_->IsValid()) compressor_.reset();
+    }
+}
+
+// 将当前行写为文件信息对象：整数列按二进制接收，无需解析；字符串列直接引用语句的接收缓冲区
+void FileListSource::WriteRow(const MySqlStatement& stmt)
+{
+    unsigned long length;
+    const char* data;
+    long long fileId = stmt.GetInt(0);
+    bool isOwner = stmt.GetInt(6) == 1;  // 当前用户是否是文件所有者
+
+    writer_.BeginObject();
+    writer_.Key("id").Int(fileId);
+    data = stmt.GetData(1, &length);
+    writer_.Key("name").String(data, length);
+    data = stmt.GetData(2, &length);
+    writer_.Key("originalName").String(data, length);
+    writer_.Key("size").Uint(static_cast<uint64_t>(stmt.GetInt(3)));
+    data = stmt.GetData(4, &length);
+    writer_.Key("type").String(data, length);
+    data = stmt.GetData(5, &length);
+    writer_.Key("createdAt").String(data, length);
+    writer_.Key("isOwner").Bool(isOwner);
+
+    // 所有者的文件附带分享信息
+    if (!stmt.IsNull(7))
+    {
+        unsigned long typeLength;
+        const char* shareType = stmt.GetData(7, &typeLength);
+        writer_.Key("shareInfo").BeginObject();
+        writer_.Key("type").String(shareType, typeLength);
+        data = stmt.GetData(9, &length);
+        writer_.Key("shareCode").String(data, length);
+
+        // 如果是受保护分享，包含提取码
+        if (typeLength == 9 && memcmp(shareType, "protected", 9) == 0 && !stmt.IsNull(11))
+        {
+            data = stmt.GetData(11, &length);
+            writer_.Key("extractCode").String(data, length);
+        }
+        // 如果是用户分享，包含共享给的用户
+        if (typeLength == 4 && memcmp(shareType, "user", 4) == 0 && !stmt.IsNull(8) && !stmt.IsNull(12))
+        {
+            data = stmt.GetData(12, &length);
+            writer_.Key("sharedWithUsername").String(data, length);
+            writer_.Key("sharedWithId").Int(stmt.GetInt(8));
+        }
+        // 如果有过期时间，填充
+        if (!stmt.IsNull(10))
+        {
+            data = stmt.GetData(10, &length);
+            writer_.Key("expireTime").String(data, length);
+        }
+        writer_.EndObject();
+    }
+    writer_.EndObject();
+
+    lastId_ = fileId;
+    ++rowCount_;
+}
+
+// 读出全部结果行并生成 JSON
+bool FileListSource::Load(MySqlStatement* stmt)
+{
+    writer_.BeginObject();
+    writer_.Key("code").Int(0);
+    writer_.Key("message").String("Success");
+    writer_.Key("files").BeginArray();
+    while (stmt->Fetch()) WriteRow(*stmt);
+
+    // 取行失败（如网络中断）与结果读完都返回 false，需区分
+    if (stmt->Failed())
+    {
+        LOG_ERROR << "FileListSource fetch row failed";
+        return false;
+    }
+
+    writer_.EndArray();
+    // 本页已满时返回下一页的游标，否则表示没有更多数据
+    writer_.Key("nextAfter");
+    if (rowCount_ == limit_) writer_.Int(lastId_);
+    else writer_.Null();
+    writer_.EndObject();
+    length_ = static_cast<int64_t>(json_.ReadableBytes());
+    return true;
+}
+
+// 每次拉取输出一批 JSON（约 kListBatchBytes），压缩时同步刷出以便客户端及时解码
+StreamState FileListSource::Read(Buffer* output)
+{
+    if (finished_) return StreamState::kDone;
+
+    size_t n = std::min(kListBatchBytes, json_.ReadableBytes());
+    finished_ = n == json_.ReadableBytes();
+    if (compressor_)
+    {
+        HttpCompressor::AcquireBudget(n);  // 计入本线程压缩用量，已开始的流不能中途改为不压缩
+        compressor_->Write(json_.Peek(), n, output);
+        if (finished_) compressor_->Finish(output);
+        else compressor_->Flush(output);
+    }
+    else
+    {
+        output->Append(json_.Peek(), n);
+    }
+    json_.Retrieve(n);
+    return finished_ ? StreamState::kDone : StreamState::kMore;
+}
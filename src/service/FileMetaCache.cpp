@@ -0,0 +1,133 @@
+#include "FileMetaCache.h"
+
+// 按分享码查找未过期的分享记录
+const ShareMeta* FileMeta::FindShare(const std::string& shareCode, time_t now) const
+{
+    for (const ShareMeta& share : shares)
+    {
+        if (share.shareCode == shareCode && !share.IsExpired(now)) return &share;
+    }
+    return nullptr;
+}
+
+FileMetaCache::FileMetaCache(int ttl, size_t capacity)
+             : generation_(0),
+               ttl_(ttl),
+               capacity_(capacity),
+               hits_(0),
+               misses_(0)
+{}
+
+FileMetaCache::~FileMetaCache() {}
+
+// 删除缓存项及其索引
+void FileMetaCache::EraseLocked(std::unordered_map<std::string, Entry>::iterator it)
+{
+    const FileMeta& meta = *it->second.meta;
+    for (const ShareMeta& share : meta.shares)
+    {
+        auto code = shareCodeIndex_.find(share.shareCode);
+        if (code != shareCodeIndex_.end() && code->second == meta.filename) shareCodeIndex_.erase(code);
+    }
+    auto id = fileIdIndex_.find(meta.id);
+    if (id != fileIdIndex_.end() && id->second == meta.filename) fileIdIndex_.erase(id);
+
+    lru_.erase(it->second.lruPos);
+    entries_.erase(it);
+}
+
+// 按文件名查找并移到 LRU 链表头部
+FileMetaCache::MetaPtr FileMetaCache::GetLocked(const std::string& filename, time_t now)
+{
+    auto it = entries_.find(filename);
+    if (it == entries_.end()) return nullptr;
+
+    if (it->second.cacheExpire <= now)
+    {
+        EraseLocked(it);
+        return nullptr;
+    }
+
+    lru_.splice(lru_.begin(), lru_, it->second.lruPos);
+    return it->second.meta;
+}
+
+// 按服务器文件名查询
+FileMetaCache::MetaPtr FileMetaCache::Get(const std::string& filename)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    MetaPtr meta = GetLocked(filename, time(nullptr));
+    if (meta) ++hits_;
+    else ++misses_;
+    return meta;
+}
+
+// 按分享码查询
+FileMetaCache::MetaPtr FileMetaCache::GetByShareCode(const std::string& shareCode)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    MetaPtr meta;
+    auto code = shareCodeIndex_.find(shareCode);
+    if (code != shareCodeIndex_.end())
+    {
+        // 拷贝文件名：GetLocked 过期删除时会同时删除该索引项
+        std::string filename = code->second;
+        meta = GetLocked(filename, time(nullptr));
+    }
+    if (meta) ++hits_;
+    else ++misses_;
+    return meta;
+}
+
+uint64_t FileMetaCache::Generation()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return generation_;
+}
+
+// 写入查询结果
+void FileMetaCache::Put(const MetaPtr& meta, uint64_t generation)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (generation != generation_) return;
+
+    auto old = entries_.find(meta->filename);
+    if (old != entries_.end()) EraseLocked(old);
+
+    // 超出容量时淘汰最久未使用的文件
+    while (!lru_.empty() && entries_.size() >= capacity_)
+    {
+        EraseLocked(entries_.find(lru_.back()));
+    }
+
+    lru_.push_front(meta->filename);
+    Entry& entry = entries_[meta->filename];
+    entry.meta = meta;
+    entry.cacheExpire = time(nullptr) + ttl_;
+    entry.lruPos = lru_.begin();
+
+    for (const ShareMeta& share : meta->shares) shareCodeIndex_[share.shareCode] = meta->filename;
+    fileIdIndex_[meta->id] = meta->filename;
+}
+
+// 失效指定文件
+void FileMetaCache::InvalidateFile(const std::string& filename)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++generation_;
+    auto it = entries_.find(filename);
+    if (it != entries_.end()) EraseLocked(it);
+}
+
+// 按文件 ID 失效
+void FileMetaCache::InvalidateFileId(int fileId)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++generation_;
+    auto id = fileIdIndex_.find(fileId);
+    if (id == fileIdIndex_.end()) return;
+
+    auto it = entries_.find(id->second);
+    if (it != entries_.end()) EraseLocked(it);
+    else fileIdIndex_.erase(id);
+}
@@ -0,0 +1,327 @@
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+#include <fstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <zlib.h>
+#include <nlohmann/json.hpp>
+
+#include "FileNameJournal.h"
+#include "Log.h"
+
+static constexpr uint8_t kRecordPut = 1;                  // 写入记录
+static constexpr uint8_t kRecordDelete = 2;               // 删除记录
+static constexpr size_t kRecordHeaderSize = 13;           // crc(4) + 类型(1) + 键长度(4) + 值长度(4)
+static constexpr uint64_t kMinCompactRecords = 100000;    // 记录数少于该值时不压缩
+static constexpr size_t kSnapshotBatchBytes = 1024 * 1024; // 快照每批写入的字节数
+static constexpr size_t kAverageRecordSize = 64;          // 预估的平均记录长度（32 位十六进制文件名 + 原始文件名）
+
+FileNameJournal::FileNameJournal(const std::string& path)
+               : path_(path),
+                 fd_(-1),
+                 records_(0),
+                 compacting_(false),
+                 appends_(0),
+                 compactions_(0)
+{}
+
+FileNameJournal::~FileNameJournal()
+{
+    if (fd_ >= 0) close(fd_);
+}
+
+// 编码一条记录
+std::string FileNameJournal::Encode(uint8_t type, const std::string& key, const std::string& value)
+{
+    uint32_t keyLen = static_cast<uint32_t>(key.size());
+    uint32_t valueLen = static_cast<uint32_t>(value.size());
+
+    std::string record(kRecordHeaderSize + key.size() + value.size(), '\0');
+    char* p = &record[0];
+    p[4] = static_cast<char>(type);
+    memcpy(p + 5, &keyLen, 4);
+    memcpy(p + 9, &valueLen, 4);
+    memcpy(p + kRecordHeaderSize, key.data(), key.size());
+    memcpy(p + kRecordHeaderSize + key.size(), value.data(), value.size());
+
+    uint32_t crc = static_cast<uint32_t>(crc32(0L, reinterpret_cast<const Bytef*>(p + 4), 
+                                               static_cast<uInt>(record.size() - 4)));
+    memcpy(p, &crc, 4);
+    return record;
+}
+
+// 将数据完整写入 fd
+bool FileNameJournal::WriteAll(int fd, const char* data, size_t len)
+{
+    while (len > 0)
+    {
+        ssize_t n = write(fd, data, len);
+        if (n < 0)
+        {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// 打开日志并重放
+bool FileNameJournal::Open()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!Replay()) return false;
+
+    fd_ = open(path_.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd_ < 0)
+    {
+        LOG_ERROR << "FileNameJournal: open " << path_ << " failed: " << strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+// 重放日志
+bool FileNameJournal::Replay()
+{
+    int fd = open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return errno == ENOENT;  // 文件不存在视为空日志
+
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    // 一次读入整个日志后顺序解析
+    std::string data(static_cast<size_t>(st.st_size), '\0');
+    size_t total = 0;
+    while (total < data.size())
+    {
+        ssize_t n = read(fd, &data[total], data.size() - total);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        total += static_cast<size_t>(n);
+    }
+    close(fd);
+    data.resize(total);
+
+    // 按平均记录长度预估条目数，避免重放过程中反复扩容
+    entries_.reserve(data.size() / kAverageRecordSize);
+
+    size_t offset = 0;
+    while (offset + kRecordHeaderSize <= data.size())
+    {
+        const char* p = data.data() + offset;
+        uint32_t crc, keyLen, valueLen;
+        memcpy(&crc, p, 4);
+        memcpy(&keyLen, p + 5, 4);
+        memcpy(&valueLen, p + 9, 4);
+
+        size_t recordLen = kRecordHeaderSize + static_cast<size_t>(keyLen) + valueLen;
+        if (offset + recordLen > data.size()) break;
+        if (crc != static_cast<uint32_t>(crc32(0L, reinterpret_cast<const Bytef*>(p + 4), 
+                                               static_cast<uInt>(recordLen - 4)))) break;
+
+        std::string key(p + kRecordHeaderSize, keyLen);
+        if (p[4] == kRecordPut) entries_[key].assign(p + kRecordHeaderSize + keyLen, valueLen);
+        else entries_.erase(key);
+
+        ++records_;
+        offset += recordLen;
+    }
+
+    // 截断末尾不完整或损坏的记录，之后的追加从有效位置开始
+    if (offset < data.size())
+    {
+        LOG_WARN << "FileNameJournal: truncating " << (data.size() - offset) << " trailing bytes of " << path_;
+        if (truncate(path_.c_str(), static_cast<off_t>(offset)) != 0)
+        {
+            LOG_ERROR << "FileNameJournal: truncate " << path_ << " failed: " << strerror(errno);
+            return false;
+        }
+    }
+    return true;
+}
+
+// 导入旧版 JSON 映射文件
+size_t FileNameJournal::ImportJson(const std::string& jsonPath)
+{
+    struct stat st;
+    if (stat(jsonPath.c_str(), &st) != 0) return 0;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!entries_.empty()) return 0;  // 已有日志数据，旧文件不再导入
+
+        try
+        {
+            std::ifstream file(jsonPath);
+            nlohmann::json mapping = nlohmann::json::parse(file);
+            for (auto it = mapping.begin(); it != mapping.end(); ++it)
+            {
+                entries_[it.key()] = it.value().get<std::string>();
+            }
+        }
+        catch (const std::exception& e)
+        {
+            LOG_ERROR << "FileNameJournal: failed to import " << jsonPath << ": " << e.what();
+            entries_.clear();
+            return 0;
+        }
+    }
+
+    // 导入的条目以快照形式一次写入
+    size_t imported = Size();
+    if (!Compact()) return 0;
+    if (rename(jsonPath.c_str(), (jsonPath + ".migrated").c_str()) != 0)
+    {
+        LOG_WARN << "FileNameJournal: rename " << jsonPath << " failed: " << strerror(errno);
+    }
+    return imported;
+}
+
+// 追加一条记录
+void FileNameJournal::AppendLocked(const std::string& record)
+{
+    if (fd_ < 0 || !WriteAll(fd_, record.data(), record.size()))
+    {
+        LOG_ERROR << "FileNameJournal: append to " << path_ << " failed: " << strerror(errno);
+        return;
+    }
+    if (compacting_) pendingRecords_.push_back(record);
+    ++records_;
+    ++appends_;
+}
+
+// 写入或更新映射
+void FileNameJournal::Put(const std::string& serverFileName, const std::string& originalFileName)
+{
+    std::string record = Encode(kRecordPut, serverFileName, originalFileName);
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_[serverFileName] = originalFileName;
+    AppendLocked(record);
+}
+
+// 删除映射
+void FileNameJournal::Erase(const std::string& serverFileName)
+{
+    std::string record = Encode(kRecordDelete, serverFileName, std::string());
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (entries_.erase(serverFileName) == 0) return;
+    AppendLocked(record);
+}
+
+// 批量删除映射
+void FileNameJournal::EraseBatch(const std::vector<std::string>& serverFileNames)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::string> records;
+    std::string data;
+    for (const std::string& name : serverFileNames)
+    {
+        if (entries_.erase(name) == 0) continue;
+        records.push_back(Encode(kRecordDelete, name, std::string()));
+        data += records.back();
+    }
+    if (records.empty()) return;
+
+    if (fd_ < 0 || !WriteAll(fd_, data.data(), data.size()))
+    {
+        LOG_ERROR << "FileNameJournal: append to " << path_ << " failed: " << strerror(errno);
+        return;
+    }
+    if (compacting_) pendingRecords_.insert(pendingRecords_.end(), records.begin(), records.end());
+    records_ += records.size();
+    appends_ += records.size();
+}
+
+// 查询原始文件名
+bool FileNameJournal::Get(const std::string& serverFileName, std::string* originalFileName)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(serverFileName);
+    if (it == entries_.end()) return false;
+    *originalFileName = it->second;
+    return true;
+}
+
+size_t FileNameJournal::Size()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+// 是否需要压缩
+bool FileNameJournal::NeedsCompaction()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return !compacting_ && records_ >= kMinCompactRecords && records_ > 2 * entries_.size();
+}
+
+// 压缩：在锁外写快照，切换时补写压缩期间的新记录
+bool FileNameJournal::Compact()
+{
+    std::unordered_map<std::string, std::string> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (compacting_) return false;
+        compacting_ = true;
+        pendingRecords_.clear();
+        snapshot = entries_;
+    }
+
+    std::string tmpPath = path_ + ".compact";
+    int tmpFd = open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+    bool ok = tmpFd >= 0;
+
+    // 1. 锁外写入快照，按批合并写入
+    std::string batch;
+    for (auto it = snapshot.begin(); ok && it != snapshot.end(); ++it)
+    {
+        batch += Encode(kRecordPut, it->first, it->second);
+        if (batch.size() >= kSnapshotBatchBytes)
+        {
+            ok = WriteAll(tmpFd, batch.data(), batch.size());
+            batch.clear();
+        }
+    }
+    if (ok && !batch.empty()) ok = WriteAll(tmpFd, batch.data(), batch.size());
+
+    // 2. 补写压缩期间的记录，落盘后原子替换旧日志
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; ok && i < pendingRecords_.size(); ++i)
+    {
+        ok = WriteAll(tmpFd, pendingRecords_[i].data(), pendingRecords_[i].size());
+    }
+    if (ok) ok = fsync(tmpFd) == 0 && rename(tmpPath.c_str(), path_.c_str()) == 0;
+
+    if (!ok)
+    {
+        LOG_ERROR << "FileNameJournal: compact " << path_ << " failed: " << strerror(errno);
+        if (tmpFd >= 0) close(tmpFd);
+        unlink(tmpPath.c_str());
+    }
+    else
+    {
+        if (fd_ >= 0) close(fd_);
+        fd_ = tmpFd;
+        records_ = snapshot.size() + pendingRecords_.size();
+        ++compactions_;
+        LOG_INFO << "FileNameJournal: compacted " << path_ << " to " << records_ << " records";
+    }
+    compacting_ = false;
+    pendingRecords_.clear();
+    return ok;
+}
+
+// 将已追加的记录刷到磁盘
+void FileNameJournal::Sync()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (fd_ >= 0) fdatasync(fd_);
+}
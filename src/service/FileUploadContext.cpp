@@ -1,54 +1,83 @@
 #include "FileUploadContext.h"
 #include "Log.h"
 
-FileUploadContext::FileUploadContext(const std::string& fileName, const std::string& originalFileName)
+// 超过该大小的上传以 O_DIRECT 写入，避免一次性写入的大文件占满页缓存
+static const uint64_t kDirectIoThreshold = 512ULL * 1024 * 1024;
+
+FileUploadContext::FileUploadContext(const std::string& fileName, const std::string& originalFileName,
+                                     dev_t device, uint64_t expectedSize)
                 : fileName_(fileName), 
                   originalFileName_(originalFileName), 
+                  writer_(fileName),
+                  device_(device),
+                  expectedSize_(expectedSize),
+                  staged_(std::make_shared<std::string>()),
+                  inflightBytes_(0),
+                  failed_(false),
                   totalBytes_(0),
                   state_(State::kExpectHeaders), 
                   boundary_("")
+{}
+
+// 创建文件并预分配空间（磁盘线程）：预分配在不支持 fallocate 的文件系统上会退化为逐块写零，不能在事件循环中执行
+bool FileUploadContext::Open()
 {
     // 确保目录存在
-    fs::path filePath(fileName_);
-    fs::path dir = filePath.parent_path();
-    if (!dir.empty() && !fs::exists(dir)) {
-        fs::create_directories(dir);
-    }
+    std::error_code ec;
+    fs::path dir = fs::path(fileName_).parent_path();
+    if (!dir.empty() && !fs::exists(dir, ec)) fs::create_directories(dir, ec);
 
-    // 打开文件
-    file_.open(fileName_, std::ios::binary | std::ios::out);
-    if (!file_.is_open()) {
-        LOG_ERROR << "Failed to open file: " << fileName;
-        throw std::runtime_error("Failed to open file: " + fileName);
+    // 打开文件并预分配空间
+    if (!writer_.Open(expectedSize_, expectedSize_ >= kDirectIoThreshold)) 
+    {
+        LOG_ERROR << "Failed to open file: " << fileName_;
+        failed_ = true;
+        return false;
     }
-    LOG_INFO << "Creating file: " << fileName << ", original name: " << originalFileName;
+    LOG_INFO << "Creating file: " << fileName_ << ", original name: " << originalFileName_
+             << (writer_.IsDirect() ? " (O_DIRECT)" : "");
+    return true;
 }
 
-// 析构函数：关闭文件句柄
-FileUploadContext::~FileUploadContext() 
+// 暂存一段文件数据
+void FileUploadContext::WriteData(const char* data, size_t len) 
 {
-    if (file_.is_open()) 
-    {
-        file_.close();
-    }
+    staged_->append(data, len);
+    totalBytes_ += len; // 记录总写入字节数
 }
 
-// 写入数据到文件
-void FileUploadContext::WriteData(const char* data, size_t len) 
+// 取出暂存的数据
+std::shared_ptr<std::string> FileUploadContext::TakeStaged()
 {
-    if (!file_.is_open()) 
-    {
-        throw std::runtime_error("File is not open: " + fileName_);
-    }
+    std::shared_ptr<std::string> data = staged_;
+    staged_ = std::make_shared<std::string>();
+    return data;
+}
 
-    // 将数据写入文件
-    if (!file_.write(data, len)) 
+// 写入数据到文件（磁盘线程）
+void FileUploadContext::WriteToDisk(const std::string& data)
+{
+    if (failed_) return;
+
+    // 将数据写入文件（先进入写缓冲区，满一块才写盘）
+    if (!writer_.Write(data.data(), data.size())) 
     {
-        throw std::runtime_error("Failed to write to file: " + fileName_);
+        LOG_ERROR << "Failed to write to file: " << fileName_;
+        failed_ = true;
+        return;
     }
+    hasher_.Update(data.data(), data.size());  // 更新内容摘要
+    checksum_.Update(data.data(), data.size()); // 更新分块校验和
+}
 
-    file_.flush();  // 刷新缓冲区到磁盘
-    totalBytes_ += len; // 记录总写入字节数
+// 写出缓冲的数据并关闭文件
+bool FileUploadContext::Finish()
+{
+    if (!writer_.IsOpen()) return !failed_;
+    checksum_.Finish();
+    bool ok = writer_.Close() && !failed_;
+    LOG_INFO << "Closed file: " << fileName_ << ", " << totalBytes_ << " bytes in " << writer_.GetFlushes() << " writes";
+    return ok;
 }
 
 // 获取已写入总字节数
@@ -60,6 +89,13 @@ const std::string& FileUploadContext::GetFileName() const { return fileName_; }
 // 获取客户端上传的原始文件名
 const std::string& FileUploadContext::GetOriginalFileName() const { return originalFileName_; }
 
+// 获取内容摘要
+const std::string& FileUploadContext::GetContentHash()
+{
+    if (contentHash_.empty()) contentHash_ = hasher_.FinalHex();
+    return contentHash_;
+}
+
 // 设置 multipart 边界字符串
 void FileUploadContext::SetBoundary(const std::string& boundary) { boundary_ = boundary; }
 // 获取 multipart 边界
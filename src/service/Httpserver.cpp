@@ -1,14 +1,94 @@
 #include <sstream> 
 #include <functional>
 #include <mutex>
+#include <algorithm>
+#include <chrono>
 #include <nlohmann/json.hpp>
 
 #include "HttpServer.h"
+#include "HttpValidator.h"
+#include "HttpCompressor.h"
+#include "HttpRange.h"
+#include "FileListSource.h"
 #include "Log.h"  // 引入 Log 头文件
 #include "Public.h"
 
 using json = nlohmann::json; 
 
+static constexpr int kSessionLifetime = 30 * 60;  // 会话有效期（秒），登录与滑动刷新写入的 expire_time 都由它计算
+static constexpr int kSessionRefreshThreshold = 25 * 60;  // 剩余有效期低于该值时才刷新，同一会话约每 5 分钟写一次
+static constexpr int kSessionFlushIntervalMs = 5000;      // 会话刷新批量写回间隔
+static constexpr int kJournalCompactIntervalMs = 60 * 1000; // 文件名映射日志压缩检查间隔
+static constexpr long long kMaxListLimit = 1000;          // 文件列表单页最多返回的文件数
+static constexpr int kUploadSessionIdleTimeout = 24 * 3600; // 分片上传会话无写入的最长保留时间（秒）
+static constexpr int kUploadSessionSaveIntervalMs = 60 * 1000; // 分片上传会话持久化与过期清理间隔
+static constexpr uint64_t kUploadPartSize = 8 * 1024 * 1024;  // 建议客户端使用的分片大小
+static constexpr size_t kHashReadChunk = 1024 * 1024;         // 提交时计算摘要的读取块大小
+static constexpr uint64_t kMaxBufferedBody = 8 * 1024 * 1024; // 非流式请求的请求体上限（整体缓存在内存中）
+static constexpr uint64_t kDiskBacklogHigh = 16 * 1024 * 1024; // 单个上传连接写盘积压超过该值时暂停读取
+static constexpr int kLayoutMigrateIntervalMs = 1000;         // 平铺文件迁移的批次间隔
+static constexpr size_t kLayoutMigrateBatch = 200;             // 每批迁移的文件数
+static constexpr uint64_t kDiskBacklogLow = 4 * 1024 * 1024;   // 积压回落到该值以下时恢复读取
+static constexpr uint64_t kDefaultStorageQuota = 10ULL * 1024 * 1024 * 1024; // users.storage_quota 为 NULL 时的用户配额
+static constexpr int kQuotaReconcileIntervalMs = 10 * 60 * 1000; // 按 files 表校正已用空间的间隔
+static constexpr int kShareNegativeTtl = 30;                   // 不存在的分享码在负缓存中保留的时间（秒）
+static constexpr size_t kShareNegativeCapacity = 65536;        // 负缓存最多条目数
+static constexpr int kShareFilterMaxAge = 3600;                // 分享码 Bloom 过滤器的最长使用时间（秒）
+static constexpr int kShareFilterCheckIntervalMs = 60 * 1000;  // 检查是否需要重建分享码过滤器的间隔
+static constexpr size_t kUserSearchLimit = 10;                 // 用户搜索最多返回的用户数
+static constexpr int kScrubIntervalMs = 100;                   // blob 巡检的调度间隔，每次按速率分配读取字节数
+static constexpr uint64_t kDefaultScrubRate = 8 * 1024 * 1024; // blob 巡检的默认读取速率（字节/秒）
+static constexpr size_t kBatchMaxItems = 1000;                 // 批量删除/分享单次最多处理的文件数
+static constexpr int kCompressionStatsIntervalMs = 60 * 1000;  // 输出响应压缩统计的间隔
+
+// 文件名映射日志路径：uploads/filename_mapping.json -> uploads/filename_mapping.journal
+static std::string JournalPathFor(const std::string& mapFile)
+{
+    static const std::string kJsonSuffix = ".json";
+    if (mapFile.size() > kJsonSuffix.size() && 
+        mapFile.compare(mapFile.size() - kJsonSuffix.size(), kJsonSuffix.size(), kJsonSuffix) == 0)
+    {
+        return mapFile.substr(0, mapFile.size() - kJsonSuffix.size()) + ".journal";
+    }
+    return mapFile + ".journal";
+}
+
+// 整数 ID 列表拼接为 SQL IN 子句的内容：1, 2, 3
+static std::string SqlIdList(const std::vector<int>& ids)
+{
+    std::string list;
+    for (int id : ids)
+    {
+        if (!list.empty()) list += ", ";
+        list += std::to_string(id);
+    }
+    return list;
+}
+
+// 从分片上传 URL（/upload/sessions/<id>[/...]）中取出会话 ID
+static std::string UploadIdFromUrl(const std::string& url)
+{
+    static const std::string kPrefix = "/upload/sessions/";
+    if (url.compare(0, kPrefix.size(), kPrefix) != 0) return "";
+    size_t end = url.find('/', kPrefix.size());
+    return url.substr(kPrefix.size(), end == std::string::npos ? std::string::npos : end - kPrefix.size());
+}
+
+// 是否为需要边接收边处理请求体的上传请求（普通上传与分片上传的分片）
+static bool IsStreamingUpload(const HttpRequest& request)
+{
+    if (request.GetMethod() == Method::kPost && request.GetUrl() == "/upload") return true;
+    return request.GetMethod() == Method::kPut && !UploadIdFromUrl(request.GetUrl()).empty();
+}
+
+// 静态资源目录：当前源文件所在目录（编译期绝对路径）
+static std::string GetAssetDir()
+{
+    std::string currentDir = __FILE__;
+    std::string::size_type pos = currentDir.find_last_of('/');
+    return (pos != std::string::npos) ? currentDir.substr(0, pos) : ".";
+}
+
 // 构造函数，初始化 TcpServer、线程池及日志
 HttpServer::HttpServer(const std::string& ip, 
                        uint16_t port, 
@@ -19,7 +99,26 @@ HttpServer::HttpServer(const std::string& ip,
            :tcpServer_(ip, port, subThreadNum),
             threadPool_(workThreadNum, "HttpWorks"),
             uploadDir_(uploadDir),
-            mapFile_(mapFile)
+            mapFile_(mapFile),
+            fileNameJournal_(JournalPathFor(mapFile)),
+            uploadLayout_(uploadDir),
+            blobStore_(uploadDir),
+            scrubber_(blobStore_.BlobDir()),
+            scrubRate_(kDefaultScrubRate),
+            scrubInFlight_(false),
+            verifyDownloads_(false),
+            uploadSessions_(uploadDir, kUploadSessionIdleTimeout),
+            maxUploadSize_(4ULL * 1024 * 1024 * 1024),
+            staticCache_(GetAssetDir()),
+            sessionCache_(60, 4096),
+            sessionRefresher_(kSessionLifetime),
+            fileMetaCache_(300, 10000),
+            quota_(kDefaultStorageQuota),
+            shareCodes_(kShareNegativeTtl, kShareNegativeCapacity, kShareFilterMaxAge),
+            backgroundTasks_("HttpBackground"),
+            lastCompressionIn_(0),
+            diskIo_("DiskIo"),
+            uploadDevice_(0)
 {
     // 设置 TcpServer 各种事件回调绑定，使用 std::bind 绑定成员函数及 this 指针
     tcpServer_.SetNewConnectionCB(std::bind(&HttpServer::HandleNewConnection, this, std::placeholders::_1));
@@ -35,12 +134,74 @@ HttpServer::HttpServer(const std::string& ip,
     {
         fs::create_directory(uploadDir_);
     }
+    uploadDevice_ = DiskIoExecutor::DeviceOf(uploadDir_);
 
     //数据库连接池初始化
     mysqlPool_ = ConnectionPool::GetConnectionPool();
+    // 构建分享码过滤器与用户名搜索索引
+    shareCodes_.Rebuild(mysqlPool_);
+    userIndex_.Load(mysqlPool_);
+
+    // 后台周期任务：批量写回会话过期时间
+    backgroundTasks_.AddTask("session-refresh", kSessionFlushIntervalMs, [this]() {
+        sessionRefresher_.Flush(mysqlPool_);
+    });
+    // 后台周期任务：失效记录过多时压缩文件名映射日志
+    backgroundTasks_.AddTask("filename-journal-compact", kJournalCompactIntervalMs, [this]() {
+        if (fileNameJournal_.NeedsCompaction()) fileNameJournal_.Compact();
+    });
+    // 后台周期任务：将旧版平铺的上传文件逐批迁移到分层目录，迁移在上传目录的磁盘队列中执行，与删除文件串行
+    backgroundTasks_.AddTask("upload-layout-migrate", kLayoutMigrateIntervalMs, [this]() {
+        if (uploadLayout_.MigrationDone()) return;
+        diskIo_.Submit(uploadDevice_, [this]() { uploadLayout_.MigrateStep(kLayoutMigrateBatch); });
+    });
+    // 后台周期任务：删除的分享过多、容量不足或使用时间过长时重建分享码过滤器
+    backgroundTasks_.AddTask("share-filter-rebuild", kShareFilterCheckIntervalMs, [this]() {
+        if (shareCodes_.NeedsRebuild()) shareCodes_.Rebuild(mysqlPool_);
+    });
+    // 后台周期任务：按 files 表校正用户已用空间，修正增量维护中因异常退出等产生的偏差
+    backgroundTasks_.AddTask("quota-reconcile", kQuotaReconcileIntervalMs, [this]() {
+        quota_.Reconcile(mysqlPool_);
+    });
+    // 后台周期任务：按配置速率巡检 blob 完整性；上传目录的磁盘队列中有前台任务时本次让出，不与上传、下载争抢磁盘
+    backgroundTasks_.AddTask("blob-scrub", kScrubIntervalMs, [this]() {
+        uint64_t budget = scrubRate_ * kScrubIntervalMs / 1000;
+        if (budget == 0 || scrubInFlight_ || diskIo_.Pending(uploadDevice_) > 0) return;
+        scrubInFlight_ = true;
+        diskIo_.Submit(uploadDevice_, [this, budget]() {
+            scrubber_.Step(budget);
+            scrubInFlight_ = false;
+        });
+    });
+    // 后台周期任务：持久化分片上传进度，清理长时间无写入的上传会话
+    backgroundTasks_.AddTask("upload-session-maintenance", kUploadSessionSaveIntervalMs, [this]() {
+        uploadSessions_.SaveAll();
+        size_t reaped = uploadSessions_.ReapIdle();
+        if (reaped > 0) LOG_INFO << "HttpServer: 清理过期上传会话 " << reaped << " 个";
+    });
+    // 后台周期任务：输出响应压缩累计字节数与压缩率，期间没有新的压缩输出时跳过
+    backgroundTasks_.AddTask("compression-stats", kCompressionStatsIntervalMs, [this]() {
+        uint64_t totalIn = HttpCompressor::TotalIn();
+        if (totalIn == lastCompressionIn_) return;
+        lastCompressionIn_ = totalIn;
+        LOG_INFO << "HttpServer: 响应压缩 " << totalIn << " -> " << HttpCompressor::TotalOut()
+                 << " 字节，压缩率 " << HttpCompressor::CompressionRatio();
+    });
+
+    // 预渲染固定错误响应
+    InitCannedResponses();
+
+    // 预加载静态页面与图标
+    staticCache_.Register("/index.html", "index.html", "text/html; charset=utf-8");
+    staticCache_.Register("/register.html", "register.html", "text/html; charset=utf-8");
+    staticCache_.Register("/share.html", "share.html", "text/html; charset=utf-8");
+    staticCache_.Register("/favicon.ico", "favicon.ico", "image/x-icon");
 
     // 加载文件名映射
     LoadFileNameMap();
+
+    // 恢复上次运行时未完成的分片上传
+    LOG_INFO << "HttpServer: 恢复分片上传会话 " << uploadSessions_.Load() << " 个";
         
     // 初始化路由表
     InitRoutes();
@@ -55,6 +216,7 @@ HttpServer::~HttpServer()
 // 启动 TCP 服务器
 void HttpServer::Start() 
 {
+    backgroundTasks_.Start();
     tcpServer_.Start();
 }
 
@@ -62,10 +224,35 @@ void HttpServer::Start()
 void HttpServer::StopService() 
 {
     threadPool_.StopThread();
-    // 保存映射文件
-    SaveFileNameMap();
+    // 先停止后台任务（巡检、平铺文件迁移等会向磁盘执行器提交任务），再执行完已提交的磁盘任务（上传数据写盘等）
+    backgroundTasks_.Stop();
+    diskIo_.Stop();
+    // 文件名映射日志落盘
+    fileNameJournal_.Sync();
+    // 保存分片上传进度，重启后可继续上传
+    uploadSessions_.SaveAll();
     // 使用 Log 输出日志
     LOG_INFO << "HttpServer: 工作线程已停止。";
+    LOG_INFO << "HttpServer: 会话缓存命中 " << sessionCache_.Hits() << " 次，未命中 " << sessionCache_.Misses() << " 次";
+    LOG_INFO << "HttpServer: 文件元数据缓存命中 " << fileMetaCache_.Hits() << " 次，未命中 " << fileMetaCache_.Misses() << " 次";
+    LOG_INFO << "HttpServer: 响应压缩 " << HttpCompressor::TotalIn() << " -> " << HttpCompressor::TotalOut()
+             << " 字节，压缩率 " << HttpCompressor::CompressionRatio();
+
+    // 写回尚未刷新的会话
+    sessionRefresher_.Flush(mysqlPool_);
+    LOG_INFO << "HttpServer: 会话刷新登记 " << sessionRefresher_.Requested() << " 次，合并 "
+             << sessionRefresher_.Coalesced() << " 次，写回 " << sessionRefresher_.Flushed() << " 个会话，共 "
+             << sessionRefresher_.Batches() << " 批";
+    LOG_INFO << "HttpServer: 磁盘 I/O 完成 " << diskIo_.Completed() << " 个任务，最大排队 " << diskIo_.MaxQueueDepth();
+    LOG_INFO << "HttpServer: 去重存储新建 " << blobStore_.Stored() << " 个 blob，命中 " << blobStore_.Deduplicated()
+             << " 次，节省 " << blobStore_.SavedBytes() << " 字节，回收 " << blobStore_.Released() << " 个 blob";
+    LOG_INFO << "HttpServer: 完整性巡检 " << scrubber_.Passes() << " 轮，校验 " << scrubber_.ScannedBlobs() << " 个 blob / "
+             << scrubber_.ScannedBytes() << " 字节，损坏 " << scrubber_.Corrupted() << " 个，补写校验和 "
+             << scrubber_.Adopted() << " 个";
+    LOG_INFO << "HttpServer: 配额拒绝上传 " << quota_.Rejected() << " 次，加载用量 " << quota_.Loads()
+             << " 次，校正 " << quota_.Corrected() << " 个用户";
+    LOG_INFO << "HttpServer: 分享码过滤 Bloom 拒绝 " << shareCodes_.Filtered() << " 次，负缓存拒绝 "
+             << shareCodes_.NegativeHits() << " 次，放行后不存在 " << shareCodes_.Misses() << " 次";
 
     // 清理数据库连接池
     mysqlPool_->Stop();  // 清空连接池中的所有数据库连接
@@ -138,22 +325,78 @@ std::string HttpServer::GenerateHttpResponse(const std::string& message,
     return response.ResponseMessage();
 }
 
+// 预渲染常用的固定错误响应，发送时只需插入缓存的 Date 头
+void HttpServer::InitCannedResponses()
+{
+    const std::vector<std::pair<HttpStatusCode, std::string>> cannedList = {
+        {HttpStatusCode::k400BadRequest, "请求解析失败"},
+        {HttpStatusCode::k400BadRequest, "Missing fileName"},
+        {HttpStatusCode::k400BadRequest, "Missing share code"},
+        {HttpStatusCode::k401Unauthorized, "未登录或会话已过期"},
+        {HttpStatusCode::k401Unauthorized, "请先登录"},
+        {HttpStatusCode::k403Forbidden, "您没有权限访问此文件"},
+        {HttpStatusCode::k403Forbidden, "无权限访问此文件"},
+        {HttpStatusCode::k403Forbidden, "需要正确的提取码"},
+        {HttpStatusCode::k404NotFound, "Not Found"},
+        {HttpStatusCode::k404NotFound, "File not found"},
+        {HttpStatusCode::k404NotFound, "分享链接已失效或不存在"},
+        {HttpStatusCode::k404NotFound, "Share not found or expired"},
+        {HttpStatusCode::k413PayloadTooLarge, "文件大小超出限制"},
+        {HttpStatusCode::k413PayloadTooLarge, "存储空间不足"},
+        {HttpStatusCode::k500InternalServerError, "Internal Server Error"},
+    };
+
+    for (const auto& item : cannedList)
+    {
+        HttpResponse response(true);
+        json body = {
+                {"code", static_cast<int>(item.first)},
+                {"message", item.second}
+            };
+        response.SetStatusCode(item.first);
+        response.SetContentType("application/json");
+        response.AddHeader("Connection", "close");
+        response.SetBody(body.dump());
+
+        cannedResponses_[std::make_pair(static_cast<int>(item.first), item.second)] = response.Prerender();
+    }
+}
+
+// 将响应直接序列化到连接的发送缓冲区，流式响应体随后由连接按需拉取
+void HttpServer::SendResponse(const spConnection &conn, HttpResponse* response)
+{
+    conn->SendToBuffer([response](Buffer* output) { response->AppendToBuffer(output); });
+    if (response->GetBodySource())
+    {
+        conn->SendStream(BodySource::MakeProducer(response->GetBodySource()));
+    }
+}
+
 // 发送 400 Bad Request 响应
 void HttpServer::SendBadRequestResponse(spConnection conn, const HttpStatusCode code, const std::string& message) 
 {
-    HttpResponse response(true);
+    // 固定错误响应直接使用预渲染报文（构造完成后只读，无需加锁）
+    auto it = cannedResponses_.find(std::make_pair(static_cast<int>(code), message));
+    if (it != cannedResponses_.end())
+    {
+        const PrerenderedResponse& canned = it->second;
+        conn->SendToBuffer([&canned](Buffer* output) { HttpResponse::AppendPrerendered(canned, output); });
+    }
+    else
+    {
+        HttpResponse response(true);
 
-    json body = {
-            {"code", static_cast<int>(code)},
-            {"message", message}
-        };
-    response.SetStatusCode(code);
-    response.SetContentType("application/json");
-    response.AddHeader("Connection", "close");
-    response.SetBody(body.dump());
+        json body = {
+                {"code", static_cast<int>(code)},
+                {"message", message}
+            };
+        response.SetStatusCode(code);
+        response.SetContentType("application/json");
+        response.AddHeader("Connection", "close");
+        response.SetBody(body.dump());
 
-    const std::string& resp = response.ResponseMessage();
-    conn->SendData(resp.data(), resp.size());
+        SendResponse(conn, &response);
+    }
 
     // 使用 Log 输出日志
     LOG_ERROR << "HttpServer: 请求解析失败，返回 400";
@@ -182,10 +425,23 @@ void HttpServer::OnMessage(spConnection conn, std::string &message)
         return;
     }
 
+    // 预检查未通过的请求：丢弃剩余请求体，等待连接关闭
+    if (ctx->IsRejected()) return;
+
     // 多次解析：每次传入当前 buffer
     HttpRequestParseState state = ctx->ParseRequest(message.data(), static_cast<int>(message.size()));
     HttpRequest* request = ctx->GetRequest();
 
+    // 请求头已完整（请求体可能尚未到达）：先仅凭请求头做预检查
+    if ((state == HttpRequestParseState::BODY ||
+         state == HttpRequestParseState::kHeadersComplete ||
+         state == HttpRequestParseState::COMPLETE) && !ctx->IsHeadersChecked())
+    {
+        bool accepted = PrecheckRequest(conn, *request, state == HttpRequestParseState::BODY);
+        ctx->SetHeadersChecked(accepted);
+        if (!accepted) return;
+    }
+
     // 判断解析结果状态
     switch (state)
     {
@@ -194,7 +450,7 @@ void HttpServer::OnMessage(spConnection conn, std::string &message)
             return;
 
         case HttpRequestParseState::kHeadersComplete:
-            if (request->GetMethod() == Method::kPost && request->GetUrl() == "/upload") 
+            if (IsStreamingUpload(*request)) 
             {
                 HttpResponse response(false);  // 不关闭连接
                 OnRequest(conn, *request, &response);
@@ -218,6 +474,99 @@ void HttpServer::OnMessage(spConnection conn, std::string &message)
     }
 }
 
+// 仅凭请求头判断请求能否被接受，避免未登录或超限的上传先传完大量数据再被拒绝
+// 上传请求检查会话与 Content-Length 上限，分片请求检查上传会话归属与分片范围；客户端携带 Expect: 100-continue 且请求体尚未发送时回复 100 Continue
+bool HttpServer::PrecheckRequest(const spConnection &conn, HttpRequest &request, bool bodyPending)
+{
+    if (request.GetMethod() == Method::kPost && request.GetUrl() == "/upload")
+    {
+        // 1. 会话校验
+        std::string sessionId = ParseCookie(request.GetHeader("Cookie"), "session_id");
+        int userId = 0;
+        std::string username;
+        if (!ValidateSession(sessionId, userId, username))
+        {
+            LOG_WARN << "Upload rejected before body: invalid session, ip=" << conn->GetIP();
+            RejectRequest(conn, HttpStatusCode::k401Unauthorized, "未登录或会话已过期");
+            return false;
+        }
+
+        // 2. 请求体大小限制
+        uint64_t contentLength = strtoull(request.GetHeader("Content-Length").c_str(), nullptr, 10);
+        if (contentLength > maxUploadSize_)
+        {
+            LOG_WARN << "Upload rejected before body: Content-Length " << contentLength
+                     << " exceeds limit " << maxUploadSize_ << ", user=" << username;
+            RejectRequest(conn, HttpStatusCode::k413PayloadTooLarge, "文件大小超出限制");
+            return false;
+        }
+
+        // 3. 存储配额：按 Content-Length 预留空间（包含 multipart 边界，略大于文件本身，偏保守），
+        //    同一用户的并发上传各自预留，合计不会超出配额；预留随请求交给上传上下文，上传结束或连接关闭时归还
+        uint64_t used = 0, quota = 0;
+        std::shared_ptr<QuotaReservation> reservation = quota_.TryReserve(userId, contentLength, mysqlPool_, &used, &quota);
+        if (!reservation)
+        {
+            LOG_WARN << "Upload rejected before body: " << contentLength << " bytes exceeds quota, used "
+                     << used << " of " << quota << ", user=" << username;
+            RejectRequest(conn, HttpStatusCode::k413PayloadTooLarge, "存储空间不足");
+            return false;
+        }
+        std::static_pointer_cast<HttpContext>(conn->GetContext())->SetRequestHold(reservation);
+    }
+    else if (IsStreamingUpload(request))
+    {
+        // 分片上传：会话须属于当前用户，分片须落在文件范围内
+        std::string uploadId = UploadIdFromUrl(request.GetUrl());
+        std::shared_ptr<UploadSession> session = FindUploadSession(conn, request, uploadId);
+        if (!session)
+        {
+            LOG_WARN << "Upload part rejected before body: session " << uploadId << ", ip=" << conn->GetIP();
+            conn->SetSendCompleteCallback(std::bind(&HttpServer::HandleClose, this, std::placeholders::_1));
+            return false;
+        }
+
+        uint64_t offset = strtoull(request.GetRequestParamsByKey("offset").c_str(), nullptr, 10);
+        uint64_t contentLength = strtoull(request.GetHeader("Content-Length").c_str(), nullptr, 10);
+        if (offset > session->GetSize() || contentLength > session->GetSize() - offset)
+        {
+            LOG_WARN << "Upload part rejected before body: range " << offset << "+" << contentLength
+                     << " exceeds size " << session->GetSize() << ", session=" << uploadId;
+            RejectRequest(conn, HttpStatusCode::k416RangeNotSatisfiable, "分片超出文件范围");
+            return false;
+        }
+    }
+    else
+    {
+        // 其余请求的请求体整体缓存在内存中，限制其大小
+        uint64_t contentLength = strtoull(request.GetHeader("Content-Length").c_str(), nullptr, 10);
+        if (contentLength > kMaxBufferedBody)
+        {
+            LOG_WARN << "Request rejected before body: Content-Length " << contentLength << " for " << request.GetUrl();
+            RejectRequest(conn, HttpStatusCode::k413PayloadTooLarge, "请求体过大");
+            return false;
+        }
+    }
+
+    // 4. 检查通过，客户端在等待时通知其继续发送请求体
+    std::string expect = request.GetHeader("Expect");
+    std::transform(expect.begin(), expect.end(), expect.begin(), ::tolower);
+    if (bodyPending && expect == "100-continue")
+    {
+        static const char kContinue[] = "HTTP/1.1 100 Continue\r\n\r\n";
+        conn->SendData(kContinue, sizeof(kContinue) - 1);
+        LOG_INFO << "Sent 100 Continue for " << request.GetUrl();
+    }
+    return true;
+}
+
+// 拒绝请求并在响应发送完毕后关闭连接，未读取的请求体随连接一起丢弃
+void HttpServer::RejectRequest(const spConnection &conn, const HttpStatusCode code, const std::string& message)
+{
+    SendBadRequestResponse(conn, code, message);
+    conn->SetSendCompleteCallback(std::bind(&HttpServer::HandleClose, this, std::placeholders::_1));
+}
+
 void HttpServer::OnRequest(const spConnection &conn, HttpRequest &request, HttpResponse *response) 
 {
     std::string path = request.GetUrl();
@@ -225,6 +574,9 @@ void HttpServer::OnRequest(const spConnection &conn, HttpRequest &request, HttpR
     LOG_INFO << "Content-Type: " + request.GetHeader("Content-Type");
     LOG_INFO << "Body size: " + std::to_string(request.GetBody().size());
 
+    // 协商响应压缩编码，文件下载等二进制内容在序列化时会被排除
+    response->SetAcceptEncoding(HttpCompressor::Negotiate(request.GetHeader("Accept-Encoding")));
+
     try {
         // 查找匹配的路由
         for (const auto& route : routes_) 
@@ -268,57 +620,73 @@ void HttpServer::OnRequest(const spConnection &conn, HttpRequest &request, HttpR
 // HTTP 请求处理器，用于处理访问网站首页或静态 HTML 页面
 void HttpServer::HandleIndex(const spConnection &conn, HttpRequest &request, HttpResponse *response) 
 {
-    // 设置 HTTP 响应头：200 OK、Content-Type 为 HTML
-    response->SetStatusCode(HttpStatusCode::k200OK);
-    response->SetStatusMessage("OK");
-    response->SetContentType("text/html; charset=utf-8");
-
     // 获取请求路径
     std::string path = request.GetUrl();
-    std::string filePath;
+    std::string assetName;
 
     LOG_INFO << "path = " << path;
 
-    // 获取当前文件所在目录作为项目根路径（编译期绝对路径）
-    std::string currentDir = __FILE__;
-    std::string::size_type pos = currentDir.find_last_of("/");
-    std::string projectRoot = currentDir.substr(0, pos);  // 去除文件名，仅保留目录
-    LOG_INFO << "projectRoot = " << projectRoot;
-
-    // 根据请求路径选择 HTML 文件
+    // 根据请求路径选择 HTML 页面
     if (path == "/register.html") 
     {
-        filePath = projectRoot + "/register.html";
+        assetName = "/register.html";
     } 
     else if (path == "/share.html" || path.find("/share/") == 0) 
     {
-        filePath = projectRoot + "/share.html";
+        assetName = "/share.html";
     } 
     else 
     {
-        filePath = projectRoot + "/index.html";
+        assetName = "/index.html";
     }
 
-    // 打开 HTML 文件
-    std::ifstream file(filePath.c_str());  // C++11 中显式使用 .c_str()
-    if (!file.is_open()) 
+    // 从静态资源缓存中获取页面内容
+    std::shared_ptr<const StaticAsset> asset = staticCache_.Get(assetName);
+    if (!asset) 
     {
-        LOG_ERROR << "Failed to open " << filePath;
-        SendBadRequestResponse(conn, HttpStatusCode::k500InternalServerError, "Failed to open " + filePath);
+        LOG_ERROR << "Failed to open " << assetName;
+        SendBadRequestResponse(conn, HttpStatusCode::k500InternalServerError, "Failed to open " + assetName);
         return;
     }
 
-    // 读取整个 HTML 文件内容到字符串中
-    std::string html((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-    file.close();
+    SendStaticAsset(conn, request, response, asset);
+}
 
-    // 设置响应体和头部
-    response->AddHeader("Connection", "close");
-    response->SetBody(html);
+// 发送缓存的静态资源，条件请求命中时返回 304
+void HttpServer::SendStaticAsset(const spConnection &conn, HttpRequest &request, HttpResponse *response,
+                                 const std::shared_ptr<const StaticAsset>& asset)
+{
+    // 客户端接受 gzip 且存在预压缩版本时直接发送压缩内容
+    bool useGzip = asset->gzipContent && response->GetAcceptEncoding() == ContentEncoding::kGzip;
+    const std::string& etag = useGzip ? asset->gzipEtag : asset->etag;
 
-    const std::string& resp = response->ResponseMessage();
-    conn->SendData(resp.data(), resp.size());
-    conn->SetSendCompleteCallback(std::bind(&HttpServer::HandleSendComplete, this, std::placeholders::_1));
+    // 校验器：强 ETag + Last-Modified，要求浏览器每次使用前重新校验
+    response->AddHeader("ETag", etag);
+    response->AddHeader("Last-Modified", asset->lastModified);
+    response->AddHeader("Cache-Control", "no-cache");
+    if (asset->gzipContent) response->AddHeader("Vary", "Accept-Encoding");
+
+    if (HttpValidator::IsNotModified(request, etag, asset->mtime))
+    {
+        response->SetStatusCode(HttpStatusCode::k304NotModified);
+    }
+    else if (useGzip)
+    {
+        response->SetStatusCode(HttpStatusCode::k200OK);
+        response->SetContentType(asset->contentType);
+        response->AddHeader("Content-Encoding", "gzip");
+        response->SetBodySource(std::make_shared<MemoryBodySource>(asset->gzipContent));
+    }
+    else
+    {
+        // 原文表示与其 ETag 对应，不再动态压缩
+        response->SetAcceptEncoding(ContentEncoding::kIdentity);
+        response->SetStatusCode(HttpStatusCode::k200OK);
+        response->SetContentType(asset->contentType);
+        response->SetBodySource(std::make_shared<MemoryBodySource>(asset->content));
+    }
+
+    SendResponse(conn, response);
 }
 
 /**
@@ -328,7 +696,7 @@ void HttpServer::HandleIndex(const spConnection &conn, HttpRequest &request, Htt
  * 3.继续写入文件块（后续请求）
  * 4.判断是否上传完成
  */
-void HttpServer::HandleFileUpload(const spConnection &conn, HttpRequest &request, HttpResponse *response)
+void HttpServer::HandleFileUpload(const spConnection &conn, HttpRequest &request, HttpResponse *)
 {
     // 1. 验证会话，提取 session ID 并校验
     std::string cookie = request.GetHeader("Cookie");
@@ -418,10 +786,14 @@ void HttpServer::HandleFileUpload(const spConnection &conn, HttpRequest &request
 
             // 生成唯一服务器端文件名，并创建上传上下文对象
             std::string filename = GenerateUniqueFileName("upload");
-            std::string filepath = uploadDir_ + "/" + filename;
-            uploadContext = std::make_shared<FileUploadContext>(filepath, originalFilename);
+            std::string filepath = uploadLayout_.PathFor(filename);
+            // 以 Content-Length 作为预计大小预分配空间（含 multipart 边界开销，完成时截去）
+            uploadContext = std::make_shared<FileUploadContext>(filepath, originalFilename, uploadDevice_,
+                                                                httpContext->GetContentLength());
             httpContext->SetContext(uploadContext);  // 绑定到连接上下文中
             uploadContext->SetBoundary(boundary);     // 设置 multipart 边界
+            uploadContext->SetReservation(httpContext->TakeRequestHold<QuotaReservation>());  // 预检查时预留的配额
+            OpenUploadFile(conn, uploadContext);
 
             // 提取正文开始位置
             std::string body = request.GetBody();
@@ -552,60 +924,29 @@ void HttpServer::HandleFileUpload(const spConnection &conn, HttpRequest &request
 
     request.SetBody("");  // 清空请求体，节省内存
 
-    // 4. 判断是否已上传完成（终态或客户端标记 EOF）
+    // 4. 解析出的文件数据交给磁盘线程写入
+    SubmitUploadData(conn, uploadContext);
+
+    // 5. 判断是否已上传完成（终态或客户端标记 EOF）
     if (uploadContext->GetState() == State::kComplete || httpContext->GetCompleteRequest()) 
     {
-        // std::string serverFileName = fs::path(uploadContext->GetFilename()).filename().string();
-        std::string serverFileName = uploadContext->GetFileName();
-
-        // 查找最后一个路径分隔符的位置
-        size_t pos = serverFileName.find_last_of("/\\");  // 适配 Linux 和 Windows 路径分隔符
-        if (pos != std::string::npos) 
-        {
-            serverFileName = serverFileName.substr(pos + 1);  // 提取文件名部分
-        }
-        
-        std::string originalFileName = uploadContext->GetOriginalFileName();
-        uintmax_t fileSize = uploadContext->GetTotalBytes();
-
-        std::string fileType = GetFileType(originalFileName);
-
-        std::shared_ptr<MySqlConnection> mysqlConn = mysqlPool_->GetConnection();
-        MYSQL* mysql = mysqlConn->GetRawConnection();
-
-        // 写入数据库记录
-        std::string query = "INSERT INTO files (fileName, original_FileName, file_size, file_type, user_id) VALUES ('" +
-            EscapeString(serverFileName, mysql) + "', '" +
-            EscapeString(originalFileName, mysql) + "', " +
-            std::to_string(fileSize) + ", '" +
-            EscapeString(fileType, mysql) + "', " +
-            std::to_string(userId) + ")";
-
-        int fileId = mysqlConn->Update(query);
-        LOG_INFO << "文件：" << originalFileName << "记录写入数据库";
-
-        // 构造 JSON 响应
-        json jsonStr = 
-        {
-            {"code", 0},
-            {"message", "上传成功"},
-            {"fileId", fileId},
-            {"FileName", serverFileName},
-            {"originalFileName", originalFileName},
-            {"size", fileSize}
-        };
-
-        // 设置响应头与 body
-        response->SetStatusCode(HttpStatusCode::k200OK);
-        response->SetStatusMessage("OK");
-        response->SetContentType("application/json");
-        response->AddHeader("Connection", "close");
-        response->SetBody(jsonStr.dump());
-
-        const std::string& resp = response->ResponseMessage();
-        conn->SendData(resp.data(), resp.size());
         httpContext->SetContext(nullptr);
-        conn->SetSendCompleteCallback(std::bind(&HttpServer::HandleClose, this, std::placeholders::_1));
+
+        // 同一设备上的磁盘任务按提交顺序执行：收尾任务在全部数据写入后关闭文件并按内容去重（stat、link、rename
+        // 与写校验和旁路文件），完成后回到事件循环登记并响应
+        std::shared_ptr<bool> finished = std::make_shared<bool>(false);
+        std::shared_ptr<bool> deduplicated = std::make_shared<bool>(false);
+        diskIo_.Submit(uploadContext->GetDevice(), 
+                       [this, uploadContext, finished, deduplicated]() {
+                           *finished = uploadContext->Finish();
+                           if (!*finished) return;
+                           *deduplicated = blobStore_.Commit(uploadContext->GetFileName(), uploadContext->GetContentHash(),
+                                                             uploadContext->GetTotalBytes(), &uploadContext->GetChecksum());
+                       },
+                       conn->GetLoop(),
+                       [this, conn, uploadContext, userId, finished, deduplicated]() {
+                           CompleteFileUpload(conn, uploadContext, userId, *finished, *deduplicated);
+                       });
     } 
     else 
     {
@@ -615,248 +956,703 @@ void HttpServer::HandleFileUpload(const spConnection &conn, HttpRequest &request
     }
 }
 
-// 查询数据库并根据文件的所有者和共享信息构建文件列表
-void HttpServer::HandleListFiles(const spConnection &conn, HttpRequest &request, HttpResponse *response) 
+// 在磁盘线程中创建上传文件并预分配空间；同一设备的任务按提交顺序执行，之后提交的写入任务排在其后
+// 创建失败时写入任务直接丢弃数据，上传仍在接收中则立即拒绝
+void HttpServer::OpenUploadFile(const spConnection &conn, const std::shared_ptr<FileUploadContext>& uploadContext)
 {
-    // 1. 验证会话，检查用户是否已登录或会话是否过期
-    std::string cookie = request.GetHeader("Cookie");
-    std::string sessionId = ParseCookie(cookie, "session_id");
+    diskIo_.Submit(uploadContext->GetDevice(),
+                   [uploadContext]() { uploadContext->Open(); },
+                   conn->GetLoop(),
+                   [this, conn, uploadContext]() {
+                       auto httpContext = std::static_pointer_cast<HttpContext>(conn->GetContext());
+                       if (uploadContext->HasFailed() && httpContext &&
+                           httpContext->GetContext<FileUploadContext>() == uploadContext)
+                       {
+                           httpContext->SetContext(nullptr);
+                           RejectRequest(conn, HttpStatusCode::k500InternalServerError, "Failed to create file");
+                           httpContext->SetHeadersChecked(false);
+                       }
+                   });
+}
 
-    int userId;
-    std::string usernameFromSession;
-    
-    if (!ValidateSession(sessionId, userId, usernameFromSession)) 
+// 将上传解析出的数据提交到磁盘线程写入
+// 每个连接的写盘积压超过上限时暂停读取，数据留在内核接收缓冲区，由 TCP 流控让客户端放慢；积压回落后恢复
+void HttpServer::SubmitUploadData(const spConnection &conn, const std::shared_ptr<FileUploadContext>& uploadContext)
+{
+    std::shared_ptr<std::string> data = uploadContext->TakeStaged();
+    if (data->empty()) return;
+
+    uint64_t size = data->size();
+    if (uploadContext->AddInflight(size) > kDiskBacklogHigh) conn->PauseReading();
+
+    diskIo_.Submit(uploadContext->GetDevice(),
+                   [uploadContext, data]() { uploadContext->WriteToDisk(*data); },
+                   conn->GetLoop(),
+                   [this, conn, uploadContext, size]() {
+                       if (uploadContext->SubInflight(size) <= kDiskBacklogLow) conn->ResumeReading();
+
+                       // 写盘失败且请求仍在接收中：立即拒绝，不再接收剩余数据
+                       auto httpContext = std::static_pointer_cast<HttpContext>(conn->GetContext());
+                       if (uploadContext->HasFailed() && httpContext && 
+                           httpContext->GetContext<FileUploadContext>() == uploadContext)
+                       {
+                           httpContext->SetContext(nullptr);
+                           RejectRequest(conn, HttpStatusCode::k500InternalServerError, "Failed to write file");
+                           httpContext->SetHeadersChecked(false);
+                       }
+                   });
+}
+
+// 上传数据全部写盘后登记文件并响应
+void HttpServer::CompleteFileUpload(const spConnection &conn, const std::shared_ptr<FileUploadContext>& uploadContext,
+                                    int userId, bool finished, bool deduplicated)
+{
+    if (!finished) 
     {
-        LOG_ERROR << "HandleListFiles session is null";
-        SendBadRequestResponse(conn, HttpStatusCode::k401Unauthorized, "未登录或会话已过期");
-        return;  // 返回 401 错误并终止
+        LOG_ERROR << "Upload failed while writing " << uploadContext->GetFileName();
+        SendBadRequestResponse(conn, HttpStatusCode::k500InternalServerError, "Failed to write file");
+        conn->SetSendCompleteCallback(std::bind(&HttpServer::HandleClose, this, std::placeholders::_1));
+        return;
     }
 
-    // 2. 获取请求中传递的文件列表类型（默认为 "my"）
-    std::string listType = request.GetHeader("type");  // "my", "shared", "all"
-    if(listType.empty()) listType = "my";
-    
-    std::string query;
-    if (listType == "my") 
-    {
-        // 2.1 获取当前用户的文件列表
-        query = "SELECT f.id, f.filename, f.original_filename, f.file_size, f.file_type, "
-                "f.created_at, 1 as is_owner FROM files f WHERE f.user_id = " + std::to_string(userId);
-    } 
-    else if (listType == "shared") 
-    {
-        // 2.2 获取共享给当前用户的文件
-        query = "SELECT f.id, f.filename, f.original_filename, f.file_size, f.file_type, "
-                "f.created_at, 0 as is_owner FROM files f "
-                "JOIN file_shares fs ON f.id = fs.file_id "
-                "WHERE (fs.shared_with_id = " + std::to_string(userId) + " OR fs.share_type = 'public') "
-                "AND f.user_id != " + std::to_string(userId);
-    } 
-    else if (listType == "all") 
+    // std::string serverFileName = fs::path(uploadContext->GetFilename()).filename().string();
+    std::string serverFileName = uploadContext->GetFileName();
+
+    // 查找最后一个路径分隔符的位置
+    size_t pos = serverFileName.find_last_of("/\\");  // 适配 Linux 和 Windows 路径分隔符
+    if (pos != std::string::npos) 
     {
-        // 2.3 获取当前用户的文件以及共享给当前用户的文件
-        query = "SELECT f.id, f.filename, f.original_filename, f.file_size, f.file_type, "
-                "f.created_at, CASE WHEN f.user_id = " + std::to_string(userId) + " THEN 1 ELSE 0 END as is_owner "
-                "FROM files f "
-                "LEFT JOIN file_shares fs ON f.id = fs.file_id "
-                "WHERE f.user_id = " + std::to_string(userId) + " OR "
-                "fs.shared_with_id = " + std::to_string(userId) + " OR fs.share_type = 'public'";
+        serverFileName = serverFileName.substr(pos + 1);  // 提取文件名部分
     }
     
-    LOG_INFO << "query = " << query;  // 打印生成的 SQL 查询
-    std::shared_ptr<MySqlConnection> mysqlConn = mysqlPool_->GetConnection();
-    MYSQL_RES* result = mysqlConn->Query(query);  // 执行查询并获取结果
-
-    json jsonStr;
-    jsonStr["code"] = 0;
-    jsonStr["message"] = "Success";
-    json files = json::array();  // 存储文件信息的 JSON 数组
-
-    // 3. 处理查询结果
-    if (result) 
-    {
-        MYSQL_ROW row;
-        while ((row = mysql_fetch_row(result))) 
-        {
-            // 解析每一行文件信息
-            int fileId = std::stoi(row[0]);
-            std::string fileName = row[1];
-            std::string originalFileName = row[2];
-            uintmax_t fileSize = std::stoull(row[3]);
-            std::string fileType = row[4];
-            std::string createdAt = row[5];
-            bool isOwner = (std::stoi(row[6]) == 1);  // 判断当前用户是否是文件所有者
-
-            // 4. 如果文件是当前用户的，获取分享信息
-            json shareInfo = nullptr;
-            if (isOwner) 
-            {
-                // 4.1 查询文件的分享信息
-                std::string shareQuery = "SELECT share_type, shared_with_id, share_code, expire_time, extract_code FROM file_shares "
-                                          "WHERE file_id = " + std::to_string(fileId);
-                MYSQL_RES* shareResult = mysqlConn->Query(shareQuery);
-                
-                if (shareResult && mysql_num_rows(shareResult) > 0) 
-                {
-                    // 获取下一行的数据，并返回该行数据的一个指针
-                    MYSQL_ROW shareRow = mysql_fetch_row(shareResult);
-                    std::string shareType = shareRow[0];
+    std::string originalFileName = uploadContext->GetOriginalFileName();
+    uintmax_t fileSize = uploadContext->GetTotalBytes();
 
-                    // 4.2 构建分享信息
-                    shareInfo = 
-                    {
-                        {"type", shareType},
-                        {"shareCode", shareRow[2] ? shareRow[2] : ""}  // 如果有 shareCode，则填充
-                    };
+    // 写入数据库记录（去重已在磁盘线程中完成）
+    int fileId = RegisterUploadedFile(uploadContext->GetFileName(), originalFileName, fileSize,
+                                      uploadContext->GetContentHash(), userId, deduplicated);
+    // 实际大小已计入已用空间，归还预留
+    uploadContext->SetReservation(nullptr);
 
-                    // 如果是受保护分享，包含提取码
-                    if (shareType == "protected" && shareRow[4]) 
-                    {
-                        shareInfo["extractCode"] = shareRow[4];
-                    }
+    // 构造 JSON 响应：不透露是否去重，否则客户端可借此确认其他用户是否存有相同内容；去重效果见 BlobStore 的统计
+    json jsonStr = 
+    {
+        {"code", 0},
+        {"message", "上传成功"},
+        {"fileId", fileId},
+        {"FileName", serverFileName},
+        {"originalFileName", originalFileName},
+        {"size", fileSize}
+    };
 
-                    // 如果是用户分享，获取共享给的用户的用户名
-                    if (shareType == "user" && shareRow[1]) 
-                    {
-                        int sharedWithId = std::stoi(shareRow[1]);
-                        std::string userQuery = "SELECT username FROM users WHERE id = " + std::to_string(sharedWithId);
-                        MYSQL_RES* userResult = mysqlConn->Query(userQuery);
-                        if (userResult && mysql_num_rows(userResult) > 0) 
-                        {
-                            MYSQL_ROW userRow = mysql_fetch_row(userResult);
-                            shareInfo["sharedWithUsername"] = userRow[0];
-                            shareInfo["sharedWithId"] = sharedWithId;
-                        }
-                        if (userResult) mysql_free_result(userResult);  // 释放用户查询结果
-                    }
+    // 设置响应头与 body
+    HttpResponse response(false);
+    response.SetStatusCode(HttpStatusCode::k200OK);
+    response.SetStatusMessage("OK");
+    response.SetContentType("application/json");
+    response.AddHeader("Connection", "close");
+    response.SetBody(jsonStr.dump());
 
-                    // 如果有过期时间，填充
-                    if (shareRow[3]) 
-                    {
-                        shareInfo["expireTime"] = shareRow[3];
-                    }
-                }
+    SendResponse(conn, &response);
+    conn->SetSendCompleteCallback(std::bind(&HttpServer::HandleClose, this, std::placeholders::_1));
+}
 
-                if (shareResult) mysql_free_result(shareResult);  // 释放分享信息查询结果
-            }
+// 登记上传完成的文件：按内容去重、写入数据库记录与文件名映射，返回文件 ID
+int HttpServer::RegisterUploadedFile(const std::string& filepath, const std::string& originalFileName, uintmax_t fileSize,
+                                     const std::string& contentHash, int userId, bool deduplicated)
+{
+    std::string serverFileName = filepath;
+    size_t pos = serverFileName.find_last_of("/\\");
+    if (pos != std::string::npos) 
+    {
+        serverFileName = serverFileName.substr(pos + 1);
+    }
+    std::string fileType = GetFileType(originalFileName);
 
-            // 5. 构建文件信息 JSON 对象
-            json fileInfo = {
-                {"id", fileId},
-                {"name", fileName},
-                {"originalName", originalFileName},
-                {"size", fileSize},
-                {"type", fileType},
-                {"createdAt", createdAt},
-                {"isOwner", isOwner}
-            };
+    LOG_INFO << "文件：" << originalFileName << " sha256 = " << contentHash << (deduplicated ? "（已存在，去重）" : "");
 
-            // 6. 如果存在分享信息，添加到文件信息中
-            if (shareInfo != nullptr) 
-            {
-                fileInfo["shareInfo"] = shareInfo;
-            }
+    std::shared_ptr<MySqlConnection> mysqlConn = mysqlPool_->GetConnection();
+    MYSQL* mysql = mysqlConn->GetRawConnection();
 
-            files.push_back(fileInfo);  // 将文件信息添加到文件数组中
-        }
-        jsonStr["files"] = files;  // 添加文件列表到响应中
-    }
+    // 写入数据库记录
+    std::string query = "INSERT INTO files (fileName, original_FileName, file_size, file_type, user_id, content_hash) VALUES ('" +
+        EscapeString(serverFileName, mysql) + "', '" +
+        EscapeString(originalFileName, mysql) + "', " +
+        std::to_string(fileSize) + ", '" +
+        EscapeString(fileType, mysql) + "', " +
+        std::to_string(userId) + ", '" +
+        contentHash + "')";
+
+    // Update 返回影响的行数，新文件 ID 取自自增主键
+    mysqlConn->Update(query);
+    int fileId = static_cast<int>(mysql_insert_id(mysql));
+    LOG_INFO << "文件：" << originalFileName << "记录写入数据库, id " << fileId;
+    quota_.Adjust(userId, static_cast<int64_t>(fileSize), mysqlConn.get());
+    fileMetaCache_.InvalidateFile(serverFileName);
+    fileNameJournal_.Put(serverFileName, originalFileName);
+    return fileId;
+}
 
-    // 7. 设置 HTTP 响应头部和内容
-    response->SetStatusCode(HttpStatusCode::k200OK);
-    response->SetStatusMessage("OK");
-    response->SetContentType("application/json");
-    response->AddHeader("Connection", "close");
-    response->SetBody(jsonStr.dump());  // 将文件信息转为 JSON 格式并设置到响应体中
+// 计算文件内容的 SHA-256 十六进制摘要与分块校验和
+static bool HashFileContent(const std::string& path, std::string* hex, BlockChecksum* checksum)
+{
+    FILE* fp = fopen(path.c_str(), "rb");
+    if (!fp) return false;
 
-    // 8. 设置写完成回调，关闭连接
-    const std::string& resp = response->ResponseMessage();
-    conn->SendData(resp.data(), resp.size());
-    conn->SetSendCompleteCallback(std::bind(&HttpServer::HandleSendComplete, this, std::placeholders::_1));
+    Sha256 hasher;
+    std::vector<char> buf(kHashReadChunk);
+    size_t n;
+    while ((n = fread(buf.data(), 1, buf.size(), fp)) > 0)
+    {
+        hasher.Update(buf.data(), n);
+        checksum->Update(buf.data(), n);
+    }
+    bool ok = !ferror(fp);
+    fclose(fp);
+    checksum->Finish();
+    if (ok) *hex = hasher.FinalHex();
+    return ok;
 }
 
-// 处理文件下载请求，根据请求的类型返回不同的文件内容
-void HttpServer::HandleDownload(const spConnection &conn, HttpRequest &request, HttpResponse *response)
+// 查找属于当前登录用户的上传会话
+std::shared_ptr<UploadSession> HttpServer::FindUploadSession(const spConnection &conn, HttpRequest &request, 
+                                                             const std::string& uploadId)
 {
-    response->SetAsync(true);
-    // 1. 获取请求的文件名
-    std::string fileName = request.GetRequestParamsByKey("filename");
-    if (fileName.empty()) 
+    std::string sessionId = ParseCookie(request.GetHeader("Cookie"), "session_id");
+    int userId;
+    std::string username;
+    if (!ValidateSession(sessionId, userId, username)) 
     {
-        LOG_ERROR << "HandleDownload fileName is null";
-        SendBadRequestResponse(conn, HttpStatusCode::k400BadRequest, "Missing fileName");
-        return;  // 如果文件名为空，返回 400 错误
+        SendBadRequestResponse(conn, HttpStatusCode::k401Unauthorized, "未登录或会话已过期");
+        return nullptr;
     }
-    
-    // 2. 获取会话 ID
-    std::string cookie = request.GetHeader("Cookie");
-    std::string sessionId = ParseCookie(cookie, "session_id");
-    if (sessionId.empty()) 
+
+    std::shared_ptr<UploadSession> session = uploadSessions_.Get(uploadId);
+    if (!session) 
     {
-        sessionId = request.GetRequestParamsByKey("sessionId");  // 尝试从 URL 查询参数获取 sessionId
-        LOG_INFO << "从URL查询参数获取sessionId: " << sessionId;
+        SendBadRequestResponse(conn, HttpStatusCode::k404NotFound, "上传会话不存在或已过期");
+        return nullptr;
     }
-    
-    int userId = 0;
-    std::string usernameFromSession;
-    bool isAuthenticated = ValidateSession(sessionId, userId, usernameFromSession);  // 验证用户是否已登录
-    
-    // 获取分享码和提取码（如果有）
-    std::string shareCode = request.GetRequestParamsByKey("code");
-    std::string extractCode = request.GetRequestParamsByKey("extract_code");
-    LOG_INFO << "shareCode = " << shareCode << ", extractCode = " << extractCode;
-    
-    // 3. 构造查询 SQL，获取文件信息和权限
-    std::shared_ptr<MySqlConnection> mysqlConn = mysqlPool_->GetConnection();
-    MYSQL* mysql = mysqlConn->GetRawConnection();
-    std::string query;
-    if (!shareCode.empty()) 
-    {
-        // 通过分享链接访问
-        query = "SELECT f.id, f.filename, f.original_filename, f.user_id, "
-                "fs.share_type, fs.shared_with_id, fs.extract_code "
-                "FROM files f "
-                "JOIN file_shares fs ON f.id = fs.file_id "
-                "WHERE f.filename = '" + EscapeString(fileName, mysql) + "' "
-                "AND fs.share_code = '" + EscapeString(shareCode, mysql) + "' "
-                "AND (fs.expire_time IS NULL OR fs.expire_time > NOW())";
-    } 
-    else 
+    if (session->GetUserId() != userId) 
     {
-        // 直接访问，验证会话
-        if (!isAuthenticated) 
-        {
-            LOG_ERROR << "HandleDownload session is null";
-            SendBadRequestResponse(conn, HttpStatusCode::k401Unauthorized, "请先登录");
-            return;  // 如果未认证，返回 401 错误
-        }
-        query = "SELECT f.id, f.filename, f.original_filename, f.user_id, "
-                "NULL as share_type, NULL as shared_with_id, NULL as extract_code "
-                "FROM files f WHERE f.filename = '" + EscapeString(fileName, mysql) + "'";
+        LOG_WARN << "Upload session " << uploadId << " accessed by user " << userId;
+        SendBadRequestResponse(conn, HttpStatusCode::k403Forbidden, "无权访问该上传会话");
+        return nullptr;
     }
-    
-    LOG_INFO << "查询文件信息: " << query;
-    MYSQL_RES* result = mysqlConn->Query(query);
-    
-    // 4. 检查文件是否存在
-    if (!result || mysql_num_rows(result) == 0) 
-    {
-        if (result) mysql_free_result(result);
+    return session;
+}
+
+// 创建分片上传会话，请求体 {"fileName": ..., "size": ...}，服务器预分配临时文件
+void HttpServer::HandleCreateUploadSession(const spConnection &conn, HttpRequest &request, HttpResponse *)
+{
+    std::string sessionId = ParseCookie(request.GetHeader("Cookie"), "session_id");
+    int userId;
+    std::string username;
+    if (!ValidateSession(sessionId, userId, username)) 
+    {
+        SendBadRequestResponse(conn, HttpStatusCode::k401Unauthorized, "未登录或会话已过期");
+        return;
+    }
+
+    std::string fileName;
+    uint64_t size = 0;
+    try 
+    {
+        json requestData = json::parse(request.GetBody());
+        fileName = requestData.value("fileName", "");
+        size = requestData.value("size", static_cast<uint64_t>(0));
+    } 
+    catch (const std::exception& e) 
+    {
+        LOG_ERROR << "HandleCreateUploadSession invalid body: " << e.what();
+        SendBadRequestResponse(conn, HttpStatusCode::k400BadRequest, "请求格式错误");
+        return;
+    }
+
+    if (fileName.empty() || size == 0) 
+    {
+        SendBadRequestResponse(conn, HttpStatusCode::k400BadRequest, "文件名和大小不能为空");
+        return;
+    }
+    if (size > maxUploadSize_) 
+    {
+        SendBadRequestResponse(conn, HttpStatusCode::k413PayloadTooLarge, "文件大小超出限制");
+        return;
+    }
+    // 会话持有预留直到提交、取消或被清理
+    std::shared_ptr<QuotaReservation> reservation = quota_.TryReserve(userId, size, mysqlPool_);
+    if (!reservation) 
+    {
+        LOG_WARN << "Upload session rejected: " << size << " bytes exceeds quota, user=" << username;
+        SendBadRequestResponse(conn, HttpStatusCode::k413PayloadTooLarge, "存储空间不足");
+        return;
+    }
+
+    // 创建并预分配临时文件、写会话信息文件（含 fdatasync）都在磁盘线程中进行，期间暂停读取该连接，保证响应顺序
+    std::string uploadId = GenerateSessionId();
+    std::shared_ptr<bool> created = std::make_shared<bool>(false);
+    conn->PauseReading();
+
+    diskIo_.Submit(uploadDevice_, [this, uploadId, userId, fileName, size, reservation, created]() {
+        std::shared_ptr<UploadSession> session = uploadSessions_.Create(uploadId, userId, fileName, size);
+        if (!session) return;
+        session->SetReservation(reservation);
+        *created = true;
+    }, conn->GetLoop(), [this, conn, uploadId, username, fileName, size, created]() {
+        conn->ResumeReading();
+        if (!*created) 
+        {
+            SendBadRequestResponse(conn, HttpStatusCode::k500InternalServerError, "创建上传会话失败");
+            return;
+        }
+        LOG_INFO << "Upload session " << uploadId << " created: " << fileName << ", " << size << " bytes, user=" << username;
+
+        json jsonStr = 
+        {
+            {"code", 0},
+            {"uploadId", uploadId},
+            {"size", size},
+            {"partSize", kUploadPartSize}
+        };
+        HttpResponse response(false);
+        response.SetStatusCode(HttpStatusCode::k200OK);
+        response.SetStatusMessage("OK");
+        response.SetContentType("application/json");
+        response.SetBody(jsonStr.dump());
+        SendResponse(conn, &response);
+    });
+}
+
+// 上传一个分片：PUT /upload/sessions/<id>?offset=N，请求体为该偏移处的原始数据
+// 请求体分多次到达，每次到达的数据直接写入临时文件，请求体不在内存中累积
+void HttpServer::HandleUploadPart(const spConnection &conn, HttpRequest &request, HttpResponse *)
+{
+    auto httpContext = std::static_pointer_cast<HttpContext>(conn->GetContext());
+    std::shared_ptr<UploadPartContext> part = httpContext->GetContext<UploadPartContext>();
+
+    // 1. 首次进入：会话与偏移已在预检查中校验，这里建立分片状态
+    if (!part) 
+    {
+        std::shared_ptr<UploadSession> session = FindUploadSession(conn, request, request.GetRequestParamsByKey("uploadId"));
+        if (!session) 
+        {
+            httpContext->SetHeadersChecked(false);
+            return;
+        }
+        uint64_t offset = strtoull(request.GetRequestParamsByKey("offset").c_str(), nullptr, 10);
+        part = std::make_shared<UploadPartContext>(session, offset);
+        httpContext->SetContext(part);
+    }
+
+    // 2. 本次到达的数据交给磁盘线程写入
+    if (!part->failed && !request.GetBody().empty()) 
+    {
+        SubmitUploadPartData(conn, part, std::make_shared<const std::string>(request.TakeBody()));
+    }
+    request.SetBody("");
+
+    if (part->failed) 
+    {
+        LOG_ERROR << "Upload part write failed: " << part->session->GetId() << " offset " << part->offset;
+        httpContext->SetContext(nullptr);
+        RejectRequest(conn, HttpStatusCode::k500InternalServerError, "写入分片失败");
+        httpContext->SetHeadersChecked(false);
+        return;
+    }
+
+    // 3. 请求体尚未接收完，等待后续数据
+    if (!httpContext->GetCompleteRequest()) return;
+
+    // 4. 请求体已接收完：数据全部写盘后再响应；期间暂停读取，保证同一连接上的响应顺序
+    part->requestDone = true;
+    httpContext->SetContext(nullptr);
+    if (part->inflight > 0) 
+    {
+        conn->PauseReading();
+        return;
+    }
+    FinishUploadPart(conn, part);
+}
+
+// 将一段分片数据提交到磁盘线程，按偏移写入会话的临时文件
+void HttpServer::SubmitUploadPartData(const spConnection &conn, const std::shared_ptr<UploadPartContext>& part,
+                                      std::shared_ptr<const std::string> data)
+{
+    uint64_t offset = part->offset + part->written;
+    uint64_t size = data->size();
+    part->written += size;
+    part->inflight += size;
+    if (part->inflight > kDiskBacklogHigh) conn->PauseReading();
+
+    std::shared_ptr<UploadSession> session = part->session;
+    std::shared_ptr<bool> ok = std::make_shared<bool>(false);
+    diskIo_.Submit(session->GetDevice(),
+                   [session, offset, data, ok]() { *ok = session->Write(offset, data->data(), data->size()); },
+                   conn->GetLoop(),
+                   [this, conn, part, size, ok]() {
+                       part->inflight -= size;
+                       if (!*ok) part->failed = true;
+
+                       if (part->requestDone) 
+                       {
+                           if (part->inflight == 0) FinishUploadPart(conn, part);
+                           return;
+                       }
+                       if (part->inflight <= kDiskBacklogLow) conn->ResumeReading();
+
+                       // 写盘失败且请求仍在接收中：立即拒绝，不再接收剩余数据
+                       auto httpContext = std::static_pointer_cast<HttpContext>(conn->GetContext());
+                       if (part->failed && httpContext && httpContext->GetContext<UploadPartContext>() == part)
+                       {
+                           LOG_ERROR << "Upload part write failed: " << part->session->GetId() << " offset " << part->offset;
+                           httpContext->SetContext(nullptr);
+                           conn->ResumeReading();
+                           RejectRequest(conn, HttpStatusCode::k500InternalServerError, "写入分片失败");
+                           httpContext->SetHeadersChecked(false);
+                       }
+                   });
+}
+
+// 分片数据全部写盘后保存进度并响应
+void HttpServer::FinishUploadPart(const spConnection &conn, const std::shared_ptr<UploadPartContext>& part)
+{
+    std::shared_ptr<UploadSession> session = part->session;
+    if (part->failed) 
+    {
+        LOG_ERROR << "Upload part write failed: " << session->GetId() << " offset " << part->offset;
+        conn->ResumeReading();
+        RejectRequest(conn, HttpStatusCode::k500InternalServerError, "写入分片失败");
+        return;
+    }
+
+    // 持久化已接收区间同样在磁盘线程中进行
+    diskIo_.Submit(session->GetDevice(), [session]() { session->SaveMeta(); }, conn->GetLoop(), [this, conn, part, session]() {
+        uint64_t receivedBytes = session->GetReceivedBytes();
+        json jsonStr = 
+        {
+            {"code", 0},
+            {"uploadId", session->GetId()},
+            {"offset", part->offset},
+            {"length", part->written},
+            {"receivedBytes", receivedBytes},
+            {"complete", receivedBytes == session->GetSize()}
+        };
+
+        HttpResponse response(false);
+        response.SetStatusCode(HttpStatusCode::k200OK);
+        response.SetStatusMessage("OK");
+        response.SetContentType("application/json");
+        response.SetBody(jsonStr.dump());
+        SendResponse(conn, &response);
+        conn->ResumeReading();
+    });
+}
+
+// 查询上传会话已接收的字节区间，客户端据此只补传缺失部分
+void HttpServer::HandleUploadSessionStatus(const spConnection &conn, HttpRequest &request, HttpResponse *response)
+{
+    std::shared_ptr<UploadSession> session = FindUploadSession(conn, request, request.GetRequestParamsByKey("uploadId"));
+    if (!session) return;
+
+    json ranges = json::array();
+    for (const auto& range : session->GetReceivedRanges()) 
+    {
+        ranges.push_back({range.first, range.second});
+    }
+    json jsonStr = 
+    {
+        {"code", 0},
+        {"uploadId", session->GetId()},
+        {"fileName", session->GetOriginalFileName()},
+        {"size", session->GetSize()},
+        {"receivedBytes", session->GetReceivedBytes()},
+        {"received", ranges}
+    };
+    response->SetStatusCode(HttpStatusCode::k200OK);
+    response->SetStatusMessage("OK");
+    response->SetContentType("application/json");
+    response->SetBody(jsonStr.dump());
+    SendResponse(conn, response);
+}
+
+// 提交上传会话：全部数据到齐后计算摘要、移入上传目录并登记文件
+void HttpServer::HandleCommitUploadSession(const spConnection &conn, HttpRequest &request, HttpResponse *)
+{
+    std::string uploadId = request.GetRequestParamsByKey("uploadId");
+    std::shared_ptr<UploadSession> session = FindUploadSession(conn, request, uploadId);
+    if (!session) return;
+
+    // 创建时已预留空间；重启后恢复的会话没有预留，提交前补上，超出配额时会话保留，释放空间后可重试
+    if (!session->HasReservation()) 
+    {
+        std::shared_ptr<QuotaReservation> reservation = quota_.TryReserve(session->GetUserId(), session->GetSize(), mysqlPool_);
+        if (!reservation) 
+        {
+            LOG_WARN << "Upload session " << uploadId << " commit rejected: exceeds quota";
+            SendBadRequestResponse(conn, HttpStatusCode::k413PayloadTooLarge, "存储空间不足");
+            return;
+        }
+        session->SetReservation(reservation);
+    }
+
+    // 刷盘、计算摘要与移动文件都在磁盘线程中进行，期间暂停读取该连接，保证响应顺序
+    struct CommitResult
+    {
+        HttpStatusCode code = HttpStatusCode::k200OK;
+        std::string contentHash;
+        BlockChecksum checksum;
+        bool deduplicated = false;
+    };
+    std::shared_ptr<CommitResult> result = std::make_shared<CommitResult>();
+    std::string fileName = GenerateUniqueFileName("upload");
+    std::string filepath = uploadLayout_.PathFor(fileName);
+    conn->PauseReading();
+
+    diskIo_.Submit(session->GetDevice(), [this, session, filepath, result]() {
+        if (!session->BeginCommit()) 
+        {
+            result->code = HttpStatusCode::k409Conflict;
+            return;
+        }
+        if (!HashFileContent(session->GetDataPath(), &result->contentHash, &result->checksum)) 
+        {
+            LOG_ERROR << "Upload session " << session->GetId() << " hash failed: " << strerror(errno);
+            result->code = HttpStatusCode::k500InternalServerError;
+            return;
+        }
+        if (!UploadLayout::EnsureParentDir(filepath) || rename(session->GetDataPath().c_str(), filepath.c_str()) != 0) 
+        {
+            LOG_ERROR << "Upload session " << session->GetId() << " rename failed: " << strerror(errno);
+            result->code = HttpStatusCode::k500InternalServerError;
+            return;
+        }
+        // 按内容摘要去重：已有相同内容时改为链接到已有 blob，刚移入的副本被释放
+        result->deduplicated = blobStore_.Commit(filepath, result->contentHash, session->GetSize(), &result->checksum);
+    }, conn->GetLoop(), [this, conn, session, fileName, filepath, result]() {
+        conn->ResumeReading();
+        if (result->code == HttpStatusCode::k409Conflict) 
+        {
+            SendBadRequestResponse(conn, HttpStatusCode::k409Conflict, "上传尚未完成");
+            return;
+        }
+        // 提交成功时数据文件已移走，只剩会话信息文件需要删除；失败的会话无法继续，一并删除
+        uploadSessions_.Remove(session->GetId(), true);
+        if (result->code != HttpStatusCode::k200OK) 
+        {
+            SendBadRequestResponse(conn, HttpStatusCode::k500InternalServerError, "提交上传失败");
+            return;
+        }
+
+        int fileId = RegisterUploadedFile(filepath, session->GetOriginalFileName(), session->GetSize(),
+                                          result->contentHash, session->GetUserId(), result->deduplicated);
+        session->SetReservation(nullptr);
+        LOG_INFO << "Upload session " << session->GetId() << " committed as " << filepath;
+
+        json jsonStr = 
+        {
+            {"code", 0},
+            {"message", "上传成功"},
+            {"fileId", fileId},
+            {"FileName", fileName},
+            {"originalFileName", session->GetOriginalFileName()},
+            {"size", session->GetSize()}
+        };
+        HttpResponse response(false);
+        response.SetStatusCode(HttpStatusCode::k200OK);
+        response.SetStatusMessage("OK");
+        response.SetContentType("application/json");
+        response.SetBody(jsonStr.dump());
+        SendResponse(conn, &response);
+    });
+}
+
+// 取消上传会话并删除临时文件
+void HttpServer::HandleAbortUploadSession(const spConnection &conn, HttpRequest &request, HttpResponse *response)
+{
+    std::string uploadId = request.GetRequestParamsByKey("uploadId");
+    std::shared_ptr<UploadSession> session = FindUploadSession(conn, request, uploadId);
+    if (!session) return;
+
+    // 临时文件在磁盘线程中删除
+    uploadSessions_.Remove(uploadId, false);
+    diskIo_.Submit(session->GetDevice(), [session]() { session->RemoveFiles(); });
+    LOG_INFO << "Upload session " << uploadId << " aborted";
+
+    json jsonStr = {{"code", 0}, {"message", "已取消上传"}};
+    response->SetStatusCode(HttpStatusCode::k200OK);
+    response->SetStatusMessage("OK");
+    response->SetContentType("application/json");
+    response->SetBody(jsonStr.dump());
+    SendResponse(conn, response);
+}
+
+// 查询数据库并根据文件的所有者和共享信息构建文件列表
+void HttpServer::HandleListFiles(const spConnection &conn, HttpRequest &request, HttpResponse *response) 
+{
+    // 1. 验证会话，检查用户是否已登录或会话是否过期
+    std::string cookie = request.GetHeader("Cookie");
+    std::string sessionId = ParseCookie(cookie, "session_id");
+
+    int userId;
+    std::string usernameFromSession;
+    
+    if (!ValidateSession(sessionId, userId, usernameFromSession)) 
+    {
+        LOG_ERROR << "HandleListFiles session is null";
+        SendBadRequestResponse(conn, HttpStatusCode::k401Unauthorized, "未登录或会话已过期");
+        return;  // 返回 401 错误并终止
+    }
+
+    // 2. 获取请求中传递的文件列表类型（默认为 "my"）
+    std::string listType = request.GetHeader("type");  // "my", "shared", "all"
+    if(listType.empty()) listType = "my";
+
+    // 3. 分页参数：?after=<上一页最后一个文件 id>&limit=<每页数量>，未指定 limit 时按单页上限返回，
+    //    客户端根据 nextAfter 继续获取后续页
+    std::string afterParam = request.GetRequestParamsByKey("after");
+    std::string limitParam = request.GetRequestParamsByKey("limit");
+    long long afterId = afterParam.empty() ? 0 : std::max(0LL, atoll(afterParam.c_str()));
+    long long limit = limitParam.empty() ? kMaxListLimit : std::min(std::max(1LL, atoll(limitParam.c_str())), kMaxListLimit);
+
+    // 4. 按列表类型构造筛选条件，共享判断使用 EXISTS，避免一个文件有多条分享记录时重复出现
+    //    用户 ID 作为参数传入，三种列表各对应一条固定的 SQL 模板，在连接上预处理一次后复用
+    std::string sharedWithMe = "EXISTS (SELECT 1 FROM file_shares s WHERE s.file_id = f.id "
+                               "AND (s.shared_with_id = ? OR s.share_type = 'public'))";
+    std::string condition;
+    unsigned int conditionParams;
+    if (listType == "shared") 
+    {
+        // 4.1 共享给当前用户的文件
+        condition = "f.user_id != ? AND " + sharedWithMe;
+        conditionParams = 2;
+    } 
+    else if (listType == "all") 
+    {
+        // 4.2 当前用户的文件以及共享给当前用户的文件
+        condition = "(f.user_id = ? OR " + sharedWithMe + ")";
+        conditionParams = 2;
+    }
+    else 
+    {
+        // 4.3 当前用户的文件
+        condition = "f.user_id = ?";
+        conditionParams = 1;
+    }
+
+    // 5. 一条查询取出当前页的文件及其分享信息（所有者的文件取最早的一条分享记录，指定用户分享同时取出用户名）
+    //    按 id 递增的键集分页，先在子查询中截取当前页，再关联分享表与用户表
+    std::string query = 
+        "SELECT p.id, p.filename, p.original_filename, p.file_size, p.file_type, p.created_at, p.is_owner, "
+        "fs.share_type, fs.shared_with_id, fs.share_code, fs.expire_time, fs.extract_code, u.username "
+        "FROM (SELECT f.id, f.filename, f.original_filename, f.file_size, f.file_type, f.created_at, "
+        "(f.user_id = ?) AS is_owner FROM files f "
+        "WHERE " + condition + " AND f.id > ? ORDER BY f.id LIMIT ?) p "
+        "LEFT JOIN file_shares fs ON p.is_owner = 1 "
+        "AND fs.id = (SELECT MIN(s2.id) FROM file_shares s2 WHERE s2.file_id = p.id) "
+        "LEFT JOIN users u ON fs.share_type = 'user' AND u.id = fs.shared_with_id "
+        "ORDER BY p.id";
+    
+    LOG_INFO << "list files: user " << userId << ", type " << listType << ", after " << afterId << ", limit " << limit;
+    std::shared_ptr<MySqlConnection> mysqlConn = mysqlPool_->GetConnection();
+    MySqlStatement* stmt = mysqlConn ? mysqlConn->Prepare(query) : nullptr;
+    if (stmt)
+    {
+        unsigned int index = 0;
+        stmt->BindInt(index++, userId);
+        for (unsigned int i = 0; i < conditionParams; ++i) stmt->BindInt(index++, userId);
+        stmt->BindInt(index++, afterId);
+        stmt->BindInt(index++, limit);
+    }
+
+    // 6. 当前页整体读到客户端并生成 JSON，连接随处理函数返回归还连接池，发送过程不占用数据库连接
+    std::shared_ptr<FileListSource> listSource = 
+        std::make_shared<FileListSource>(limit, response->GetAcceptEncoding());
+    if (!stmt || !stmt->Execute() || !listSource->Load(stmt))
+    {
+        SendBadRequestResponse(conn, HttpStatusCode::k500InternalServerError, "获取文件列表失败");
+        return;
+    }
+    mysqlConn.reset();
+
+    // 7. 设置 HTTP 响应头部
+    response->SetStatusCode(HttpStatusCode::k200OK);
+    response->SetStatusMessage("OK");
+    response->SetContentType("application/json");
+    response->AddHeader("Connection", "close");
+    if (listSource->IsCompressed())
+    {
+        response->AddHeader("Content-Encoding", HttpCompressor::EncodingName(response->GetAcceptEncoding()));
+        response->AddHeader("Vary", "Accept-Encoding");
+    }
+    response->SetBodySource(listSource);
+
+    // 8. 设置写完成回调，关闭连接
+    SendResponse(conn, response);
+    conn->SetSendCompleteCallback(std::bind(&HttpServer::HandleSendComplete, this, std::placeholders::_1));
+}
+
+// 处理文件下载请求，根据请求的类型返回不同的文件内容
+void HttpServer::HandleDownload(const spConnection &conn, HttpRequest &request, HttpResponse *)
+{
+    // 1. 获取请求的文件名
+    std::string fileName = request.GetRequestParamsByKey("filename");
+    if (fileName.empty()) 
+    {
+        LOG_ERROR << "HandleDownload fileName is null";
+        SendBadRequestResponse(conn, HttpStatusCode::k400BadRequest, "Missing fileName");
+        return;  // 如果文件名为空，返回 400 错误
+    }
+    
+    // 2. 获取会话 ID
+    std::string cookie = request.GetHeader("Cookie");
+    std::string sessionId = ParseCookie(cookie, "session_id");
+    if (sessionId.empty()) 
+    {
+        sessionId = request.GetRequestParamsByKey("sessionId");  // 尝试从 URL 查询参数获取 sessionId
+        LOG_INFO << "从URL查询参数获取sessionId: " << sessionId;
+    }
+    
+    int userId = 0;
+    std::string usernameFromSession;
+    bool isAuthenticated = ValidateSession(sessionId, userId, usernameFromSession);  // 验证用户是否已登录
+    
+    // 获取分享码和提取码（如果有）
+    std::string shareCode = request.GetRequestParamsByKey("code");
+    std::string extractCode = request.GetRequestParamsByKey("extract_code");
+    LOG_INFO << "shareCode = " << shareCode << ", extractCode = " << extractCode;
+    
+    // 3. 直接访问需要登录，分享链接访问可匿名
+    if (shareCode.empty() && !isAuthenticated) 
+    {
+        LOG_ERROR << "HandleDownload session is null";
+        SendBadRequestResponse(conn, HttpStatusCode::k401Unauthorized, "请先登录");
+        return;  // 如果未认证，返回 401 错误
+    }
+
+    // 4. 获取文件元数据（优先读缓存），分享链接访问时还需存在未过期的对应分享
+    if (!shareCode.empty() && !shareCodes_.MayExist(shareCode)) 
+    {
+        SendBadRequestResponse(conn, HttpStatusCode::k404NotFound, "File not found");
+        return;
+    }
+    std::shared_ptr<const FileMeta> meta = LoadFileMeta(fileName);
+    const ShareMeta* share = nullptr;
+    if (meta && !shareCode.empty()) share = meta->FindShare(shareCode, time(nullptr));
+    if (!meta || (!shareCode.empty() && !share)) 
+    {
         LOG_ERROR << "HandleDownload File not found";
         SendBadRequestResponse(conn, HttpStatusCode::k404NotFound, "File not found");
         return;  // 文件未找到，返回 404 错误
     }
     
     // 5. 获取文件信息
-    MYSQL_ROW row = mysql_fetch_row(result);
-    int fileId = std::stoi(row[0]);
-    std::string serverfileName = row[1];
-    std::string originalfileName = row[2];
-    int fileOwnerId = std::stoi(row[3]);
-    std::string shareType = row[4] ? row[4] : "";
-    int sharedWithId = row[5] ? std::stoi(row[5]) : 0;
-    std::string dbExtractCode = row[6] ? row[6] : "";
-    mysql_free_result(result);
+    int fileId = meta->id;
+    std::string serverfileName = meta->filename;
+    std::string originalfileName = meta->originalName;
+    int fileOwnerId = meta->ownerId;
+    std::string shareType = share ? share->shareType : "";
+    int sharedWithId = share ? share->sharedWithId : 0;
+    std::string dbExtractCode = share ? share->extractCode : "";
     
     // 6. 检查访问权限
     bool hasPermission = false;
@@ -904,149 +1700,160 @@ void HttpServer::HandleDownload(const spConnection &conn, HttpRequest &request,
     }
     
     LOG_INFO << "权限检查通过，准备下载文件";
-    std::string filepath = uploadDir_ + "/" + serverfileName;
-    
-    try 
+
+    // 7. 打开并发送文件内容（HEAD / Range / 完整下载）
+    SendStoredFile(conn, request, serverfileName, originalfileName, meta->contentHash);
+}
+
+// 下载已上传的文件：定位、打开文件与加载校验和都在上传目录的磁盘队列中进行，与布局迁移的 rename 串行，
+// 事件循环线程不做 stat / open；期间暂停读取该连接，保证响应顺序
+void HttpServer::SendStoredFile(const spConnection &conn, const HttpRequest &request, const std::string& fileName,
+                                const std::string& originalFileName, const std::string& contentHash)
+{
+    struct OpenResult
     {
-        // 7. 检查文件是否存在
-        if (!fs::exists(filepath) || !fs::is_regular_file(filepath)) 
+        std::shared_ptr<FileDownContext> downContext;
+        HttpStatusCode code = HttpStatusCode::k200OK;
+    };
+    std::shared_ptr<OpenResult> result = std::make_shared<OpenResult>();
+    // 处理函数返回后请求对象会被重置，发送时使用副本
+    std::shared_ptr<HttpRequest> requestCopy = std::make_shared<HttpRequest>(request);
+    conn->PauseReading();
+
+    diskIo_.Submit(uploadDevice_, [this, fileName, originalFileName, contentHash, result]() {
+        std::string filepath = uploadLayout_.Resolve(fileName);
+        try 
         {
-            LOG_ERROR << "HandleListFiles session is null";
-            SendBadRequestResponse(conn, HttpStatusCode::k500InternalServerError, "File not found");
-            return;  // 文件不存在，返回 404 错误
+            result->downContext = std::make_shared<FileDownContext>(filepath, originalFileName);
         }
-        
-        uintmax_t fileSize = fs::file_size(filepath);  // 获取文件大小
-        
-        // 8. 处理 HEAD 请求，只返回文件信息，不下载文件
-        if (request.GetMethod() == Method::kHead) 
+        catch (const std::exception& e) 
         {
-            response->SetStatusCode(HttpStatusCode::k200OK);
-            response->SetStatusMessage("OK");
-            response->SetContentType("application/octet-stream");
-            response->AddHeader("Content-Length", std::to_string(fileSize));
-            response->AddHeader("Accept-Ranges", "bytes");
-            response->AddHeader("Connection", "close");
-
-            const std::string& resp = response->ResponseMessage();
-            conn->SendData(resp.data(), resp.size());
-            return;  // 完成文件信息返回
+            struct stat st;
+            bool missing = stat(filepath.c_str(), &st) != 0 && errno == ENOENT;
+            LOG_ERROR << "Error opening " << filepath << " for download: " << e.what();
+            result->code = missing ? HttpStatusCode::k404NotFound : HttpStatusCode::k500InternalServerError;
+            return;
         }
-        
-        // 9. 处理 Range 请求，支持部分下载
-        std::string rangeHeader = request.GetHeader("Range");
-        uintmax_t startPos = 0;
-        uintmax_t endPos = fileSize - 1;
-        bool isRangeRequest = false;
-        
-        if (!rangeHeader.empty()) 
+        // 去重前上传的旧文件没有摘要，巡检补写校验和之前的 blob 也无法校验，均按原样发送
+        if (verifyDownloads_ && !contentHash.empty() &&
+            !result->downContext->EnableVerify(blobStore_.ChecksumPath(contentHash)))
         {
-            // 解析 Range 头部
-            std::regex rangeRegex("bytes=(\\d+)-(\\d*)");
-            std::smatch matches;
-            if (std::regex_search(rangeHeader, matches, rangeRegex)) 
-            {
-                startPos = std::stoull(matches[1]);
-                if (!matches[2].str().empty()) 
-                {
-                    endPos = std::stoull(matches[2]);
-                }
-                isRangeRequest = true;
-                
-                // 验证范围
-                if (startPos >= fileSize) 
-                {
-                    LOG_ERROR << "HandleDownload Range Not Satisfiable";
-                    SendBadRequestResponse(conn, HttpStatusCode::k416RangeNotSatisfiable, "Range Not Satisfiable");
-                    return;
-                }
-                
-                if (endPos >= fileSize) 
-                {
-                    endPos = fileSize - 1;  // 调整结束位置
-                }
-            }
+            LOG_WARN << "No usable checksums for " << filepath << ", sending without verification";
         }
-        
-        LOG_INFO << "startPos: " << startPos << ", endPos: " << endPos;
-        
-        // 10. 获取 HttpContext
-        auto httpContext = std::static_pointer_cast<HttpContext>(conn->GetContext());
-        if (!httpContext) 
+    }, conn->GetLoop(), [this, conn, requestCopy, result]() {
+        conn->ResumeReading();
+        if (!result->downContext) 
         {
-            LOG_ERROR << "HandleDownload HttpContext is null";
-            SendBadRequestResponse(conn, HttpStatusCode::k500InternalServerError, "Internal Server Error");
+            if (result->code == HttpStatusCode::k404NotFound) 
+            {
+                SendBadRequestResponse(conn, HttpStatusCode::k404NotFound, "File not found");
+            }
+            else
+            {
+                SendBadRequestResponse(conn, HttpStatusCode::k500InternalServerError, "Download failed");
+            }
             return;
         }
-        
-        // 11. 获取下载上下文，如果没有，则创建新的
-        std::shared_ptr<FileDownContext> downContext = httpContext->GetContext<FileDownContext>();
-        
-        if (!downContext)  
-        {
-            // 11.1 首次请求此文件，创建新的下载上下文，保存文件路径和原始文件名
-            downContext = std::make_shared<FileDownContext>(filepath, originalfileName);
 
-            // 11.2 将下载上下文保存在连接的 HttpContext 中
-            httpContext->SetContext(downContext);
+        result->downContext->EnableAsyncRead(&diskIo_, conn);
+        HttpResponse response(false);
+        SendFileContent(conn, *requestCopy, &response, result->downContext);
+    });
+}
 
-            // 11.3 如果是 Range 请求，设置响应码为 206 Partial Content，并添加 Content-Range 头
-            if (isRangeRequest) 
-            {
-                response->SetStatusCode(HttpStatusCode::k206PartialContent);  // 设置状态码为部分内容
-                response->SetStatusMessage("Partial Content");                // 设置状态消息
-                response->AddHeader("Content-Range", 
-                    "bytes " + std::to_string(startPos) + "-" + 
-                    std::to_string(endPos) + "/" + std::to_string(fileSize)); // 指明返回的字节范围
-            } 
-            else 
-            {
-                // 否则为普通完整下载，返回 200 OK
-                response->SetStatusCode(HttpStatusCode::k200OK);
-                response->SetStatusMessage("OK");
-                response->AddHeader("Content-Length", std::to_string(endPos - startPos + 1));
-            }
+// 发送文件内容：每个请求使用新的下载上下文，响应均带 Content-Length，不使用分块传输
+// 携带强 ETag 与 Last-Modified，支持 If-None-Match / If-Modified-Since（304）与 If-Range（断点续传校验）
+// 单范围返回 206 + Content-Range，多范围返回 multipart/byteranges，范围均不可满足时返回 416
+void HttpServer::SendFileContent(const spConnection &conn, const HttpRequest &request, HttpResponse *response,
+                                 const std::shared_ptr<FileDownContext>& downContext)
+{
+    const std::string& filepath = downContext->GetFilePath();
+    const std::string& originalFileName = downContext->GetOriginalFileName();
+    uintmax_t fileSize = downContext->GetFileSize();
 
-            // 11.4 设置返回类型为二进制流，表示文件下载
-            response->SetContentType("application/octet-stream");
+    response->AddHeader("Accept-Ranges", "bytes");
+    response->AddHeader("ETag", downContext->GetETag());
+    response->AddHeader("Last-Modified", downContext->GetLastModified());
 
-            // 11.5 设置 Content-Disposition，提示浏览器以附件形式下载，并指定文件名
-            response->AddHeader("Content-Disposition", 
-                "attachment; fileName=\"" + originalfileName + "\"");
-            response->AddHeader("Transfer-Encoding", "chunked");  // 关键设置
-            
-            response->AddHeader("Accept-Ranges", "bytes");
-            // 发送消息头部
-            const std::string& resp = response->ResponseMessage();
-            //std::cout << resp << std::endl;
-            conn->SendData(resp.data(), resp.size());
-            downContext->SeekTo(startPos);
-        }
-        conn->SetSendCompleteCallback([this, downContext](spConnection c) 
-        {
-            std::string chunk;
-            if (downContext->ReadNextChunk(chunk)) {
-                // 格式：<chunk-size>\r\n<chunk-data>\r\n
-                std::ostringstream oss;
-                oss << std::hex << chunk.size() << "\r\n" << chunk << "\r\n";
-                std::string chunkedData = oss.str();
-                c->SendData(chunkedData.data(), chunkedData.size());
-            } 
-            else 
-            {
-                // 结尾块：0\r\n\r\n，表示发送完成
-                c->SendData("0\r\n\r\n", 5);
-                c->SetSendCompleteCallback(std::bind(&HttpServer::HandleSendComplete, this, std::placeholders::_1));
-            }
-        });
-        
+    // 1. 条件请求：客户端缓存仍然有效时返回 304，不再传输文件
+    if (HttpValidator::IsNotModified(request, downContext->GetETag(), downContext->GetModifiedTime()))
+    {
+        response->SetStatusCode(HttpStatusCode::k304NotModified);
+
+        SendResponse(conn, response);
+        return;
     }
-    catch (const std::exception& e) 
+
+    // 2. HEAD 请求只返回文件信息，不发送内容
+    if (request.GetMethod() == Method::kHead) 
+    {
+        response->SetStatusCode(HttpStatusCode::k200OK);
+        response->SetContentType("application/octet-stream");
+        response->AddHeader("Content-Length", std::to_string(fileSize));
+
+        SendResponse(conn, response);
+        return;
+    }
+
+    // 3. 解析 Range 头；If-Range 不匹配说明文件已变化，忽略 Range 返回完整内容
+    std::string rangeHeader = request.GetHeader("Range");
+    std::vector<ByteRange> ranges;
+    RangeParseResult rangeResult = RangeParseResult::kNone;
+    if (HttpValidator::IfRangeMatches(request, downContext->GetETag(), downContext->GetModifiedTime()))
+    {
+        rangeResult = HttpRange::Parse(rangeHeader, fileSize, &ranges);
+    }
+    else
+    {
+        LOG_INFO << "If-Range mismatch, sending full content of " << filepath;
+    }
+
+    if (rangeResult == RangeParseResult::kUnsatisfiable) 
+    {
+        LOG_ERROR << "Range Not Satisfiable: " << rangeHeader << ", file size: " << fileSize;
+        json body = {
+                {"code", static_cast<int>(HttpStatusCode::k416RangeNotSatisfiable)},
+                {"message", "Range Not Satisfiable"}
+            };
+        response->SetStatusCode(HttpStatusCode::k416RangeNotSatisfiable);
+        response->SetContentType("application/json");
+        response->AddHeader("Content-Range", HttpRange::UnsatisfiedContentRange(fileSize));
+        response->SetBody(body.dump());
+
+        SendResponse(conn, response);
+        return;
+    }
+
+    // 4. 根据范围构造响应头
+    if (rangeResult == RangeParseResult::kSatisfiable && ranges.size() == 1) 
+    {
+        response->SetStatusCode(HttpStatusCode::k206PartialContent);
+        response->SetContentType("application/octet-stream");
+        response->AddHeader("Content-Range", HttpRange::ContentRange(ranges[0], fileSize));
+        downContext->SetRanges(ranges);
+    } 
+    else if (rangeResult == RangeParseResult::kSatisfiable) 
     {
-        LOG_ERROR << "Error during file download: " << e.what();
-        SendBadRequestResponse(conn, HttpStatusCode::k500InternalServerError, "Download failed");
-        return;  // 发生异常时返回 500 错误
+        std::string boundary = HttpRange::MakeBoundary();
+        response->SetStatusCode(HttpStatusCode::k206PartialContent);
+        response->SetContentType("multipart/byteranges; boundary=" + boundary);
+        downContext->SetRanges(ranges, boundary, "application/octet-stream");
+    } 
+    else 
+    {
+        response->SetStatusCode(HttpStatusCode::k200OK);
+        response->SetContentType("application/octet-stream");
     }
+
+    LOG_INFO << "Download " << filepath << ", range: " << (rangeHeader.empty() ? "none" : rangeHeader)
+             << ", ranges: " << ranges.size() << ", body length: " << downContext->GetBodyLength();
+
+    response->AddHeader("Content-Disposition", "attachment; filename=\"" + originalFileName + "\"");
+
+    // 5. 下载上下文作为响应体数据源，连接在发送缓冲区排空后按块拉取，到达范围末尾时精确停止
+    //    读取失败时数据源返回错误，连接随之关闭（已发送字节数少于 Content-Length）
+    response->SetBodySource(downContext);
+    SendResponse(conn, response);
 }
 
 // 删除文件
@@ -1074,29 +1881,20 @@ void HttpServer::HandleDelete(const spConnection &conn, HttpRequest &request, Ht
         return;
     }
 
-    // 3. 构造完整文件路径
-    std::string filepath = uploadDir_ + "/" + fileName;
-    LOG_INFO << "filepath = " << filepath;
-
-    // 4. 查询该用户是否拥有该文件
-    std::shared_ptr<MySqlConnection> mysqlConn = mysqlPool_->GetConnection();
-
-    std::string query = "SELECT id FROM files WHERE filename = '" + EscapeString(fileName, mysqlConn->GetRawConnection()) + 
-                        "' AND user_id = " + std::to_string(userId);
-    MYSQL_RES* result = mysqlConn->Query(query);
+    LOG_INFO << "delete file = " << fileName;
 
-    if (!result || mysql_num_rows(result) == 0) 
+    // 4. 检查该用户是否拥有该文件（优先读元数据缓存）
+    std::shared_ptr<const FileMeta> meta = LoadFileMeta(fileName);
+    if (!meta || meta->ownerId != userId) 
     {
-        if (result) mysql_free_result(result);
         LOG_ERROR << "文件不存在或您没有权限删除此文件";
         SendBadRequestResponse(conn, HttpStatusCode::k403Forbidden, "文件不存在或您没有权限删除此文件");
         return;
     }
 
     // 5. 获取文件ID
-    MYSQL_ROW row = mysql_fetch_row(result);
-    int fileId = std::stoi(row[0]);
-    mysql_free_result(result);
+    int fileId = meta->id;
+    std::shared_ptr<MySqlConnection> mysqlConn = mysqlPool_->GetConnection();
 
     // 6. 删除文件分享记录
     std::string deleteSharesQuery = "DELETE FROM file_shares WHERE file_id = " + std::to_string(fileId);
@@ -1113,28 +1911,20 @@ void HttpServer::HandleDelete(const spConnection &conn, HttpRequest &request, Ht
         SendBadRequestResponse(conn, HttpStatusCode::k500InternalServerError, "删除文件记录失败");
         return;
     }
+    fileMetaCache_.InvalidateFile(fileName);
+    for (const ShareMeta& share : meta->shares) shareCodes_.Remove(share.shareCode);
+    quota_.Adjust(userId, -static_cast<int64_t>(meta->size), mysqlConn.get());
+
+    // 8. 删除文件，blob 的最后一个引用被删除时一并回收；unlink 在磁盘线程中执行，记录已删除，无需等待
+    std::string contentHash = meta->contentHash;
+    // 实际路径在磁盘线程中解析，与平铺文件迁移串行，不会删除一个刚被移走的路径
+    diskIo_.Submit(uploadDevice_, [this, fileName, contentHash]() {
+        blobStore_.Release(uploadLayout_.Resolve(fileName), contentHash);
+    });
+    LOG_INFO << "delete file success";
 
-    // 8. 删除文件（如果存在）
-    if (access(filepath.c_str(), F_OK) != 0) 
-    {
-        LOG_WARN << filepath << " not found";
-    } 
-    else 
-    {
-        if (unlink(filepath.c_str()) != 0) 
-        {
-            LOG_WARN << "Failed to delete file: " << filepath << ", error: " << strerror(errno);
-        }
-        LOG_INFO << "delete file success";
-    }
-
-    // 10. 更新文件名映射表（线程安全）
-    {
-        std::lock_guard<std::mutex> lock(mapMutex_);
-        LoadFileNameMapInternal();  // 重新加载映射表
-        fileNameMap_.erase(fileName); // 删除映射项
-        SaveFileNameMapInternal();   // 保存更新后的映射表
-    }
+    // 10. 删除文件名映射（追加一条删除记录）
+    fileNameJournal_.Erase(fileName);
 
     // 11 构建 JSON 成功响应
     json jsonStr = 
@@ -1149,8 +1939,7 @@ void HttpServer::HandleDelete(const spConnection &conn, HttpRequest &request, Ht
     response->SetBody(jsonStr.dump());
 
     // 设置写完成回调，关闭连接
-    const std::string& resp = response->ResponseMessage();
-    conn->SendData(resp.data(), resp.size());
+    SendResponse(conn, response);
     conn->SetSendCompleteCallback(std::bind(&HttpServer::HandleSendComplete, this, std::placeholders::_1));
 }
 
@@ -1195,6 +1984,9 @@ void HttpServer::HandleShareFile(const spConnection &conn, HttpRequest &request,
         {
             std::string deleteQuery = "DELETE FROM file_shares WHERE file_id = " + std::to_string(fileId);
             mysqlConn->Query(deleteQuery);
+            uint64_t removed = mysql_affected_rows(mysqlConn->GetRawConnection());
+            if (removed != static_cast<uint64_t>(-1)) shareCodes_.NoteRemoved(static_cast<size_t>(removed));
+            fileMetaCache_.InvalidateFileId(fileId);
 
             json jsonStr = {
                 {"code", 0},
@@ -1206,8 +1998,7 @@ void HttpServer::HandleShareFile(const spConnection &conn, HttpRequest &request,
             response->AddHeader("Connection", "close");
             response->SetBody(jsonStr.dump());
             
-            const std::string& resp = response->ResponseMessage();
-            conn->SendData(resp.data(), resp.size());
+            SendResponse(conn, response);
             return;
         }
 
@@ -1234,82 +2025,412 @@ void HttpServer::HandleShareFile(const spConnection &conn, HttpRequest &request,
         {
             sharedWithId = std::to_string(requestData["sharedWithId"].get<int>());
 
-            // 检查是否已分享给该用户，避免重复
-            std::string checkQuery = "SELECT 1 FROM file_shares WHERE file_id = " + std::to_string(fileId) +
-                                     " AND shared_with_id = " + sharedWithId +
-                                     " AND share_type = 'user'";
-            MYSQL_RES* checkResult = mysqlConn->Query(checkQuery);
+            // 检查是否已分享给该用户，避免重复
+            std::string checkQuery = "SELECT 1 FROM file_shares WHERE file_id = " + std::to_string(fileId) +
+                                     " AND shared_with_id = " + sharedWithId +
+                                     " AND share_type = 'user'";
+            MYSQL_RES* checkResult = mysqlConn->Query(checkQuery);
+
+            if (checkResult && mysql_num_rows(checkResult) > 0) 
+            {
+                if (checkResult) mysql_free_result(checkResult);
+                LOG_WARN << "已经分享给该用户";
+                SendBadRequestResponse(conn, HttpStatusCode::k400BadRequest, "已经分享给该用户");
+                return;
+            }
+            if (checkResult) mysql_free_result(checkResult);
+        }
+        // 处理受保护分享（生成提取码）
+        else if (shareType == "protected") 
+        {
+            extractCode = "'" + GenerateExtractCode() + "'";
+        }
+
+        // 插入分享记录
+        std::string insertQuery = "INSERT INTO file_shares (file_id, owner_id, shared_with_id, share_type, share_code, extract_code, expire_time) VALUES (" +
+                                  std::to_string(fileId) + ", " +
+                                  std::to_string(userId) + ", " +
+                                  sharedWithId + ", '" +
+                                  EscapeString(shareType, mysqlConn->GetRawConnection()) + "', '" +
+                                  EscapeString(shareCode, mysqlConn->GetRawConnection()) + "', " +
+                                  extractCode + ", " +
+                                  expireStr + ")";
+
+        int shareID = mysqlConn->Update(insertQuery);
+        fileMetaCache_.InvalidateFileId(fileId);
+        if (shareID) shareCodes_.Add(shareCode);
+        if (!shareID) 
+        {
+            LOG_ERROR << "创建分享失败";
+            SendBadRequestResponse(conn, HttpStatusCode::k500InternalServerError, "创建分享失败");
+            return;
+        }
+
+        // 构建返回的 JSON 响应体
+        json jsonStr = {
+            {"code", 0},
+            {"message", "分享成功"},
+            {"shareId", shareID},
+            {"shareType", shareType},
+            {"shareCode", shareCode},
+            {"shareLink", "/share/" + shareCode}
+        };
+
+        if (shareType == "user") 
+        {
+            jsonStr["sharedWithId"] = std::stoi(sharedWithId);
+        } 
+        else if (shareType == "protected") 
+        {
+            // 去除引号包裹的提取码
+            jsonStr["extractCode"] = extractCode.substr(1, extractCode.length() - 2);
+        }
+
+        // 设置 HTTP 响应内容
+        response->SetStatusCode(HttpStatusCode::k200OK);
+        response->SetStatusMessage("OK");
+        response->SetContentType("application/json");
+        response->AddHeader("Connection", "close");
+        response->SetBody(jsonStr.dump());
+
+        SendResponse(conn, response);
+        conn->SetSendCompleteCallback(std::bind(&HttpServer::HandleSendComplete, this, std::placeholders::_1));
+    }
+    catch (const std::exception& e) 
+    {
+        LOG_ERROR << "分享文件错误: " << e.what();
+        SendBadRequestResponse(conn, HttpStatusCode::k500InternalServerError, "分享失败: " + std::string(e.what()));
+        return;
+    }
+}
+
+// 批量删除文件
+void HttpServer::HandleBatchDelete(const spConnection &conn, HttpRequest &request, HttpResponse *response)
+{
+    // 1. 验证用户会话（整批只验证一次）
+    std::string cookie = request.GetHeader("Cookie");
+    std::string sessionId = ParseCookie(cookie, "session_id");
+    int userId;
+    std::string usernameFromSession;
+
+    if (!ValidateSession(sessionId, userId, usernameFromSession)) 
+    {
+        SendBadRequestResponse(conn, HttpStatusCode::k401Unauthorized, "未登录或会话已过期");
+        return;
+    }
+
+    // 2. 解析文件名列表并去重
+    std::vector<std::string> fileNames;
+    try
+    {
+        json requestData = json::parse(request.GetBody());
+        for (const auto& item : requestData.at("filenames")) fileNames.push_back(item.get<std::string>());
+    }
+    catch (const std::exception& e)
+    {
+        LOG_WARN << "HandleBatchDelete 请求格式错误: " << e.what();
+        SendBadRequestResponse(conn, HttpStatusCode::k400BadRequest, "请求格式错误");
+        return;
+    }
+    std::sort(fileNames.begin(), fileNames.end());
+    fileNames.erase(std::unique(fileNames.begin(), fileNames.end()), fileNames.end());
+    if (fileNames.empty() || fileNames.size() > kBatchMaxItems)
+    {
+        SendBadRequestResponse(conn, HttpStatusCode::k400BadRequest, "文件数量无效");
+        return;
+    }
+
+    std::shared_ptr<MySqlConnection> mysqlConn = mysqlPool_->GetConnection();
+    if (!mysqlConn)
+    {
+        SendBadRequestResponse(conn, HttpStatusCode::k503ServiceUnavailable, "服务繁忙，请稍后重试");
+        return;
+    }
+    MYSQL* mysql = mysqlConn->GetRawConnection();
+    std::string nameList;
+    for (const std::string& name : fileNames)
+    {
+        if (!nameList.empty()) nameList += ", ";
+        nameList += "'" + EscapeString(name, mysql) + "'";
+    }
+
+    // 3. 一个事务：锁定属于当前用户的文件行，按集合删除分享记录与文件记录，并扣减已用空间
+    //    FOR UPDATE 使并发的单个删除等待本事务结束，同一文件的 blob 引用不会被释放两次
+    struct Victim
+    {
+        int id;
+        std::string filename;
+        uint64_t size;
+        std::string contentHash;
+    };
+    std::vector<Victim> victims;
+    std::vector<int> ids;
+    std::vector<std::string> shareCodes;
+    uint64_t freed = 0;
+    bool ok = mysqlConn->BeginTransaction();
+    if (ok)
+    {
+        std::string query = "SELECT id, filename, file_size, content_hash FROM files WHERE user_id = " +
+                            std::to_string(userId) + " AND filename IN (" + nameList + ") FOR UPDATE";
+        MYSQL_RES* result = mysqlConn->Query(query);
+        ok = result != nullptr;
+        if (result)
+        {
+            MYSQL_ROW row;
+            while ((row = mysql_fetch_row(result)))
+            {
+                victims.push_back({std::stoi(row[0]), row[1] ? row[1] : "", row[2] ? std::stoull(row[2]) : 0,
+                                   row[3] ? row[3] : ""});
+                ids.push_back(victims.back().id);
+                freed += victims.back().size;
+            }
+            mysql_free_result(result);
+        }
+    }
+    if (ok && !ids.empty())
+    {
+        std::string idList = SqlIdList(ids);
+        // 分享码须在删除前取出，取不到时不能提交，否则这些分享码会留在过滤器中
+        MYSQL_RES* result = mysqlConn->Query("SELECT share_code FROM file_shares WHERE file_id IN (" + idList + ")");
+        ok = result != nullptr;
+        if (result)
+        {
+            MYSQL_ROW row;
+            while ((row = mysql_fetch_row(result)))
+            {
+                if (row[0]) shareCodes.push_back(row[0]);
+            }
+            mysql_free_result(result);
+        }
+        ok = ok &&
+             mysqlConn->Execute("DELETE FROM file_shares WHERE file_id IN (" + idList + ")") >= 0 &&
+             mysqlConn->Execute("DELETE FROM files WHERE id IN (" + idList + ")") >= 0 &&
+             quota_.AdjustStored(userId, -static_cast<int64_t>(freed), mysqlConn.get());
+    }
+    if (!ok || !mysqlConn->Commit())
+    {
+        mysqlConn->Rollback();
+        LOG_ERROR << "批量删除失败, user " << userId << ", " << fileNames.size() << " files";
+        SendBadRequestResponse(conn, HttpStatusCode::k500InternalServerError, "批量删除失败");
+        return;
+    }
+
+    // 4. 事务已提交：更新内存中的已用空间、缓存与分享码过滤器，文件名映射一次追加全部删除记录
+    std::vector<std::string> deleted;
+    std::vector<std::pair<std::string, std::string>> releases;  // <服务器文件名, 内容摘要>
+    for (const Victim& victim : victims)
+    {
+        deleted.push_back(victim.filename);
+        releases.emplace_back(victim.filename, victim.contentHash);
+        fileMetaCache_.InvalidateFile(victim.filename);
+    }
+    quota_.AdjustCached(userId, -static_cast<int64_t>(freed));
+    for (const std::string& code : shareCodes) shareCodes_.Remove(code);
+    fileNameJournal_.EraseBatch(deleted);
+
+    // 5. 整批 blob 回收作为一个磁盘任务提交，记录已删除，无需等待
+    if (!releases.empty())
+    {
+        diskIo_.Submit(uploadDevice_, [this, releases]() {
+            for (const auto& release : releases)
+            {
+                blobStore_.Release(uploadLayout_.Resolve(release.first), release.second);
+            }
+        });
+    }
+
+    // 不存在或不属于当前用户的文件名
+    std::vector<std::string> failed;
+    std::vector<std::string> sortedDeleted(deleted);
+    std::sort(sortedDeleted.begin(), sortedDeleted.end());
+    std::set_difference(fileNames.begin(), fileNames.end(), sortedDeleted.begin(), sortedDeleted.end(),
+                        std::back_inserter(failed));
+    LOG_INFO << "batch delete: user " << userId << ", deleted " << deleted.size() << ", failed " << failed.size();
+
+    json jsonStr = 
+    {
+        {"code", 0},
+        {"message", "success"},
+        {"deleted", deleted},
+        {"failed", failed}
+    };
+    response->SetStatusCode(HttpStatusCode::k200OK);
+    response->SetStatusMessage("OK");
+    response->SetContentType("application/json");
+    response->SetBody(jsonStr.dump());
+
+    SendResponse(conn, response);
+}
+
+// 批量分享文件
+void HttpServer::HandleBatchShare(const spConnection &conn, HttpRequest &request, HttpResponse *response)
+{
+    // 1. 验证用户会话（整批只验证一次）
+    std::string cookie = request.GetHeader("Cookie");
+    std::string sessionId = ParseCookie(cookie, "session_id");
+    int userId;
+    std::string usernameFromSession;
+
+    if (!ValidateSession(sessionId, userId, usernameFromSession)) 
+    {
+        SendBadRequestResponse(conn, HttpStatusCode::k401Unauthorized, "未登录或会话已过期");
+        return;
+    }
 
-            if (checkResult && mysql_num_rows(checkResult) > 0) 
-            {
-                if (checkResult) mysql_free_result(checkResult);
-                LOG_WARN << "已经分享给该用户";
-                SendBadRequestResponse(conn, HttpStatusCode::k400BadRequest, "已经分享给该用户");
-                return;
-            }
-            if (checkResult) mysql_free_result(checkResult);
-        }
-        // 处理受保护分享（生成提取码）
-        else if (shareType == "protected") 
+    // 2. 解析请求：文件 ID 列表去重，分享参数对整批生效
+    std::vector<int> fileIds;
+    std::string shareType;
+    std::string expireStr = "NULL";
+    std::string sharedWithId = "NULL";
+    try
+    {
+        json requestData = json::parse(request.GetBody());
+        for (const auto& item : requestData.at("fileIds")) fileIds.push_back(item.get<int>());
+        shareType = requestData.at("shareType").get<std::string>();
+        if (requestData.contains("expireTime") && !requestData["expireTime"].is_null())
         {
-            extractCode = "'" + GenerateExtractCode() + "'";
+            int expireHours = requestData["expireTime"];
+            if (expireHours > 0) expireStr = "DATE_ADD(NOW(), INTERVAL " + std::to_string(expireHours) + " HOUR)";
         }
+        if (shareType == "user") sharedWithId = std::to_string(requestData.at("sharedWithId").get<int>());
+    }
+    catch (const std::exception& e)
+    {
+        LOG_WARN << "HandleBatchShare 请求格式错误: " << e.what();
+        SendBadRequestResponse(conn, HttpStatusCode::k400BadRequest, "请求格式错误");
+        return;
+    }
+    if (shareType != "private" && shareType != "public" && shareType != "protected" && shareType != "user")
+    {
+        SendBadRequestResponse(conn, HttpStatusCode::k400BadRequest, "请求格式错误");
+        return;
+    }
+    std::sort(fileIds.begin(), fileIds.end());
+    fileIds.erase(std::unique(fileIds.begin(), fileIds.end()), fileIds.end());
+    if (fileIds.empty() || fileIds.size() > kBatchMaxItems)
+    {
+        SendBadRequestResponse(conn, HttpStatusCode::k400BadRequest, "文件数量无效");
+        return;
+    }
 
-        // 插入分享记录
-        std::string insertQuery = "INSERT INTO file_shares (file_id, owner_id, shared_with_id, share_type, share_code, extract_code, expire_time) VALUES (" +
-                                  std::to_string(fileId) + ", " +
-                                  std::to_string(userId) + ", " +
-                                  sharedWithId + ", '" +
-                                  EscapeString(shareType, mysqlConn->GetRawConnection()) + "', '" +
-                                  EscapeString(shareCode, mysqlConn->GetRawConnection()) + "', " +
-                                  extractCode + ", " +
-                                  expireStr + ")";
+    std::shared_ptr<MySqlConnection> mysqlConn = mysqlPool_->GetConnection();
+    if (!mysqlConn)
+    {
+        SendBadRequestResponse(conn, HttpStatusCode::k503ServiceUnavailable, "服务繁忙，请稍后重试");
+        return;
+    }
+    MYSQL* mysql = mysqlConn->GetRawConnection();
 
-        int shareID = mysqlConn->Update(insertQuery);
-        if (!shareID) 
+    // 3. 一个事务：锁定属于当前用户的文件，按集合删除或插入分享记录
+    std::vector<int> owned;
+    std::vector<int> skipped;                           // 已分享给该用户，不重复分享
+    std::vector<std::pair<int, std::string>> created;   // <文件 ID, 分享码>
+    std::vector<std::string> extractCodes;              // 与 created 对应的提取码（protected）
+    uint64_t removed = 0;
+    bool ok = mysqlConn->BeginTransaction();
+    if (ok)
+    {
+        MYSQL_RES* result = mysqlConn->Query("SELECT id FROM files WHERE user_id = " + std::to_string(userId) +
+                                             " AND id IN (" + SqlIdList(fileIds) + ") FOR UPDATE");
+        ok = result != nullptr;
+        if (result)
         {
-            LOG_ERROR << "创建分享失败";
-            SendBadRequestResponse(conn, HttpStatusCode::k500InternalServerError, "创建分享失败");
-            return;
+            MYSQL_ROW row;
+            while ((row = mysql_fetch_row(result))) owned.push_back(std::stoi(row[0]));
+            mysql_free_result(result);
+        }
+        std::sort(owned.begin(), owned.end());
+    }
+    if (ok && !owned.empty() && shareType == "private")
+    {
+        long long rows = mysqlConn->Execute("DELETE FROM file_shares WHERE file_id IN (" + SqlIdList(owned) + ")");
+        ok = rows >= 0;
+        if (ok) removed = static_cast<uint64_t>(rows);
+    }
+    else if (ok && !owned.empty())
+    {
+        std::vector<int> targets = owned;
+        if (shareType == "user")
+        {
+            MYSQL_RES* result = mysqlConn->Query("SELECT DISTINCT file_id FROM file_shares WHERE file_id IN (" +
+                                                 SqlIdList(owned) + ") AND shared_with_id = " + sharedWithId +
+                                                 " AND share_type = 'user'");
+            ok = result != nullptr;
+            if (result)
+            {
+                MYSQL_ROW row;
+                while ((row = mysql_fetch_row(result))) skipped.push_back(std::stoi(row[0]));
+                mysql_free_result(result);
+            }
+            std::sort(skipped.begin(), skipped.end());
+            targets.clear();
+            std::set_difference(owned.begin(), owned.end(), skipped.begin(), skipped.end(), std::back_inserter(targets));
         }
 
-        // 构建返回的 JSON 响应体
-        json jsonStr = {
-            {"code", 0},
-            {"message", "分享成功"},
-            {"shareId", shareID},
-            {"shareType", shareType},
-            {"shareCode", shareCode},
-            {"shareLink", "/share/" + shareCode}
-        };
-
-        if (shareType == "user") 
+        // 一条多行 INSERT 写入整批分享记录
+        std::string values;
+        for (int fileId : targets)
         {
-            jsonStr["sharedWithId"] = std::stoi(sharedWithId);
-        } 
-        else if (shareType == "protected") 
+            std::string shareCode = GenerateShareCode();
+            std::string extractCode = shareType == "protected" ? GenerateExtractCode() : "";
+            if (!values.empty()) values += ", ";
+            values += "(" + std::to_string(fileId) + ", " + std::to_string(userId) + ", " + sharedWithId + ", '" +
+                      EscapeString(shareType, mysql) + "', '" + shareCode + "', " +
+                      (extractCode.empty() ? "NULL" : "'" + extractCode + "'") + ", " + expireStr + ")";
+            created.emplace_back(fileId, shareCode);
+            extractCodes.push_back(extractCode);
+        }
+        if (ok && !values.empty())
         {
-            // 去除引号包裹的提取码
-            jsonStr["extractCode"] = extractCode.substr(1, extractCode.length() - 2);
+            ok = mysqlConn->Execute("INSERT INTO file_shares (file_id, owner_id, shared_with_id, share_type, share_code, "
+                                    "extract_code, expire_time) VALUES " + values) >= 0;
         }
-
-        // 设置 HTTP 响应内容
-        response->SetStatusCode(HttpStatusCode::k200OK);
-        response->SetStatusMessage("OK");
-        response->SetContentType("application/json");
-        response->AddHeader("Connection", "close");
-        response->SetBody(jsonStr.dump());
-
-        const std::string& resp = response->ResponseMessage();
-        conn->SendData(resp.data(), resp.size());
-        conn->SetSendCompleteCallback(std::bind(&HttpServer::HandleSendComplete, this, std::placeholders::_1));
     }
-    catch (const std::exception& e) 
+    if (!ok || !mysqlConn->Commit())
     {
-        LOG_ERROR << "分享文件错误: " << e.what();
-        SendBadRequestResponse(conn, HttpStatusCode::k500InternalServerError, "分享失败: " + std::string(e.what()));
+        mysqlConn->Rollback();
+        LOG_ERROR << "批量分享失败, user " << userId << ", " << fileIds.size() << " files";
+        SendBadRequestResponse(conn, HttpStatusCode::k500InternalServerError, "批量分享失败");
         return;
     }
+
+    // 4. 事务已提交：更新缓存与分享码过滤器
+    for (int fileId : owned) fileMetaCache_.InvalidateFileId(fileId);
+    for (const auto& share : created) shareCodes_.Add(share.second);
+    if (removed > 0) shareCodes_.NoteRemoved(static_cast<size_t>(removed));
+
+    json shares = json::array();
+    for (size_t i = 0; i < created.size(); ++i)
+    {
+        json share = {
+            {"fileId", created[i].first},
+            {"shareCode", created[i].second},
+            {"shareLink", "/share/" + created[i].second}
+        };
+        if (!extractCodes[i].empty()) share["extractCode"] = extractCodes[i];
+        shares.push_back(share);
+    }
+
+    // 不存在或不属于当前用户的文件 ID
+    std::vector<int> failed;
+    std::set_difference(fileIds.begin(), fileIds.end(), owned.begin(), owned.end(), std::back_inserter(failed));
+    LOG_INFO << "batch share: user " << userId << ", type " << shareType << ", files " << owned.size()
+             << ", created " << created.size() << ", removed " << removed << ", failed " << failed.size();
+
+    json jsonStr = {
+        {"code", 0},
+        {"message", shareType == "private" ? "文件设置为私有成功" : "分享成功"},
+        {"shareType", shareType},
+        {"shares", shares},
+        {"skipped", skipped},
+        {"failed", failed}
+    };
+    response->SetStatusCode(HttpStatusCode::k200OK);
+    response->SetStatusMessage("OK");
+    response->SetContentType("application/json");
+    response->SetBody(jsonStr.dump());
+
+    SendResponse(conn, response);
 }
 
 // 通过分享码访问文件
@@ -1366,33 +2487,22 @@ void HttpServer::HandleShareAccess(const spConnection &conn, HttpRequest &reques
         // 获取提取码（可选）
         std::string extractCode = request.GetRequestParamsByKey("code");
 
-        // 查询分享信息（文件 + 用户）
-        std::shared_ptr<MySqlConnection> mysqlConn = mysqlPool_->GetConnection();
-        std::string query = "SELECT fs.*, f.filename, f.original_filename, f.file_size, "
-                            "f.file_type, u.username as owner_username, f.user_id "
-                            "FROM file_shares fs "
-                            "JOIN files f ON fs.file_id = f.id "
-                            "JOIN users u ON f.user_id = u.id "
-                            "WHERE fs.share_code = '" + EscapeString(shareCode, mysqlConn->GetRawConnection()) + "' "
-                            "AND (fs.expire_time IS NULL OR fs.expire_time > NOW()) "
-                            "AND (fs.share_type != 'protected' OR (fs.share_type = 'protected' AND fs.extract_code = '" + EscapeString(extractCode, mysqlConn->GetRawConnection()) + "'))";
-
-        LOG_INFO << "query = " << query;
-        MYSQL_RES* result = mysqlConn->Query(query);
+        // 查询分享信息（文件 + 用户），优先读元数据缓存
+        std::shared_ptr<const FileMeta> meta = LoadFileMetaByShareCode(shareCode);
+        const ShareMeta* share = meta ? meta->FindShare(shareCode, time(nullptr)) : nullptr;
 
-        if (!result || mysql_num_rows(result) == 0) 
+        // 受保护分享提取码不匹配时与分享不存在同样处理
+        if (!share || (share->shareType == "protected" && share->extractCode != extractCode)) 
         {
-            if (result) mysql_free_result(result);
             LOG_ERROR << "分享链接已失效或不存在";
             SendBadRequestResponse(conn, HttpStatusCode::k404NotFound, "分享链接已失效或不存在");
             return;
         }
 
-        MYSQL_ROW row = mysql_fetch_row(result);
-        std::string shareType = row[4];  // fs.share_type
-        bool isOwner = (row[13] && std::stoi(row[13]) == userId);  // 当前用户是否为文件所有者
-        int sharedWithId = row[3] ? std::stoi(row[3]) : 0;         // fs.shared_with_id
-        std::string dbExtractCode = row[5] ? row[5] : "";          // fs.extract_code
+        std::string shareType = share->shareType;
+        bool isOwner = (meta->ownerId == userId);      // 当前用户是否为文件所有者
+        int sharedWithId = share->sharedWithId;
+        std::string dbExtractCode = share->extractCode;
 
         // 权限判断逻辑
         bool hasPermission = false;
@@ -1421,7 +2531,6 @@ void HttpServer::HandleShareAccess(const spConnection &conn, HttpRequest &reques
 
         if (!hasPermission) 
         {
-            mysql_free_result(result);
             if (shareType == "protected" && (extractCode.empty() || extractCode != dbExtractCode)) 
             {
                 LOG_ERROR << "需要正确的提取码";
@@ -1440,26 +2549,24 @@ void HttpServer::HandleShareAccess(const spConnection &conn, HttpRequest &reques
             {"code", 0},
             {"message", "success"},
             {"file", {
-                {"id", std::stoi(row[0])},
-                {"fileId", std::stoi(row[1])},
-                {"ownerId", std::stoi(row[2])},
-                {"sharedWithId", row[3] ? std::stoi(row[3]) : 0},
+                {"id", share->id},
+                {"fileId", meta->id},
+                {"ownerId", meta->ownerId},
+                {"sharedWithId", sharedWithId},
                 {"shareType", shareType},
                 {"shareCode", shareCode},
-                {"createdAt", row[6] ? row[6] : ""},
-                {"expireTime", row[7] ? row[7] : ""},
-                {"filename", row[8] ? row[8] : ""},
-                {"originalName", row[9] ? row[9] : ""},
-                {"size", row[10] ? std::stoull(row[10]) : 0},
-                {"type", row[11] ? row[11] : "unknown"},
-                {"ownerUsername", row[12] ? row[12] : ""},
+                {"createdAt", share->createdAt},
+                {"expireTime", share->expireTime},
+                {"filename", meta->filename},
+                {"originalName", meta->originalName},
+                {"size", meta->size},
+                {"type", meta->fileType.empty() ? "unknown" : meta->fileType},
+                {"ownerUsername", meta->ownerUsername},
                 {"isOwner", isOwner}
             }},
-            {"downloadUrl", "/share/download/" + std::string(row[8] ? row[8] : "") + "?code=" + shareCode}
+            {"downloadUrl", "/share/download/" + meta->filename + "?code=" + shareCode}
         };
 
-        mysql_free_result(result);
-
         response->SetStatusCode(HttpStatusCode::k200OK);
         response->SetStatusMessage("OK");
         response->SetContentType("application/json");
@@ -1476,16 +2583,14 @@ void HttpServer::HandleShareAccess(const spConnection &conn, HttpRequest &reques
 
     response->AddHeader("Connection", "close");
 
-    const std::string& resp = response->ResponseMessage();
-    conn->SendData(resp.data(), resp.size());
+    SendResponse(conn, response);
     conn->SetSendCompleteCallback(std::bind(&HttpServer::HandleSendComplete, this, std::placeholders::_1));
 }
 
 
 // 处理通过分享链接下载文件（支持权限判断与断点续传）
-void HttpServer::HandleShareDownload(const spConnection &conn, HttpRequest &request, HttpResponse *response)
+void HttpServer::HandleShareDownload(const spConnection &conn, HttpRequest &request, HttpResponse *)
 {
-    response->SetAsync(true);
     // 获取路径参数中的文件名
     std::string filename = request.GetRequestParamsByKey("filename");
     if (filename.empty()) 
@@ -1511,34 +2616,28 @@ void HttpServer::HandleShareDownload(const spConnection &conn, HttpRequest &requ
     std::string usernameFromSession;
     bool isAuthenticated = ValidateSession(sessionId, userId, usernameFromSession);
 
-    std::shared_ptr<MySqlConnection> mysqlConn = mysqlPool_->GetConnection();
-    // 构建查询语句以查找对应的分享信息
-    std::string query = "SELECT f.id, f.filename, f.original_filename, f.user_id, "
-                        "fs.share_type, fs.shared_with_id, fs.extract_code "
-                        "FROM files f "
-                        "JOIN file_shares fs ON f.id = fs.file_id "
-                        "WHERE f.filename = '" + EscapeString(filename, mysqlConn->GetRawConnection()) + "' "
-                        "AND fs.share_code = '" + EscapeString(shareCode, mysqlConn->GetRawConnection()) + "' "
-                        "AND (fs.expire_time IS NULL OR fs.expire_time > NOW())";
-
-    MYSQL_RES* result = mysqlConn->Query(query);
-    if (!result || mysql_num_rows(result) == 0) 
-    {
-        if (result) mysql_free_result(result);
+    // 查找文件及对应的未过期分享（优先读元数据缓存），不存在的分享码直接拒绝
+    if (!shareCodes_.MayExist(shareCode)) 
+    {
+        SendBadRequestResponse(conn, HttpStatusCode::k404NotFound, "Share not found or expired");
+        return;
+    }
+    std::shared_ptr<const FileMeta> meta = LoadFileMeta(filename);
+    const ShareMeta* share = meta ? meta->FindShare(shareCode, time(nullptr)) : nullptr;
+    if (!share) 
+    {
         LOG_ERROR << "Share not found or expired";
         SendBadRequestResponse(conn, HttpStatusCode::k404NotFound, "Share not found or expired");
         return;
     }
 
     // 解析分享记录字段
-    MYSQL_ROW row = mysql_fetch_row(result);
-    std::string serverFilename = row[1];
-    std::string originalFilename = row[2];
-    int fileOwnerId = std::stoi(row[3]);
-    std::string shareType = row[4];
-    int sharedWithId = row[5] ? std::stoi(row[5]) : 0;
-    std::string dbExtractCode = row[6] ? row[6] : "";
-    mysql_free_result(result);
+    std::string serverFilename = meta->filename;
+    std::string originalFilename = meta->originalName;
+    int fileOwnerId = meta->ownerId;
+    std::string shareType = share->shareType;
+    int sharedWithId = share->sharedWithId;
+    std::string dbExtractCode = share->extractCode;
 
     // 权限判断
     bool hasPermission = false;
@@ -1566,110 +2665,8 @@ void HttpServer::HandleShareDownload(const spConnection &conn, HttpRequest &requ
         return;
     }
 
-    // 构造文件路径
-    std::string filepath = uploadDir_ + "/" + serverFilename;
-    if (!fs::exists(filepath) || !fs::is_regular_file(filepath)) 
-    {
-        LOG_ERROR << "File not found file";
-        SendBadRequestResponse(conn, HttpStatusCode::k404NotFound, "File not found");
-        return;
-    }
-
-    uintmax_t fileSize = fs::file_size(filepath); // 获取文件大小
-    uintmax_t startPos = 0, endPos = fileSize - 1;
-    bool isRangeRequest = false;
-
-    // 解析 Range 请求头（支持断点续传）
-    std::string rangeHeader = request.GetHeader("Range");
-    if (!rangeHeader.empty()) 
-    {
-        std::regex rangeRegex("bytes=(\\d+)-(\\d*)");
-        std::smatch matches;
-        if (std::regex_search(rangeHeader, matches, rangeRegex)) 
-        {
-            startPos = std::stoull(matches[1]);
-            if (matches[2].matched && !matches[2].str().empty()) 
-            {
-                endPos = std::stoull(matches[2]);
-            }
-            if (startPos >= fileSize) 
-            {
-                LOG_ERROR << "Range Not Satisfiable";
-                SendBadRequestResponse(conn, HttpStatusCode::k416RangeNotSatisfiable, "Range Not Satisfiable");
-                return;
-            }
-            if (endPos >= fileSize) 
-            {
-                endPos = fileSize - 1;
-            }
-            isRangeRequest = true;
-        }
-    }
-
-    // 获取连接上下文（HttpContext）
-    auto httpContext = std::static_pointer_cast<HttpContext>(conn->GetContext());
-    if (!httpContext) 
-    {
-        LOG_ERROR << "Internal Server Error";
-        SendBadRequestResponse(conn, HttpStatusCode::k500InternalServerError, "Internal Server Error");
-        return;
-    }
-
-    // 尝试获取已存在的下载上下文
-    std::shared_ptr<FileDownContext> downContext = httpContext->GetContext<FileDownContext>();
-    if (!downContext) 
-    {
-        // 创建新下载上下文并绑定到 HttpContext
-        downContext = std::make_shared<FileDownContext>(filepath, originalFilename);
-        httpContext->SetContext(downContext);
-
-        // 构造响应头
-        if (isRangeRequest) 
-        {
-            response->SetStatusCode(HttpStatusCode::k206PartialContent);
-            response->SetStatusMessage("Partial Content");
-            response->AddHeader("Content-Range", "bytes " + std::to_string(startPos) + "-" +
-                                               std::to_string(endPos) + "/" +
-                                               std::to_string(fileSize));
-        } 
-        else 
-        {
-            response->SetStatusCode(HttpStatusCode::k200OK);
-            response->SetStatusMessage("OK");
-        }
-
-        response->SetContentType("application/octet-stream");
-        response->AddHeader("Content-Disposition", "attachment; filename=\"" + originalFilename + "\"");
-        response->AddHeader("Transfer-Encoding", "chunked");  // 关键设置
-        response->AddHeader("Accept-Ranges", "bytes");
-        response->AddHeader("Connection", "keep-alive");
-
-        // 发送消息头部
-        const std::string& resp = response->ResponseMessage();
-        conn->SendData(resp.data(), resp.size());
-
-        downContext->SeekTo(startPos); // 定位文件指针
-    }
-
-    // 继续读取数据并发送给客户端
-    // 设置发送完成回调
-    conn->SetSendCompleteCallback([this, downContext](spConnection c) 
-    {
-        std::string chunk;
-        if (downContext->ReadNextChunk(chunk)) {
-            // 格式：<chunk-size>\r\n<chunk-data>\r\n
-            std::ostringstream oss;
-            oss << std::hex << chunk.size() << "\r\n" << chunk << "\r\n";
-            std::string chunkedData = oss.str();
-            c->SendData(chunkedData.data(), chunkedData.size());
-        } 
-        else 
-        {
-            // 结尾块：0\r\n\r\n，表示发送完成
-            c->SendData("0\r\n\r\n", 5);
-            c->SetSendCompleteCallback(std::bind(&HttpServer::HandleSendComplete, this, std::placeholders::_1));
-        }
-    });
+    // 打开并发送文件内容（支持断点续传与多范围请求）
+    SendStoredFile(conn, request, serverFilename, originalFilename, meta->contentHash);
 }
 
 // 处理获取分享信息请求（校验分享码、提取码，并返回文件元信息）
@@ -1687,64 +2684,40 @@ void HttpServer::HandleShareInfo(const spConnection &conn, HttpRequest &request,
     std::string extractCode = request.GetRequestParamsByKey("extract_code");
     LOG_INFO << "shareCode = " << shareCode << ", extractCode = " << extractCode;
 
-    std::shared_ptr<MySqlConnection> mysqlConn = mysqlPool_->GetConnection();
-    // 构造 SQL 查询，获取分享信息 + 文件信息 + 拥有者用户名
-    std::string query = "SELECT fs.*, f.filename, f.original_filename, f.file_size, "
-                        "f.file_type, u.username AS owner_username, f.user_id "
-                        "FROM file_shares fs "
-                        "JOIN files f ON fs.file_id = f.id "
-                        "JOIN users u ON f.user_id = u.id "
-                        "WHERE fs.share_code = '" + EscapeString(shareCode, mysqlConn->GetRawConnection()) + "' "
-                        "AND (fs.expire_time IS NULL OR fs.expire_time > NOW())";
-
-    LOG_INFO << "查询分享信息: " << query;
-    MYSQL_RES* result = mysqlConn->Query(query);
-    if (!result || mysql_num_rows(result) == 0) 
-    {
-        if (result) mysql_free_result(result);
+    // 按分享码获取文件元数据及分享记录（优先读缓存）
+    std::shared_ptr<const FileMeta> meta = LoadFileMetaByShareCode(shareCode);
+    const ShareMeta* share = meta ? meta->FindShare(shareCode, time(nullptr)) : nullptr;
+    if (!share) 
+    {
         LOG_ERROR << "分享链接已失效或不存在, shareCode = " << shareCode;
         SendBadRequestResponse(conn, HttpStatusCode::k404NotFound, "分享链接已失效或不存在");
         return;
     }
 
-    // 提取查询结果字段（按顺序索引）
-    MYSQL_ROW row = mysql_fetch_row(result);
-    std::string shareType = row[4]; // fs.share_type
-    std::string dbExtractCode = row[8] ? row[8] : ""; // fs.extract_code
-    std::string serverFilename = row[9] ? row[9] : ""; // f.filename
-    std::string originalFilename = row[10] ? row[10] : ""; // f.original_filename
-    uintmax_t fileSize = row[11] ? std::stoull(row[11]) : 0; // f.file_size
-    std::string fileType = row[12] ? row[12] : "unknown"; // f.file_type
-    std::string createdAt = row[7] ? row[7] : ""; // fs.created_at
-    std::string expireTime = row[6] ? row[6] : ""; // fs.expire_time
-
     // 若分享类型为 protected，需校验提取码
-    if (shareType == "protected") 
+    if (share->shareType == "protected") 
     {
-        if (extractCode.empty() || extractCode != dbExtractCode) 
+        if (extractCode.empty() || extractCode != share->extractCode) 
         {
-            mysql_free_result(result);
             LOG_ERROR << "提取码错误或未提供, shareCode = " << shareCode;
             SendBadRequestResponse(conn, HttpStatusCode::k403Forbidden, "需要正确的提取码");
             return;
         }
     }
 
-    mysql_free_result(result);
-
     // 构建响应 JSON
     json jsonStr = {
         {"code", 0},
         {"message", "success"},
-        {"shareType", shareType},
+        {"shareType", share->shareType},
         {"file", {
-            {"id", std::stoi(row[1])}, // fs.file_id
-            {"name", serverFilename},
-            {"originalName", originalFilename},
-            {"size", fileSize},
-            {"type", fileType},
-            {"shareTime", createdAt},
-            {"expireTime", expireTime}
+            {"id", meta->id},
+            {"name", meta->filename},
+            {"originalName", meta->originalName},
+            {"size", meta->size},
+            {"type", meta->fileType.empty() ? "unknown" : meta->fileType},
+            {"shareTime", share->createdAt},
+            {"expireTime", share->expireTime}
         }}
     };
 
@@ -1755,54 +2728,28 @@ void HttpServer::HandleShareInfo(const spConnection &conn, HttpRequest &request,
     response->AddHeader("Connection", "close");
     response->SetBody(jsonStr.dump());
 
-    const std::string& resp = response->ResponseMessage();
-    conn->SendData(resp.data(), resp.size());
+    SendResponse(conn, response);
     conn->SetSendCompleteCallback(std::bind(&HttpServer::HandleSendComplete, this, std::placeholders::_1));
 }
 
 // 处理 favicon.ico 请求（返回浏览器标签页图标）
 void HttpServer::HandleFavicon(const spConnection &conn, HttpRequest &request, HttpResponse *response) 
 {
-    // 获取当前源文件的路径（__FILE__ 是预定义宏，表示当前源文件绝对路径）
-    std::string currentDir = __FILE__;
-
-    // 提取当前目录（从文件路径中去掉文件名部分）
-    std::string::size_type pos = currentDir.find_last_of('/');
-    std::string projectRoot = (pos != std::string::npos) ? currentDir.substr(0, pos) : ".";
-
-    // 构造 favicon.ico 的完整路径（假设位于项目根目录）
-    std::string faviconPath = projectRoot + "/favicon.ico";
-
-    // 打开 favicon 文件（二进制方式读取）
-    std::ifstream file(faviconPath, std::ios::binary);
-    if (!file.is_open()) 
+    std::shared_ptr<const StaticAsset> asset = staticCache_.Get("/favicon.ico");
+    if (!asset) 
     {
-        // 打开失败，返回 404 响应
+        // 图标不存在，返回 404 响应
         LOG_ERROR << "Failed to open favicon.ico";
         response->SetStatusCode(HttpStatusCode::k404NotFound);
         response->SetStatusMessage("Not Found");
         response->SetContentType("image/x-icon");
-        response->AddHeader("Connection", "close");
         response->SetBody("");
-    } 
-    else 
-    {
-        // 读取文件全部内容到字符串
-        std::string iconData((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-        file.close();
 
-        // 构造成功响应，设置图标数据
-        response->SetStatusCode(HttpStatusCode::k200OK);
-        response->SetStatusMessage("OK");
-        response->SetContentType("image/x-icon");  // 设置 MIME 类型
-        response->AddHeader("Connection", "close");
-        response->SetBody(iconData);
+        SendResponse(conn, response);
+        return;
     }
 
-    // 设置写完成回调，关闭连接
-    const std::string& resp = response->ResponseMessage();
-    conn->SendData(resp.data(), resp.size());
-    conn->SetSendCompleteCallback(std::bind(&HttpServer::HandleSendComplete, this, std::placeholders::_1));
+    SendStaticAsset(conn, request, response, asset);
 }
 
 // 用户注册
@@ -1863,6 +2810,7 @@ void HttpServer::HandleRegister(const spConnection &conn, HttpRequest &request,
             SendBadRequestResponse(conn, HttpStatusCode::k500InternalServerError, "注册失败，请稍后重试");
             return;
         }
+        userIndex_.Add(static_cast<int>(mysql_insert_id(mysql)), username, email);
 
         // 6. 构造响应 JSON
         json jsonStr = 
@@ -1880,8 +2828,7 @@ void HttpServer::HandleRegister(const spConnection &conn, HttpRequest &request,
         response->SetBody(jsonStr.dump());
 
         // 8. 设置连接写完成回调，关闭连接
-        const std::string& resp = response->ResponseMessage();
-        conn->SendData(resp.data(), resp.size());
+        SendResponse(conn, response);
         conn->SetSendCompleteCallback(std::bind(&HttpServer::HandleSendComplete, this, std::placeholders::_1));
     } 
     catch (const std::exception& e) 
@@ -1957,8 +2904,7 @@ void HttpServer::HandleLogin(const spConnection &conn, HttpRequest &request, Htt
         response->SetBody(jsonStr.dump());
 
         // 设置写回调关闭连接
-        const std::string& resp = response->ResponseMessage();
-        conn->SendData(resp.data(), resp.size());
+        SendResponse(conn, response);
         return;
     } 
     catch (const std::exception& e) 
@@ -1997,8 +2943,7 @@ void HttpServer::HandleLogout(const spConnection &conn, HttpRequest &request, Ht
     response->SetBody(jsonStr.dump());
 
     // 设置连接写完成后自动关闭连接
-    const std::string& resp = response->ResponseMessage();
-    conn->SendData(resp.data(), resp.size());
+    SendResponse(conn, response);
     conn->SetSendCompleteCallback(std::bind(&HttpServer::HandleSendComplete, this, std::placeholders::_1));
 }
 
@@ -2029,39 +2974,21 @@ void HttpServer::HandleSearchUsers(const spConnection &conn, HttpRequest &reques
         return;
     }
 
-    // 构造模糊搜索 SQL 查询（排除当前用户）
-    std::shared_ptr<MySqlConnection> mysqlConn = mysqlPool_->GetConnection();
-    std::string sqlQuery = "SELECT id, username, email FROM users WHERE username LIKE '%" +
-                           EscapeString(keyword, mysqlConn->GetRawConnection()) + "%' AND id != " + std::to_string(userId) +
-                           " LIMIT 10";
-    LOG_INFO << "sqlQuery = " << sqlQuery;
-
-    // 执行 SQL 查询
-    MYSQL_RES* result = mysqlConn->Query(sqlQuery);
+    // 在用户名索引中查找（排除当前用户），前缀匹配排在前面
+    std::vector<UserSearchIndex::User> matches = userIndex_.Search(keyword, userId, kUserSearchLimit);
 
     // 构造响应 JSON
     json jsonStr;
     jsonStr["code"] = 0;
     jsonStr["message"] = "Success";
     json users = json::array();
-
-    // 遍历查询结果，添加用户信息到数组
-    if (result) 
+    for (const UserSearchIndex::User& user : matches) 
     {
-        MYSQL_ROW row;
-        while ((row = mysql_fetch_row(result))) 
-        {
-            int id = std::stoi(row[0]);
-            std::string usernameFromDb = row[1] ? row[1] : "";
-            std::string email = row[2] ? row[2] : "";
-
-            users.push_back({
-                {"id", id},
-                {"username", usernameFromDb},
-                {"email", email}
-            });
-        }
-        mysql_free_result(result);
+        users.push_back({
+            {"id", user.id},
+            {"username", user.username},
+            {"email", user.email}
+        });
     }
 
     // 设置最终响应内容
@@ -2075,59 +3002,25 @@ void HttpServer::HandleSearchUsers(const spConnection &conn, HttpRequest &reques
     LOG_INFO << "response = " << jsonStr.dump();
 
     // 写完成后关闭连接
-    const std::string& resp = response->ResponseMessage();
-    conn->SendData(resp.data(), resp.size());
+    SendResponse(conn, response);
 
     conn->SetSendCompleteCallback(std::bind(&HttpServer::HandleSendComplete, this, std::placeholders::_1));
 }
 
-// 加载文件映射
+// 加载文件名映射：重放追加式日志，日志为空时导入旧版 JSON 映射文件
 void HttpServer::LoadFileNameMap() 
 {
-    std::lock_guard<std::mutex> lock(mapMutex_);
-    LoadFileNameMapInternal();
-}
-
-// 内部函数，不加锁，加载文件名映射
-void HttpServer::LoadFileNameMapInternal() 
-{
-     try 
-    {
-        if (fs::exists(mapFile_)) 
-        {
-            std::ifstream file(mapFile_);
-            fileNameMap_ = json::parse(file).get<std::map<std::string, std::string>>();
-        }
-    }
-    catch (const std::exception& e) 
+    auto start = std::chrono::steady_clock::now();
+    if (!fileNameJournal_.Open())
     {
-        LOG_ERROR << "Failed to load filename mapping: " << e.what();
+        LOG_ERROR << "Failed to open filename journal for " << mapFile_;
+        return;
     }
-}
-
-// 保存文件名映射
-void HttpServer::SaveFileNameMap() 
-{
-    // 使用锁保护，防止多线程访问时发生数据竞争
-    std::lock_guard<std::mutex> lock(mapMutex_);
-    SaveFileNameMapInternal();
-}
+    size_t imported = fileNameJournal_.ImportJson(mapFile_);
+    if (imported > 0) LOG_INFO << "Imported " << imported << " filename mappings from " << mapFile_;
 
-void HttpServer::SaveFileNameMapInternal() 
-{
-    try 
-    {
-        // 打开文件进行写入，若文件不存在会创建文件
-        std::ofstream file(mapFile_);
-        
-        // 将 filenameMap_ 序列化为 JSON 格式，并格式化为 2 个空格的缩进
-        file << json(fileNameMap_).dump(2);
-    } 
-    catch (const std::exception& e) 
-    {
-        // 捕获异常并打印错误日志
-        LOG_ERROR << "Failed to save filename map: " << e.what();
-    }
+    LOG_INFO << "Loaded " << fileNameJournal_.Size() << " filename mappings in "
+             << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count() << " ms";
 }
 
 // 初始化路由表
@@ -2146,11 +3039,18 @@ void HttpServer::InitRoutes()
     
     // 需要会话验证的路由
     AddRoute("/upload", Method::kPost, &HttpServer::HandleFileUpload);
+    AddRoute("/upload/sessions", Method::kPost, &HttpServer::HandleCreateUploadSession);
+    AddRoute("/upload/sessions/([^/]+)", Method::kGet, &HttpServer::HandleUploadSessionStatus, {"uploadId"});
+    AddRoute("/upload/sessions/([^/]+)", Method::kPut, &HttpServer::HandleUploadPart, {"uploadId"});
+    AddRoute("/upload/sessions/([^/]+)/commit", Method::kPost, &HttpServer::HandleCommitUploadSession, {"uploadId"});
+    AddRoute("/upload/sessions/([^/]+)", Method::kDelete, &HttpServer::HandleAbortUploadSession, {"uploadId"});
     AddRoute("/files", Method::kGet, &HttpServer::HandleListFiles);
     AddRoute("/download/([^/]+)", Method::kHead, &HttpServer::HandleDownload, {"filename"});
     AddRoute("/download/([^/]+)", Method::kGet, &HttpServer::HandleDownload, {"filename"});
     AddRoute("/delete/([^/]+)", Method::kDelete, &HttpServer::HandleDelete, {"filename"});
     AddRoute("/share", Method::kPost, &HttpServer::HandleShareFile);
+    AddRoute("/batch/delete", Method::kPost, &HttpServer::HandleBatchDelete);
+    AddRoute("/batch/share", Method::kPost, &HttpServer::HandleBatchShare);
     AddRoute("/users/search", Method::kGet, &HttpServer::HandleSearchUsers);
     AddRoute("/logout", Method::kPost, &HttpServer::HandleLogout);
 }
@@ -2180,10 +3080,13 @@ void HttpServer::SaveSession(const std::string& sessionId, int userId, const std
                         EscapeString(sessionId, mysqlConn->GetRawConnection()) + "', " +                  // 防止 SQL 注入
                         std::to_string(userId) + ", '" +
                         EscapeString(username, mysqlConn->GetRawConnection()) + "', " +
-                        "DATE_ADD(NOW(), INTERVAL 30 MINUTE))";           // 设置过期时间为当前时间 + 30分钟
+                        "DATE_ADD(NOW(), INTERVAL " + std::to_string(kSessionLifetime) + " SECOND))";  // 过期时间为当前时间 + 会话有效期
 
     // 执行 SQL 插入语句
     mysqlConn->Query(query);
+
+    // 登录后紧接着的请求可直接命中缓存
+    sessionCache_.Put(sessionId, userId, username, time(nullptr) + kSessionLifetime);
 }
 
 // 验证会话，检查 sessionId 是否有效
@@ -2196,42 +3099,53 @@ bool HttpServer::ValidateSession(const std::string& sessionId, int& userId, std:
         return false;
     }
 
+    // 2. 先查询进程内会话缓存，命中时不访问数据库
+    time_t sessionExpire = 0;
+    if (sessionCache_.Get(sessionId, userId, username, &sessionExpire))
+    {
+        RefreshSessionExpire(sessionId, sessionExpire);
+        return true;
+    }
+
     std::shared_ptr<MySqlConnection> mysqlConn = mysqlPool_->GetConnection();
-    // 2. 查询数据库，验证会话是否存在且未过期
-    std::string query = "SELECT user_id, username FROM sessions WHERE session_id = '" +
-                        EscapeString(sessionId, mysqlConn->GetRawConnection()) + "' AND expire_time > NOW()";
-    
-    // 执行查询并获取结果
-    MYSQL_RES* result = mysqlConn->Query(query);
+    // 3. 缓存未命中，查询数据库，验证会话是否存在且未过期（预处理语句，会话 ID 作为参数传输，无需转义）
+    MySqlStatement* stmt = mysqlConn ? mysqlConn->Prepare(
+        "SELECT user_id, username, UNIX_TIMESTAMP(expire_time) FROM sessions "
+        "WHERE session_id = ? AND expire_time > NOW()") : nullptr;
     
-    // 3. 如果查询失败或没有找到结果，返回 false
-    if (!result || mysql_num_rows(result) == 0) 
+    // 4. 如果查询失败或没有找到结果，返回 false
+    if (!stmt || !stmt->BindString(0, sessionId).Execute() || !stmt->Fetch()) 
     {
-        if (result) 
-        {
-            mysql_free_result(result);  // 释放查询结果
-        }
-        LOG_WARN << "mysql_num_rows is invalid";  // 记录警告日志
+        LOG_WARN << "session not found";  // 记录警告日志
         return false;
     }
 
-    // 4. 获取查询结果，填充 userId 和 username
-    MYSQL_ROW row = mysql_fetch_row(result);
-    userId = std::stoi(row[0]);  // 将查询结果中的 user_id 转换为 int
-    username = row[1];           // 获取用户名
+    // 5. 获取查询结果，填充 userId 和 username
+    userId = static_cast<int>(stmt->GetInt(0));
+    username = stmt->GetString(1);
+    sessionExpire = stmt->IsNull(2) ? 0 : static_cast<time_t>(stmt->GetInt(2));
 
-    // 5. 释放查询结果
-    mysql_free_result(result);
+    // 6. 释放查询结果
+    stmt->FreeResult();
 
-    // 6. 更新会话过期时间，延长 30 分钟
-    std::string updateQuery = "UPDATE sessions SET expire_time = DATE_ADD(NOW(), INTERVAL 30 MINUTE) WHERE session_id = '" +
-                              EscapeString(sessionId, mysqlConn->GetRawConnection()) + "'";
-    mysqlConn->Update(updateQuery);  // 执行更新会话过期时间的查询
+    // 7. 写入会话缓存，需要时登记延迟刷新（不再同步执行 UPDATE）
+    sessionCache_.Put(sessionId, userId, username, sessionExpire);
+    RefreshSessionExpire(sessionId, sessionExpire);
 
     LOG_INFO << "validateSession success";  // 记录日志
     return true;  // 返回会话有效
 }
 
+// 滑动过期：剩余有效期低于阈值时登记刷新，由后台任务合并写回数据库
+void HttpServer::RefreshSessionExpire(const std::string& sessionId, time_t sessionExpire)
+{
+    time_t now = time(nullptr);
+    if (sessionExpire - now >= kSessionRefreshThreshold) return;
+
+    sessionRefresher_.MarkForRefresh(sessionId);
+    sessionCache_.Touch(sessionId, now + kSessionLifetime);
+}
+
 // 结束会话，删除 session 数据
 void HttpServer::DeleteSession(const std::string& sessionId) 
 {
@@ -2241,13 +3155,102 @@ void HttpServer::DeleteSession(const std::string& sessionId)
         return;
     }
 
-    // 2. 删除会话
+    // 2. 删除会话（先使缓存失效，避免删除后仍被缓存判定为有效）
+    sessionCache_.Invalidate(sessionId);
+    sessionRefresher_.Cancel(sessionId);
     std::shared_ptr<MySqlConnection> mysqlConn = mysqlPool_->GetConnection();
     std::string query = "DELETE FROM sessions WHERE session_id = '" + EscapeString(sessionId, mysqlConn->GetRawConnection()) + "'";
     mysqlConn->Update(query);  // 执行删除会话的查询
 }
 
+// 获取文件元数据：缓存未命中时查询文件信息与全部分享记录后写入缓存
+std::shared_ptr<const FileMeta> HttpServer::LoadFileMeta(const std::string& filename)
+{
+    std::shared_ptr<const FileMeta> cached = fileMetaCache_.Get(filename);
+    if (cached) return cached;
+
+    uint64_t generation = fileMetaCache_.Generation();
+    std::shared_ptr<MySqlConnection> mysqlConn = mysqlPool_->GetConnection();
+    if (!mysqlConn) return nullptr;
+
+    // 1. 文件信息及所有者用户名
+    MySqlStatement* stmt = mysqlConn->Prepare(
+        "SELECT f.id, f.filename, f.original_filename, f.file_size, f.file_type, f.user_id, u.username, "
+        "f.content_hash "
+        "FROM files f LEFT JOIN users u ON f.user_id = u.id "
+        "WHERE f.filename = ?");
+    if (!stmt || !stmt->BindString(0, filename).Execute() || !stmt->Fetch()) return nullptr;
+
+    std::shared_ptr<FileMeta> meta = std::make_shared<FileMeta>();
+    meta->id = static_cast<int>(stmt->GetInt(0));
+    meta->filename = stmt->GetString(1);
+    meta->originalName = stmt->GetString(2);
+    meta->size = static_cast<uintmax_t>(stmt->GetInt(3));
+    meta->fileType = stmt->GetString(4);
+    meta->ownerId = static_cast<int>(stmt->GetInt(5));
+    meta->ownerUsername = stmt->GetString(6);
+    meta->contentHash = stmt->GetString(7);
+    stmt->FreeResult();
+
+    // 2. 该文件的全部分享记录（含已过期的，使用时按过期时间判断）
+    stmt = mysqlConn->Prepare(
+        "SELECT id, share_type, shared_with_id, share_code, extract_code, "
+        "UNIX_TIMESTAMP(expire_time), expire_time, created_at "
+        "FROM file_shares WHERE file_id = ?");
+    if (!stmt || !stmt->BindInt(0, meta->id).Execute()) return nullptr;
+    while (stmt->Fetch())
+    {
+        ShareMeta share;
+        share.id = static_cast<int>(stmt->GetInt(0));
+        share.shareType = stmt->GetString(1);
+        share.sharedWithId = static_cast<int>(stmt->GetInt(2));
+        share.shareCode = stmt->GetString(3);
+        share.extractCode = stmt->GetString(4);
+        share.expire = static_cast<time_t>(stmt->GetInt(5));
+        share.expireTime = stmt->GetString(6);
+        share.createdAt = stmt->GetString(7);
+        meta->shares.push_back(share);
+    }
+    if (stmt->Failed()) return nullptr;
+
+    fileMetaCache_.Put(meta, generation);
+    return meta;
+}
+
+// 按分享码获取文件元数据：缓存未命中时先由分享码查出文件名
+// 不存在的分享码（输错、已删除、暴力枚举）由过滤器直接拒绝，不占用数据库连接
+std::shared_ptr<const FileMeta> HttpServer::LoadFileMetaByShareCode(const std::string& shareCode)
+{
+    if (!shareCodes_.MayExist(shareCode)) return nullptr;
 
+    std::shared_ptr<const FileMeta> cached = fileMetaCache_.GetByShareCode(shareCode);
+    if (cached) return cached;
 
+    std::string filename;
+    {
+        std::shared_ptr<MySqlConnection> mysqlConn = mysqlPool_->GetConnection();
+        if (!mysqlConn) return nullptr;
 
+        MySqlStatement* stmt = mysqlConn->Prepare(
+            "SELECT f.filename FROM file_shares fs JOIN files f ON fs.file_id = f.id "
+            "WHERE fs.share_code = ?");
+        if (!stmt || !stmt->BindString(0, shareCode).Execute()) return nullptr;
+        if (stmt->Fetch())
+        {
+            filename = stmt->GetString(0);
+            stmt->FreeResult();
+        }
+        // 查询失败不是分享码不存在，不记入过滤器误判
+        else if (stmt->Failed())
+        {
+            return nullptr;
+        }
+    }
+    if (filename.empty()) 
+    {
+        shareCodes_.RecordMiss(shareCode);
+        return nullptr;
+    }
 
+    return LoadFileMeta(filename);
+}
@@ -0,0 +1,170 @@
+#include <string>
+#include <cstdlib>
+
+#include "QuotaManager.h"
+#include "Log.h"
+
+QuotaManager::QuotaManager(uint64_t defaultQuota)
+            : reservations_(std::make_shared<Reservations>()),
+              defaultQuota_(defaultQuota),
+              rejected_(0),
+              loads_(0),
+              corrected_(0)
+{}
+
+QuotaManager::~QuotaManager() {}
+
+// 从数据库加载用户用量
+bool QuotaManager::Load(int userId, ConnectionPool* pool, Usage* usage)
+{
+    std::shared_ptr<MySqlConnection> mysqlConn = pool->GetConnection();
+    if (!mysqlConn) return false;
+    std::string query = "SELECT storage_used, storage_quota FROM users WHERE id = " + std::to_string(userId);
+    MYSQL_RES* result = mysqlConn->Query(query);
+    if (!result) return false;
+
+    MYSQL_ROW row = mysql_fetch_row(result);
+    bool found = row != nullptr;
+    if (found)
+    {
+        usage->used = row[0] ? strtoull(row[0], nullptr, 10) : 0;
+        usage->quota = row[1] ? strtoull(row[1], nullptr, 10) : defaultQuota_;
+    }
+    mysql_free_result(result);
+    ++loads_;
+    return found;
+}
+
+// 配额检查并预留：缓存命中时只做两次哈希查找，检查与预留在同一把锁内完成
+std::shared_ptr<QuotaReservation> QuotaManager::TryReserve(int userId, uint64_t bytes, ConnectionPool* pool,
+                                                           uint64_t* used, uint64_t* quota)
+{
+    bool cached;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cached = usage_.count(userId) > 0;
+    }
+
+    // 未缓存时在锁外加载（查询数据库），加载期间其他线程可能已加载并更新了用量，以先到者为准
+    Usage loaded;
+    bool known = cached || Load(userId, pool, &loaded);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<std::mutex> reservedLock(reservations_->mutex);
+    uint64_t& reserved = reservations_->bytes[userId];
+    if (known)
+    {
+        const Usage& usage = cached ? usage_[userId] : usage_.insert({userId, loaded}).first->second;
+        uint64_t committed = usage.used + reserved;
+        if (used) *used = committed;
+        if (quota) *quota = usage.quota;
+        if (committed > usage.quota || bytes > usage.quota - committed)
+        {
+            if (reserved == 0) reservations_->bytes.erase(userId);
+            ++rejected_;
+            return nullptr;
+        }
+    }
+
+    // 数据库不可用或用户不存在时不拦截上传（由会话校验负责拒绝非法用户），仍登记预留，数据库恢复后计入检查
+    reserved += bytes;
+    return std::make_shared<QuotaReservation>(reservations_, userId, bytes);
+}
+
+// 更新用量：数据库中的计数直接加减，成功后再更新内存
+bool QuotaManager::Adjust(int userId, int64_t delta, MySqlConnection* conn)
+{
+    if (!AdjustStored(userId, delta, conn)) return false;
+    AdjustCached(userId, delta);
+    return true;
+}
+
+// 数据库中的计数加减（减到 0 为止）；失败时计数留待周期校正修复
+bool QuotaManager::AdjustStored(int userId, int64_t delta, MySqlConnection* conn)
+{
+    if (delta == 0) return true;
+
+    std::string query;
+    if (delta > 0)
+    {
+        query = "UPDATE users SET storage_used = storage_used + " + std::to_string(delta) +
+                " WHERE id = " + std::to_string(userId);
+    }
+    else
+    {
+        std::string amount = std::to_string(-delta);
+        query = "UPDATE users SET storage_used = IF(storage_used > " + amount + ", storage_used - " + amount +
+                ", 0) WHERE id = " + std::to_string(userId);
+    }
+    if (conn->Execute(query) < 0)
+    {
+        LOG_ERROR << "QuotaManager: adjust storage usage of user " << userId << " by " << delta << " failed";
+        return false;
+    }
+    return true;
+}
+
+// 内存中只更新已缓存的用户（未缓存的用户下次检查时从数据库加载）
+void QuotaManager::AdjustCached(int userId, int64_t delta)
+{
+    if (delta == 0) return;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = usage_.find(userId);
+    if (it == usage_.end()) return;
+    if (delta > 0)
+    {
+        it->second.used += static_cast<uint64_t>(delta);
+    }
+    else
+    {
+        uint64_t amount = static_cast<uint64_t>(-delta);
+        it->second.used = it->second.used > amount ? it->second.used - amount : 0;
+    }
+}
+
+// 按 files 表校正已用空间
+size_t QuotaManager::Reconcile(ConnectionPool* pool)
+{
+    // 1. 以 files 表为准重新计算，计数一致的行不会被修改，影响行数即为有偏差的用户数
+    //    失败（无可用连接、锁等待超时、死锁）时跳过本轮，保留内存缓存，下个周期再试
+    std::shared_ptr<MySqlConnection> mysqlConn = pool->GetConnection();
+    long long drifted = mysqlConn ? mysqlConn->Execute(
+        "UPDATE users u SET storage_used = "
+        "(SELECT COALESCE(SUM(f.file_size), 0) FROM files f WHERE f.user_id = u.id)") : -1;
+    if (drifted < 0)
+    {
+        LOG_WARN << "QuotaManager: reconcile skipped, keeping cached usage";
+        return 0;
+    }
+
+    // 2. 清空缓存，之后的检查从数据库重新加载校正后的值
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        usage_.clear();
+    }
+
+    if (drifted > 0)
+    {
+        corrected_ += static_cast<uint64_t>(drifted);
+        LOG_WARN << "QuotaManager: corrected storage usage of " << drifted << " users, total corrected "
+                 << corrected_.load();
+    }
+    return drifted > 0 ? static_cast<size_t>(drifted) : 0;
+}
+
+QuotaReservation::QuotaReservation(std::shared_ptr<QuotaManager::Reservations> reservations, int userId, uint64_t bytes)
+                : reservations_(std::move(reservations)),
+                  userId_(userId),
+                  bytes_(bytes)
+{}
+
+// 归还预留的空间
+QuotaReservation::~QuotaReservation()
+{
+    std::lock_guard<std::mutex> lock(reservations_->mutex);
+    auto it = reservations_->bytes.find(userId_);
+    if (it == reservations_->bytes.end()) return;
+    it->second = it->second > bytes_ ? it->second - bytes_ : 0;
+    if (it->second == 0) reservations_->bytes.erase(it);
+}
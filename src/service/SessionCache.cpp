@@ -0,0 +1,97 @@
+#include <functional>
+
+#include "SessionCache.h"
+
+SessionCache::SessionCache(int ttl, size_t maxEntriesPerShard)
+            : ttl_(ttl),
+              maxEntriesPerShard_(maxEntriesPerShard),
+              hits_(0),
+              misses_(0)
+{}
+
+SessionCache::~SessionCache() {}
+
+SessionCache::Shard& SessionCache::GetShard(const std::string& sessionId)
+{
+    return shards_[std::hash<std::string>()(sessionId) % kShardCount];
+}
+
+// 查询会话
+bool SessionCache::Get(const std::string& sessionId, int& userId, std::string& username, time_t* sessionExpire)
+{
+    Shard& shard = GetShard(sessionId);
+    time_t now = time(nullptr);
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.entries.find(sessionId);
+    if (it == shard.entries.end())
+    {
+        ++misses_;
+        return false;
+    }
+
+    // 会话已过期或缓存项已到期，删除后回源
+    if (it->second.sessionExpire <= now || it->second.cacheExpire <= now)
+    {
+        shard.entries.erase(it);
+        ++misses_;
+        return false;
+    }
+
+    userId = it->second.userId;
+    username = it->second.username;
+    if (sessionExpire) *sessionExpire = it->second.sessionExpire;
+    ++hits_;
+    return true;
+}
+
+// 写入或更新会话
+void SessionCache::Put(const std::string& sessionId, int userId, const std::string& username, time_t sessionExpire)
+{
+    Shard& shard = GetShard(sessionId);
+    time_t now = time(nullptr);
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (shard.entries.find(sessionId) == shard.entries.end()) EvictIfFull(shard, now);
+
+    Entry& entry = shard.entries[sessionId];
+    entry.userId = userId;
+    entry.username = username;
+    entry.sessionExpire = sessionExpire;
+    entry.cacheExpire = now + ttl_;
+}
+
+// 延长已缓存会话的过期时间
+void SessionCache::Touch(const std::string& sessionId, time_t sessionExpire)
+{
+    Shard& shard = GetShard(sessionId);
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.entries.find(sessionId);
+    if (it != shard.entries.end()) it->second.sessionExpire = sessionExpire;
+}
+
+// 删除会话
+void SessionCache::Invalidate(const std::string& sessionId)
+{
+    Shard& shard = GetShard(sessionId);
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.entries.erase(sessionId);
+}
+
+// 分片已满时清理过期项
+void SessionCache::EvictIfFull(Shard& shard, time_t now)
+{
+    if (shard.entries.size() < maxEntriesPerShard_) return;
+
+    for (auto it = shard.entries.begin(); it != shard.entries.end(); )
+    {
+        if (it->second.sessionExpire <= now || it->second.cacheExpire <= now)
+            it = shard.entries.erase(it);
+        else
+            ++it;
+    }
+
+    if (shard.entries.size() >= maxEntriesPerShard_) shard.entries.erase(shard.entries.begin());
+}
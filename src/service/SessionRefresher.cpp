@@ -0,0 +1,89 @@
+#include <vector>
+
+#include "SessionRefresher.h"
+#include "Public.h"
+#include "Log.h"
+
+SessionRefresher::SessionRefresher(int lifetime, size_t maxBatchSize)
+                : maxBatchSize_(maxBatchSize),
+                  lifetime_(lifetime),
+                  requested_(0),
+                  coalesced_(0),
+                  flushed_(0),
+                  batches_(0)
+{}
+
+SessionRefresher::~SessionRefresher() {}
+
+// 登记一次滑动过期刷新
+void SessionRefresher::MarkForRefresh(const std::string& sessionId)
+{
+    ++requested_;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!pending_.insert(sessionId).second) ++coalesced_;
+}
+
+// 取消待刷新记录
+void SessionRefresher::Cancel(const std::string& sessionId)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_.erase(sessionId);
+}
+
+// 将 ids[from, end) 放回待刷新集合（期间被取消的会话也会放回，刷新一个已删除的会话不影响结果）
+void SessionRefresher::Requeue(const std::vector<std::string>& ids, size_t from)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_.insert(ids.begin() + from, ids.end());
+}
+
+// 批量写入数据库
+void SessionRefresher::Flush(ConnectionPool* pool)
+{
+    // 1. 取出当前所有待刷新会话，之后的登记进入新的集合
+    std::unordered_set<std::string> sessions;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (pending_.empty()) return;
+        sessions.swap(pending_);
+    }
+
+    std::vector<std::string> ids(sessions.begin(), sessions.end());
+    std::shared_ptr<MySqlConnection> mysqlConn = pool->GetConnection();
+    if (!mysqlConn)
+    {
+        Requeue(ids, 0);
+        LOG_WARN << "SessionRefresher: no database connection, " << ids.size() << " sessions requeued";
+        return;
+    }
+    MYSQL* mysql = mysqlConn->GetRawConnection();
+
+    // 2. 按批次拼接 UPDATE ... WHERE session_id IN (...)
+    for (size_t begin = 0; begin < ids.size(); begin += maxBatchSize_)
+    {
+        size_t end = std::min(ids.size(), begin + maxBatchSize_);
+
+        std::string query = "UPDATE sessions SET expire_time = DATE_ADD(NOW(), INTERVAL " + std::to_string(lifetime_) +
+                            " SECOND) WHERE session_id IN (";
+        for (size_t i = begin; i < end; ++i)
+        {
+            if (i > begin) query += ", ";
+            query += "'" + EscapeString(ids[i], mysql) + "'";
+        }
+        query += ")";
+
+        // 写入失败（如锁等待超时）时本批及之后的会话放回待刷新集合
+        if (mysqlConn->Execute(query) < 0)
+        {
+            Requeue(ids, begin);
+            LOG_WARN << "SessionRefresher: flush failed, " << ids.size() - begin << " sessions requeued";
+            return;
+        }
+        flushed_ += end - begin;
+        ++batches_;
+    }
+
+    LOG_INFO << "SessionRefresher: flushed " << ids.size() << " sessions, total requested " << requested_.load()
+             << ", coalesced " << coalesced_.load() << ", flushed " << flushed_.load()
+             << ", batches " << batches_.load();
+}
@@ -0,0 +1,213 @@
+#include <functional>
+#include <algorithm>
+
+#include "ShareCodeFilter.h"
+#include "Log.h"
+
+static const size_t kBitsPerKey = 10;        // 每个分享码占用的位数，配合 7 个哈希函数误判率约 1%
+static const int kHashCount = 7;             // 哈希函数个数
+static const size_t kMinCapacity = 1024;     // 最小设计容量
+static const size_t kMinStaleForRebuild = 256; // 失效条目至少达到该数量才因失效触发重建
+
+// Bloom 过滤器：双重哈希 h1 + i * h2 模拟 k 个哈希函数，只在 mutex_ 保护下访问
+struct ShareCodeFilter::Bloom
+{
+    std::vector<uint64_t> words;
+    size_t bits;
+
+    explicit Bloom(size_t capacity)
+        : words((capacity * kBitsPerKey + 63) / 64, 0),
+          bits(words.size() * 64)
+    {}
+
+    static void Hash(const std::string& key, uint64_t* h1, uint64_t* h2)
+    {
+        uint64_t h = std::hash<std::string>()(key);
+        *h1 = h;
+        // splitmix64 混合出第二个哈希值，取奇数保证步长与位数互质的概率更高
+        h += 0x9e3779b97f4a7c15ULL;
+        h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+        *h2 = (h ^ (h >> 31)) | 1;
+    }
+
+    void Add(const std::string& key)
+    {
+        uint64_t h1, h2;
+        Hash(key, &h1, &h2);
+        for (int i = 0; i < kHashCount; ++i)
+        {
+            size_t bit = static_cast<size_t>((h1 + i * h2) % bits);
+            words[bit / 64] |= 1ULL << (bit % 64);
+        }
+    }
+
+    bool MayContain(const std::string& key) const
+    {
+        uint64_t h1, h2;
+        Hash(key, &h1, &h2);
+        for (int i = 0; i < kHashCount; ++i)
+        {
+            size_t bit = static_cast<size_t>((h1 + i * h2) % bits);
+            if (!(words[bit / 64] & (1ULL << (bit % 64)))) return false;
+        }
+        return true;
+    }
+};
+
+ShareCodeFilter::ShareCodeFilter(int negativeTtl, size_t negativeCapacity, int maxAge)
+               : capacity_(0),
+                 live_(0),
+                 stale_(0),
+                 builtAt_(0),
+                 maxAge_(maxAge),
+                 rebuilding_(false),
+                 negativeTtl_(negativeTtl),
+                 negativeCapacity_(negativeCapacity),
+                 filtered_(0),
+                 negativeHits_(0),
+                 misses_(0)
+{}
+
+ShareCodeFilter::~ShareCodeFilter() {}
+
+// 加入负缓存：满时先清理过期条目，仍然满（大量枚举）则整体清空，Bloom 过滤器仍会拦截绝大部分
+void ShareCodeFilter::AddNegativeLocked(const std::string& shareCode, time_t now)
+{
+    if (negative_.size() >= negativeCapacity_)
+    {
+        for (auto it = negative_.begin(); it != negative_.end();)
+        {
+            if (it->second <= now) it = negative_.erase(it);
+            else ++it;
+        }
+        if (negative_.size() >= negativeCapacity_) negative_.clear();
+    }
+    negative_[shareCode] = now + negativeTtl_;
+}
+
+// 分享码是否可能存在
+bool ShareCodeFilter::MayExist(const std::string& shareCode)
+{
+    time_t now = time(nullptr);
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = negative_.find(shareCode);
+    if (it != negative_.end())
+    {
+        if (it->second > now)
+        {
+            ++negativeHits_;
+            return false;
+        }
+        negative_.erase(it);
+    }
+
+    if (bloom_ && !bloom_->MayContain(shareCode))
+    {
+        ++filtered_;
+        return false;
+    }
+    return true;
+}
+
+// 数据库中查不到
+void ShareCodeFilter::RecordMiss(const std::string& shareCode)
+{
+    ++misses_;
+    std::lock_guard<std::mutex> lock(mutex_);
+    AddNegativeLocked(shareCode, time(nullptr));
+}
+
+// 创建分享
+void ShareCodeFilter::Add(const std::string& shareCode)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    negative_.erase(shareCode);
+    if (bloom_) bloom_->Add(shareCode);
+    ++live_;
+    if (rebuilding_) addedDuringRebuild_.push_back(shareCode);
+}
+
+// 删除分享
+void ShareCodeFilter::Remove(const std::string& shareCode)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    AddNegativeLocked(shareCode, time(nullptr));
+    ++stale_;
+}
+
+void ShareCodeFilter::NoteRemoved(size_t count)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    stale_ += count;
+}
+
+// 是否需要重建：尚未构建、超出设计容量、失效条目过多或使用时间过长
+bool ShareCodeFilter::NeedsRebuild()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (rebuilding_) return false;
+    if (!bloom_ || live_ > capacity_) return true;
+    if (stale_ >= kMinStaleForRebuild && stale_ > live_ / 4) return true;
+    return time(nullptr) - builtAt_ >= maxAge_;
+}
+
+// 从数据库重建
+size_t ShareCodeFilter::Rebuild(ConnectionPool* pool)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (rebuilding_) return 0;
+        rebuilding_ = true;
+        addedDuringRebuild_.clear();
+    }
+
+    // 1. 逐行读取全部未过期的分享码
+    std::vector<std::string> codes;
+    bool ok = false;
+    {
+        std::shared_ptr<MySqlConnection> mysqlConn = pool->GetConnection();
+        MYSQL_RES* result = mysqlConn ? mysqlConn->QueryUnbuffered(
+            "SELECT share_code FROM file_shares WHERE expire_time IS NULL OR expire_time > NOW()") : nullptr;
+        if (result)
+        {
+            MYSQL_ROW row;
+            while ((row = mysql_fetch_row(result)))
+            {
+                if (row[0]) codes.push_back(row[0]);
+            }
+            mysql_free_result(result);
+            ok = true;
+        }
+    }
+
+    if (!ok)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        rebuilding_ = false;
+        addedDuringRebuild_.clear();
+        LOG_ERROR << "ShareCodeFilter: rebuild failed, keeping the previous filter";
+        return 0;
+    }
+
+    // 2. 在锁外构建新过滤器，按当前数量的两倍设计容量，留出增长空间
+    size_t capacity = std::max(kMinCapacity, codes.size() * 2);
+    std::shared_ptr<Bloom> bloom = std::make_shared<Bloom>(capacity);
+    for (const std::string& code : codes) bloom->Add(code);
+
+    // 3. 补入重建期间创建的分享码后替换
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const std::string& code : addedDuringRebuild_) bloom->Add(code);
+    bloom_ = bloom;
+    capacity_ = capacity;
+    live_ = codes.size() + addedDuringRebuild_.size();
+    stale_ = 0;
+    builtAt_ = time(nullptr);
+    rebuilding_ = false;
+    addedDuringRebuild_.clear();
+
+    LOG_INFO << "ShareCodeFilter: rebuilt with " << live_ << " share codes, capacity " << capacity_
+             << ", " << bloom_->bits / 8 << " bytes";
+    return codes.size();
+}
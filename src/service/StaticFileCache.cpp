@@ -0,0 +1,128 @@
+#include <sys/stat.h>
+#include <fstream>
+#include <iterator>
+#include <cstdio>
+
+#include "StaticFileCache.h"
+#include "HttpValidator.h"
+#include "HttpCompressor.h"
+#include "Log.h"
+
+// FNV-1a 64 位哈希，用于生成基于内容的强 ETag
+static uint64_t HashContent(const std::string& data)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : data)
+    {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+StaticFileCache::StaticFileCache(const std::string& rootDir, int revalidateInterval)
+                : rootDir_(rootDir),
+                  revalidateInterval_(revalidateInterval)
+{}
+
+StaticFileCache::~StaticFileCache() {}
+
+// 注册并立即加载静态资源
+void StaticFileCache::Register(const std::string& name, const std::string& fileName, const std::string& contentType)
+{
+    std::unique_ptr<Entry> entry(new Entry);
+    entry->path = rootDir_ + "/" + fileName;
+    entry->contentType = contentType;
+    entry->current = LoadVersion(*entry);
+    entry->lastCheck = time(nullptr);
+
+    entries_[name] = std::move(entry);
+}
+
+// 获取资源，必要时按 mtime 重新校验
+std::shared_ptr<const StaticAsset> StaticFileCache::Get(const std::string& name)
+{
+    auto it = entries_.find(name);
+    if (it == entries_.end()) return nullptr;
+
+    Entry& entry = *it->second;
+    std::shared_ptr<const Version> current = std::atomic_load(&entry.current);
+
+    // 同一时间只有抢到本轮检查的线程执行 stat 和加载，其他线程继续使用当前版本
+    time_t now = time(nullptr);
+    time_t lastCheck = entry.lastCheck.load();
+    if (now - lastCheck < revalidateInterval_ || !entry.lastCheck.compare_exchange_strong(lastCheck, now))
+    {
+        return current->asset;
+    }
+
+    struct stat st;
+    if (stat(entry.path.c_str(), &st) != 0)
+    {
+        // 文件被删除，丢弃缓存
+        if (current->asset)
+        {
+            LOG_WARN << "Static file removed: " << entry.path;
+            std::shared_ptr<Version> removed = std::make_shared<Version>();
+            removed->mtime = 0;
+            removed->size = 0;
+            current = removed;
+            std::atomic_store(&entry.current, current);
+        }
+    }
+    else if (!current->asset || st.st_mtime != current->mtime || st.st_size != current->size)
+    {
+        current = LoadVersion(entry);
+        std::atomic_store(&entry.current, current);
+    }
+    return current->asset;
+}
+
+// 从磁盘加载资源内容并生成校验器
+std::shared_ptr<const StaticFileCache::Version> StaticFileCache::LoadVersion(const Entry& entry)
+{
+    std::shared_ptr<Version> version = std::make_shared<Version>();
+    version->mtime = 0;
+    version->size = 0;
+
+    struct stat st;
+    std::ifstream file(entry.path.c_str(), std::ios::binary);
+    if (!file.is_open() || stat(entry.path.c_str(), &st) != 0)
+    {
+        LOG_ERROR << "Failed to open static file " << entry.path;
+        return version;
+    }
+
+    std::shared_ptr<std::string> content = std::make_shared<std::string>(
+        (std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    char etag[64];
+    snprintf(etag, sizeof(etag), "\"%zx-%016llx\"", content->size(),
+             static_cast<unsigned long long>(HashContent(*content)));
+
+    std::shared_ptr<StaticAsset> asset = std::make_shared<StaticAsset>();
+    asset->content = content;
+    asset->contentType = entry.contentType;
+    asset->etag = etag;
+    asset->mtime = st.st_mtime;
+    asset->lastModified = HttpValidator::FormatHttpDate(st.st_mtime);
+
+    // 加载时以最高级别预压缩一次，请求时无需再消耗 CPU
+    std::string gzipped;
+    if (HttpCompressor::IsCompressibleType(entry.contentType) &&
+        content->size() >= HttpCompressor::GetOptions().minSize &&
+        HttpCompressor::Compress(content->data(), content->size(), ContentEncoding::kGzip, 9, &gzipped) &&
+        gzipped.size() < content->size())
+    {
+        asset->gzipContent = std::make_shared<const std::string>(std::move(gzipped));
+        asset->gzipEtag = asset->etag.substr(0, asset->etag.size() - 1) + "-gz\"";
+    }
+
+    version->mtime = st.st_mtime;
+    version->size = st.st_size;
+    version->asset = asset;
+
+    LOG_INFO << "Loaded static file " << entry.path << ", size: " << content->size() << ", etag: " << asset->etag
+             << ", gzip size: " << (asset->gzipContent ? asset->gzipContent->size() : 0);
+    return version;
+}
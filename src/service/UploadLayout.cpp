@@ -0,0 +1,139 @@
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <vector>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "UploadLayout.h"
+#include "Log.h"
+
+static const char kUploadPrefix[] = "upload_";  // 服务器生成的上传文件名前缀，迁移只处理此类文件
+
+UploadLayout::UploadLayout(const std::string& uploadDir)
+            : root_(uploadDir),
+              migrationDone_(false),
+              scanDone_(false),
+              migrated_(0)
+{}
+
+// 文件名对应的两级子目录：FNV-1a 哈希的前 4 个十六进制位，共 65536 个目录
+std::string UploadLayout::ShardOf(const std::string& fileName)
+{
+    uint32_t hash = 2166136261u;
+    for (unsigned char c : fileName)
+    {
+        hash ^= c;
+        hash *= 16777619u;
+    }
+    char shard[8];
+    snprintf(shard, sizeof(shard), "%02x/%02x", (hash >> 24) & 0xff, (hash >> 16) & 0xff);
+    return shard;
+}
+
+// 创建 path 的父目录
+bool UploadLayout::EnsureParentDir(const std::string& path)
+{
+    size_t last = path.find_last_of('/');
+    if (last == std::string::npos) return true;
+    size_t first = path.find_last_of('/', last - 1);
+    if (first == std::string::npos) return true;
+
+    // 两级子目录：先创建第一级，再创建第二级，已存在视为成功
+    std::string outer = path.substr(0, first);
+    std::string inner = path.substr(0, last);
+    if (mkdir(outer.c_str(), 0755) != 0 && errno != EEXIST) return false;
+    if (mkdir(inner.c_str(), 0755) != 0 && errno != EEXIST) return false;
+    return true;
+}
+
+std::string UploadLayout::PathFor(const std::string& fileName) const
+{
+    return root_ + "/" + ShardOf(fileName) + "/" + fileName;
+}
+
+std::string UploadLayout::LegacyPathFor(const std::string& fileName) const
+{
+    return root_ + "/" + fileName;
+}
+
+// 已有文件的实际路径
+std::string UploadLayout::Resolve(const std::string& fileName) const
+{
+    std::string path = PathFor(fileName);
+    if (migrationDone_) return path;
+
+    struct stat st;
+    if (stat(path.c_str(), &st) == 0) return path;
+    std::string legacy = LegacyPathFor(fileName);
+    if (stat(legacy.c_str(), &st) == 0) return legacy;
+    return path;
+}
+
+// 迁移一批平铺文件
+size_t UploadLayout::MigrateStep(size_t maxFiles)
+{
+    if (scanDone_) return 0;
+
+    DIR* dir = opendir(root_.c_str());
+    if (!dir)
+    {
+        LOG_ERROR << "UploadLayout: open " << root_ << " failed: " << strerror(errno);
+        return 0;
+    }
+
+    // 先收集一批文件名再迁移，迁移过程中不修改正在遍历的目录
+    std::vector<std::string> batch;
+    while (batch.size() < maxFiles)
+    {
+        struct dirent* entry = readdir(dir);
+        if (!entry) break;
+        if (strncmp(entry->d_name, kUploadPrefix, sizeof(kUploadPrefix) - 1) != 0) continue;
+        if (entry->d_type != DT_REG && entry->d_type != DT_UNKNOWN) continue;
+        // 迁移失败的文件留在原处，不跳过的话每批都会读到它们，迁移永远无法结束
+        if (skipped_.count(entry->d_name)) continue;
+        batch.push_back(entry->d_name);
+    }
+    closedir(dir);
+
+    size_t moved = 0;
+    for (const std::string& name : batch)
+    {
+        std::string from = LegacyPathFor(name);
+        struct stat st;
+        if (stat(from.c_str(), &st) != 0) continue;
+        if (!S_ISREG(st.st_mode))
+        {
+            skipped_.insert(name);
+            continue;
+        }
+
+        std::string to = PathFor(name);
+        if (!EnsureParentDir(to) || rename(from.c_str(), to.c_str()) != 0)
+        {
+            LOG_ERROR << "UploadLayout: move " << from << " -> " << to << " failed: " << strerror(errno);
+            skipped_.insert(name);
+            continue;
+        }
+        ++moved;
+    }
+
+    migrated_ += moved;
+    if (batch.empty())
+    {
+        // 仍有文件留在平铺路径时，Resolve 需要继续兼容旧路径
+        scanDone_ = true;
+        migrationDone_ = skipped_.empty();
+        LOG_INFO << "UploadLayout: flat files migrated, " << migrated_ << " files moved";
+        if (!skipped_.empty())
+        {
+            LOG_WARN << "UploadLayout: " << skipped_.size() << " flat files could not be moved and stay in " << root_;
+        }
+    }
+    else if (moved > 0)
+    {
+        LOG_INFO << "UploadLayout: migrated " << moved << " files, " << migrated_ << " in total";
+    }
+    return moved;
+}
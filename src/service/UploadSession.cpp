@@ -0,0 +1,225 @@
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <fstream>
+#include <algorithm>
+#include <iterator>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <nlohmann/json.hpp>
+
+#include "UploadSession.h"
+#include "QuotaManager.h"
+#include "Log.h"
+
+UploadSession::UploadSession(const std::string& id, int userId, const std::string& originalFileName, uint64_t size,
+                             const std::string& dataPath, const std::string& metaPath)
+             : id_(id),
+               userId_(userId),
+               originalFileName_(originalFileName),
+               size_(size),
+               dataPath_(dataPath),
+               metaPath_(metaPath),
+               fd_(-1),
+               device_(0),
+               receivedBytes_(0),
+               lastActive_(time(nullptr)),
+               committing_(false)
+{}
+
+UploadSession::~UploadSession()
+{
+    if (fd_ >= 0) close(fd_);
+}
+
+// 打开数据文件
+bool UploadSession::Open(bool create)
+{
+    int flags = O_RDWR | O_CLOEXEC | (create ? (O_CREAT | O_TRUNC) : 0);
+    fd_ = open(dataPath_.c_str(), flags, 0644);
+    if (fd_ < 0)
+    {
+        LOG_ERROR << "UploadSession: open " << dataPath_ << " failed: " << strerror(errno);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd_, &st) == 0) device_ = st.st_dev;
+
+    // 预分配空间：避免分片乱序写入产生空洞与碎片，磁盘空间不足时在创建会话时即失败
+    if (create && size_ > 0)
+    {
+        int ret = posix_fallocate(fd_, 0, static_cast<off_t>(size_));
+        if (ret == EOPNOTSUPP || ret == EINVAL) ret = ftruncate(fd_, static_cast<off_t>(size_)) == 0 ? 0 : errno;
+        if (ret != 0)
+        {
+            LOG_ERROR << "UploadSession: preallocate " << size_ << " bytes for " << dataPath_ << " failed: " << strerror(ret);
+            close(fd_);
+            fd_ = -1;
+            unlink(dataPath_.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+// 从会话信息文件恢复会话
+std::shared_ptr<UploadSession> UploadSession::Restore(const std::string& metaPath, const std::string& dataPath)
+{
+    try
+    {
+        std::ifstream file(metaPath);
+        nlohmann::json meta = nlohmann::json::parse(file);
+        std::shared_ptr<UploadSession> session = std::make_shared<UploadSession>(
+            meta["id"].get<std::string>(), meta["userId"].get<int>(), meta["fileName"].get<std::string>(),
+            meta["size"].get<uint64_t>(), dataPath, metaPath);
+        if (!session->Open(false)) return nullptr;
+
+        for (const auto& range : meta["received"])
+        {
+            session->MarkReceivedLocked(range[0].get<uint64_t>(), range[1].get<uint64_t>());
+        }
+        return session;
+    }
+    catch (const std::exception& e)
+    {
+        LOG_ERROR << "UploadSession: failed to restore " << metaPath << ": " << e.what();
+        return nullptr;
+    }
+}
+
+// 登记已写入的区间并合并
+void UploadSession::MarkReceivedLocked(uint64_t start, uint64_t end)
+{
+    if (start >= end) return;
+
+    // 与起点不大于 end 的前一个区间及之后所有相交或相邻的区间合并
+    auto it = received_.upper_bound(start);
+    if (it != received_.begin() && std::prev(it)->second >= start) --it;
+    while (it != received_.end() && it->first <= end)
+    {
+        start = std::min(start, it->first);
+        end = std::max(end, it->second);
+        receivedBytes_ -= it->second - it->first;
+        it = received_.erase(it);
+    }
+    received_[start] = end;
+    receivedBytes_ += end - start;
+}
+
+bool UploadSession::HasReservation()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return reservation_ != nullptr;
+}
+
+void UploadSession::SetReservation(std::shared_ptr<QuotaReservation> reservation)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    reservation_ = std::move(reservation);
+}
+
+// 在 offset 处写入一段数据
+bool UploadSession::Write(uint64_t offset, const char* data, size_t len)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (committing_ || fd_ < 0 || offset > size_ || len > size_ - offset) return false;
+    }
+
+    // pwrite 不改变文件偏移，多个连接可并发写入不同分片
+    size_t written = 0;
+    while (written < len)
+    {
+        ssize_t n = pwrite(fd_, data + written, len - written, static_cast<off_t>(offset + written));
+        if (n < 0)
+        {
+            if (errno == EINTR) continue;
+            LOG_ERROR << "UploadSession: pwrite " << dataPath_ << " failed: " << strerror(errno);
+            break;
+        }
+        written += static_cast<size_t>(n);
+    }
+
+    // 只登记实际写入的部分，断点续传时客户端据此补传
+    std::lock_guard<std::mutex> lock(mutex_);
+    MarkReceivedLocked(offset, offset + written);
+    lastActive_ = time(nullptr);
+    return written == len;
+}
+
+std::vector<std::pair<uint64_t, uint64_t>> UploadSession::GetReceivedRanges()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return std::vector<std::pair<uint64_t, uint64_t>>(received_.begin(), received_.end());
+}
+
+uint64_t UploadSession::GetReceivedBytes()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return receivedBytes_;
+}
+
+time_t UploadSession::GetLastActive()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lastActive_;
+}
+
+// 进入提交状态
+bool UploadSession::BeginCommit()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (committing_ || receivedBytes_ != size_) return false;
+    committing_ = true;
+
+    if (fd_ >= 0)
+    {
+        if (fsync(fd_) != 0) LOG_WARN << "UploadSession: fsync " << dataPath_ << " failed: " << strerror(errno);
+        close(fd_);
+        fd_ = -1;
+    }
+    return true;
+}
+
+// 持久化会话信息
+bool UploadSession::SaveMeta()
+{
+    {
+        // 已提交的会话不再写回，避免提交后重新生成会话信息文件
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (committing_) return true;
+
+        // 先把分片数据落盘再记录已接收区间，否则掉电后会话信息可能声明了并未落盘的数据，续传时被跳过
+        // 持锁同步，避免与 BeginCommit 关闭 fd_ 并发
+        if (fd_ >= 0 && fdatasync(fd_) != 0)
+        {
+            LOG_WARN << "UploadSession: fdatasync " << dataPath_ << " failed: " << strerror(errno);
+            return false;
+        }
+    }
+
+    nlohmann::json meta;
+    meta["id"] = id_;
+    meta["userId"] = userId_;
+    meta["fileName"] = originalFileName_;
+    meta["size"] = size_;
+    nlohmann::json ranges = nlohmann::json::array();
+    for (const auto& range : GetReceivedRanges()) ranges.push_back({range.first, range.second});
+    meta["received"] = ranges;
+
+    std::string tmpPath = metaPath_ + ".tmp";
+    {
+        std::ofstream file(tmpPath, std::ios::trunc);
+        file << meta.dump();
+        if (!file) return false;
+    }
+    return rename(tmpPath.c_str(), metaPath_.c_str()) == 0;
+}
+
+// 删除临时文件
+void UploadSession::RemoveFiles()
+{
+    unlink(dataPath_.c_str());
+    unlink(metaPath_.c_str());
+}
@@ -0,0 +1,146 @@
+#include <vector>
+#include <cstring>
+#include <cerrno>
+#include <ctime>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "UploadSessionManager.h"
+#include "Log.h"
+
+static const char kMetaSuffix[] = ".json";  // 会话信息文件后缀
+static const char kDataSuffix[] = ".part";  // 临时数据文件后缀
+
+UploadSessionManager::UploadSessionManager(const std::string& uploadDir, int idleTimeout)
+                    : dir_(uploadDir + "/.partial"),
+                      idleTimeout_(idleTimeout)
+{}
+
+// 恢复上次运行时未完成的会话
+size_t UploadSessionManager::Load()
+{
+    mkdir(dir_.c_str(), 0755);
+    DIR* dir = opendir(dir_.c_str());
+    if (!dir)
+    {
+        LOG_ERROR << "UploadSessionManager: open " << dir_ << " failed: " << strerror(errno);
+        return 0;
+    }
+
+    std::vector<std::string> ids;
+    while (struct dirent* entry = readdir(dir))
+    {
+        std::string name = entry->d_name;
+        size_t suffixLen = sizeof(kMetaSuffix) - 1;
+        if (name.size() > suffixLen && name.compare(name.size() - suffixLen, suffixLen, kMetaSuffix) == 0)
+        {
+            ids.push_back(name.substr(0, name.size() - suffixLen));
+        }
+    }
+    closedir(dir);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const std::string& id : ids)
+    {
+        std::shared_ptr<UploadSession> session = UploadSession::Restore(dir_ + "/" + id + kMetaSuffix,
+                                                                        dir_ + "/" + id + kDataSuffix);
+        if (session) 
+        {
+            sessions_[id] = session;
+        }
+        else
+        {
+            // 数据文件缺失或信息损坏的会话无法继续，清理残留文件
+            unlink((dir_ + "/" + id + kMetaSuffix).c_str());
+            unlink((dir_ + "/" + id + kDataSuffix).c_str());
+        }
+    }
+    return sessions_.size();
+}
+
+// 创建会话
+std::shared_ptr<UploadSession> UploadSessionManager::Create(const std::string& id, int userId,
+                                                            const std::string& originalFileName, uint64_t size)
+{
+    std::shared_ptr<UploadSession> session = std::make_shared<UploadSession>(
+        id, userId, originalFileName, size, dir_ + "/" + id + kDataSuffix, dir_ + "/" + id + kMetaSuffix);
+    if (!session->Open(true)) return nullptr;
+    if (!session->SaveMeta())
+    {
+        session->RemoveFiles();
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    sessions_[id] = session;
+    return session;
+}
+
+// 查找会话
+std::shared_ptr<UploadSession> UploadSessionManager::Get(const std::string& id)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = sessions_.find(id);
+    return it == sessions_.end() ? nullptr : it->second;
+}
+
+// 移除会话
+void UploadSessionManager::Remove(const std::string& id, bool removeFiles)
+{
+    std::shared_ptr<UploadSession> session;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = sessions_.find(id);
+        if (it == sessions_.end()) return;
+        session = it->second;
+        sessions_.erase(it);
+    }
+    if (removeFiles) session->RemoveFiles();
+}
+
+// 清理长时间无写入的会话
+size_t UploadSessionManager::ReapIdle()
+{
+    time_t now = time(nullptr);
+    std::vector<std::shared_ptr<UploadSession>> expired;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto it = sessions_.begin(); it != sessions_.end(); )
+        {
+            if (now - it->second->GetLastActive() > idleTimeout_)
+            {
+                expired.push_back(it->second);
+                it = sessions_.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    for (const auto& session : expired)
+    {
+        LOG_INFO << "UploadSessionManager: removing idle upload " << session->GetId();
+        session->RemoveFiles();
+    }
+    return expired.size();
+}
+
+// 持久化所有会话的已接收区间
+void UploadSessionManager::SaveAll()
+{
+    std::vector<std::shared_ptr<UploadSession>> sessions;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& item : sessions_) sessions.push_back(item.second);
+    }
+    for (const auto& session : sessions) session->SaveMeta();
+}
+
+size_t UploadSessionManager::Size()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return sessions_.size();
+}
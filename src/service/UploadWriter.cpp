@@ -0,0 +1,161 @@
+#include <cstdlib>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "UploadWriter.h"
+#include "Log.h"
+
+const size_t UploadWriter::kBlockSize;
+const size_t UploadWriter::kAlignment;
+
+UploadWriter::UploadWriter(const std::string& path)
+            : path_(path),
+              fd_(-1),
+              direct_(false),
+              buffer_(nullptr),
+              bufferLen_(0),
+              fileOffset_(0),
+              preallocated_(0),
+              flushes_(0)
+{}
+
+UploadWriter::~UploadWriter()
+{
+    if (fd_ >= 0) close(fd_);
+    free(buffer_);
+}
+
+// 创建文件并预分配空间
+bool UploadWriter::Open(uint64_t expectedSize, bool directIo)
+{
+    void* buffer = nullptr;
+    if (posix_memalign(&buffer, kAlignment, kBlockSize) != 0)
+    {
+        LOG_ERROR << "UploadWriter: allocate write buffer failed";
+        return false;
+    }
+    buffer_ = static_cast<char*>(buffer);
+
+    int flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+    if (directIo)
+    {
+        fd_ = open(path_.c_str(), flags | O_DIRECT, 0644);
+        direct_ = fd_ >= 0;
+        // tmpfs 等文件系统不支持 O_DIRECT，退回普通写入
+        if (fd_ < 0 && errno != EINVAL)
+        {
+            LOG_ERROR << "UploadWriter: open " << path_ << " failed: " << strerror(errno);
+            return false;
+        }
+    }
+    if (fd_ < 0) fd_ = open(path_.c_str(), flags, 0644);
+    if (fd_ < 0)
+    {
+        LOG_ERROR << "UploadWriter: open " << path_ << " failed: " << strerror(errno);
+        return false;
+    }
+
+    // 预分配连续空间减少碎片，磁盘空间不足时在写入数据前即失败
+    // expectedSize 来自 Content-Length，包含 multipart 边界等开销，关闭时截去多余部分
+    if (expectedSize > 0)
+    {
+        int ret = posix_fallocate(fd_, 0, static_cast<off_t>(expectedSize));
+        if (ret == 0)
+        {
+            preallocated_ = expectedSize;
+        }
+        else if (ret == ENOSPC)
+        {
+            LOG_ERROR << "UploadWriter: preallocate " << expectedSize << " bytes for " << path_ << " failed: no space";
+            return false;
+        }
+        else
+        {
+            LOG_WARN << "UploadWriter: preallocate for " << path_ << " not supported: " << strerror(ret);
+        }
+    }
+    return true;
+}
+
+// 追加数据：先填满缓冲区，满一块整块写入
+bool UploadWriter::Write(const char* data, size_t len)
+{
+    if (fd_ < 0) return false;
+
+    while (len > 0)
+    {
+        size_t n = std::min(len, kBlockSize - bufferLen_);
+        memcpy(buffer_ + bufferLen_, data, n);
+        bufferLen_ += n;
+        data += n;
+        len -= n;
+
+        if (bufferLen_ == kBlockSize)
+        {
+            if (!WriteBlock(buffer_, bufferLen_)) return false;
+            bufferLen_ = 0;
+        }
+    }
+    return true;
+}
+
+// 写出剩余数据并关闭文件
+bool UploadWriter::Close()
+{
+    if (fd_ < 0) return false;
+
+    bool ok = true;
+    if (bufferLen_ > 0)
+    {
+        // 尾部长度通常不对齐，O_DIRECT 无法写入
+        if (direct_) DisableDirect();
+        ok = WriteBlock(buffer_, bufferLen_);
+        bufferLen_ = 0;
+    }
+    // 截去按 Content-Length 多预分配的空间
+    if (ok && preallocated_ > fileOffset_ && ftruncate(fd_, static_cast<off_t>(fileOffset_)) != 0)
+    {
+        LOG_ERROR << "UploadWriter: truncate " << path_ << " failed: " << strerror(errno);
+        ok = false;
+    }
+    if (close(fd_) != 0) ok = false;
+    fd_ = -1;
+    return ok;
+}
+
+// 将数据整块写入当前偏移处
+bool UploadWriter::WriteBlock(const char* data, size_t len)
+{
+    size_t done = 0;
+    while (done < len)
+    {
+        ssize_t n = pwrite(fd_, data + done, len - done, static_cast<off_t>(fileOffset_ + done));
+        if (n < 0)
+        {
+            if (errno == EINTR) continue;
+            // 部分设备对 O_DIRECT 有更严格的对齐要求，退回普通写入重试
+            if (errno == EINVAL && direct_)
+            {
+                DisableDirect();
+                continue;
+            }
+            LOG_ERROR << "UploadWriter: write " << path_ << " failed: " << strerror(errno);
+            return false;
+        }
+        done += static_cast<size_t>(n);
+    }
+    fileOffset_ += len;
+    ++flushes_;
+    return true;
+}
+
+// 关闭 O_DIRECT
+void UploadWriter::DisableDirect()
+{
+    int flags = fcntl(fd_, F_GETFL);
+    if (flags >= 0) fcntl(fd_, F_SETFL, flags & ~O_DIRECT);
+    direct_ = false;
+}
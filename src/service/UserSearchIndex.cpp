@@ -0,0 +1,182 @@
+#include <algorithm>
+
+#include "UserSearchIndex.h"
+#include "Log.h"
+
+static const size_t kShortScanCandidates = 64;  // 不足 3 字节的关键词顺序扫描时最多收集的候选数
+
+// ASCII 字母转小写，其余字节（如 UTF-8 中文）不变
+static std::string Lower(const std::string& s)
+{
+    std::string out(s);
+    for (char& c : out)
+    {
+        if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+    }
+    return out;
+}
+
+// 三元组编码为整数键
+static uint32_t TrigramAt(const std::string& s, size_t i)
+{
+    return (static_cast<uint32_t>(static_cast<unsigned char>(s[i])) << 16) |
+           (static_cast<uint32_t>(static_cast<unsigned char>(s[i + 1])) << 8) |
+           static_cast<uint32_t>(static_cast<unsigned char>(s[i + 2]));
+}
+
+UserSearchIndex::UserSearchIndex() : searches_(0) {}
+
+UserSearchIndex::~UserSearchIndex() {}
+
+// 加入一个用户
+void UserSearchIndex::AddLocked(int id, const std::string& username, const std::string& email, bool keepSorted)
+{
+    uint32_t index = static_cast<uint32_t>(users_.size());
+    std::string lowered = Lower(username);
+    users_.push_back({id, username, email});
+    lowered_.push_back(lowered);
+
+    // 编号递增，追加到倒排表末尾即保持升序；同一用户名中重复的三元组只记录一次
+    for (size_t i = 0; i + 3 <= lowered.size(); ++i)
+    {
+        std::vector<uint32_t>& postings = trigrams_[TrigramAt(lowered, i)];
+        if (postings.empty() || postings.back() != index) postings.push_back(index);
+    }
+
+    std::pair<std::string, uint32_t> key(lowered, index);
+    if (keepSorted)
+    {
+        sorted_.insert(std::upper_bound(sorted_.begin(), sorted_.end(), key), key);
+    }
+    else
+    {
+        sorted_.push_back(key);
+    }
+}
+
+// 从数据库加载全部用户
+size_t UserSearchIndex::Load(ConnectionPool* pool)
+{
+    std::vector<User> users;
+    {
+        std::shared_ptr<MySqlConnection> mysqlConn = pool->GetConnection();
+        MYSQL_RES* result = mysqlConn ? mysqlConn->QueryUnbuffered("SELECT id, username, email FROM users") : nullptr;
+        if (!result)
+        {
+            LOG_ERROR << "UserSearchIndex: load users failed";
+            return 0;
+        }
+        MYSQL_ROW row;
+        while ((row = mysql_fetch_row(result)))
+        {
+            if (!row[0] || !row[1]) continue;
+            users.push_back({std::stoi(row[0]), row[1], row[2] ? row[2] : ""});
+        }
+        mysql_free_result(result);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    users_.clear();
+    lowered_.clear();
+    sorted_.clear();
+    trigrams_.clear();
+    users_.reserve(users.size());
+    lowered_.reserve(users.size());
+    sorted_.reserve(users.size());
+    for (const User& user : users) AddLocked(user.id, user.username, user.email, false);
+    std::sort(sorted_.begin(), sorted_.end());
+
+    LOG_INFO << "UserSearchIndex: loaded " << users_.size() << " users, " << trigrams_.size() << " trigrams";
+    return users_.size();
+}
+
+// 注册新用户
+void UserSearchIndex::Add(int id, const std::string& username, const std::string& email)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    AddLocked(id, username, email, true);
+}
+
+// 查找用户
+std::vector<UserSearchIndex::User> UserSearchIndex::Search(const std::string& keyword, int excludeId, size_t limit)
+{
+    ++searches_;
+    std::vector<User> out;
+    std::string term = Lower(keyword);
+    if (term.empty() || limit == 0) return out;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // 1. 前缀匹配：二分定位到第一个不小于 term 的用户名，向后直到不再以 term 开头
+    auto it = std::lower_bound(sorted_.begin(), sorted_.end(), std::make_pair(term, static_cast<uint32_t>(0)));
+    for (; it != sorted_.end() && out.size() < limit; ++it)
+    {
+        if (it->first.compare(0, term.size(), term) != 0) break;
+        const User& user = users_[it->second];
+        if (user.id != excludeId) out.push_back(user);
+    }
+    if (out.size() >= limit) return out;
+
+    // 2. 子串匹配（不以 term 开头的），按匹配位置、用户名长度排序
+    struct Candidate
+    {
+        size_t pos;
+        size_t len;
+        uint32_t index;
+    };
+    std::vector<Candidate> candidates;
+    auto consider = [&](uint32_t index) {
+        const std::string& lowered = lowered_[index];
+        if (users_[index].id == excludeId || lowered.compare(0, term.size(), term) == 0) return;
+        size_t pos = lowered.find(term, 1);
+        if (pos != std::string::npos) candidates.push_back({pos, lowered.size(), index});
+    };
+
+    if (term.size() >= 3)
+    {
+        // 取 term 的全部三元组倒排表，从最短的表出发，在其余表中二分确认，最后逐个确认连续出现
+        std::vector<const std::vector<uint32_t>*> lists;
+        for (size_t i = 0; i + 3 <= term.size(); ++i)
+        {
+            auto found = trigrams_.find(TrigramAt(term, i));
+            if (found == trigrams_.end()) return out;
+            lists.push_back(&found->second);
+        }
+        std::sort(lists.begin(), lists.end(), [](const std::vector<uint32_t>* a, const std::vector<uint32_t>* b) {
+            return a->size() < b->size();
+        });
+        for (uint32_t index : *lists[0])
+        {
+            bool all = true;
+            for (size_t i = 1; i < lists.size() && all; ++i)
+            {
+                all = std::binary_search(lists[i]->begin(), lists[i]->end(), index);
+            }
+            if (all) consider(index);
+        }
+    }
+    else
+    {
+        // 1~2 字节的关键词没有三元组：顺序扫描，收集到足够的候选即停止
+        for (uint32_t index = 0; index < users_.size() && candidates.size() < kShortScanCandidates; ++index)
+        {
+            consider(index);
+        }
+    }
+
+    size_t take = std::min(limit - out.size(), candidates.size());
+    std::partial_sort(candidates.begin(), candidates.begin() + take, candidates.end(),
+                      [this](const Candidate& a, const Candidate& b) {
+                          if (a.pos != b.pos) return a.pos < b.pos;
+                          if (a.len != b.len) return a.len < b.len;
+                          return lowered_[a.index] < lowered_[b.index];
+                      });
+    for (size_t i = 0; i < take; ++i) out.push_back(users_[candidates[i].index]);
+    return out;
+}
+
+size_t UserSearchIndex::Size()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return users_.size();
+}